@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string_view>
+
+#include <qc-image/bc.hpp>
+#include <qc-image/compare.hpp>
+#include <qc-image/image.hpp>
+#include <qc-image/png.hpp>
+#include <qc-image/sdf.hpp>
+#include <qc-image/tiled.hpp>
+
+//
+// Prints one JSON object per line for each benchmark, e.g.
+// {"name":"generate","params":"segments=64 curves=0.50 size=128 range=8","iterations":120,"seconds":0.000412,"minSeconds":0.000398,"pixelsPerSecond":3.9e7,"megabytesPerSecond":39.7}
+// Only benchmarks whose name contains the first argument are run, if given
+//
+
+using namespace qc;
+using namespace qci;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Each benchmark runs at least this many times, and at least until this much time has passed
+    constexpr u32 minIterationN{3u};
+    constexpr f64 minTotalSeconds{0.25};
+
+    std::string_view filter{};
+
+    bool isEnabled(const std::string_view name)
+    {
+        return name.find(filter) != std::string_view::npos;
+    }
+
+    // Times `func` and reports throughput for the given number of pixels and bytes processed per run
+    template <typename F>
+    void run(const char * const name, const char * const params, const u64 pixelN, const u64 byteN, F && func)
+    {
+        if (!isEnabled(name))
+        {
+            return;
+        }
+
+        u32 iterationN{0u};
+        f64 totalSeconds{0.0};
+        f64 minSeconds{number::inf<f64>};
+
+        while (iterationN < minIterationN || totalSeconds < minTotalSeconds)
+        {
+            const Clock::time_point start{Clock::now()};
+            func();
+            const f64 seconds{std::chrono::duration<f64>(Clock::now() - start).count()};
+
+            ++iterationN;
+            totalSeconds += seconds;
+            minSeconds = min(minSeconds, seconds);
+        }
+
+        const f64 meanSeconds{totalSeconds / f64(iterationN)};
+
+        std::printf(
+            R"({"name":"%s","params":"%s","iterations":%u,"seconds":%.9g,"minSeconds":%.9g,"pixelsPerSecond":%.6g,"megabytesPerSecond":%.6g})" "\n",
+            name,
+            params,
+            iterationN,
+            meanSeconds,
+            minSeconds,
+            f64(pixelN) / meanSeconds,
+            f64(byteN) / meanSeconds * 1.0e-6);
+        std::fflush(stdout);
+    }
+
+    // Star shaped contour of `segmentN` segments around `center`, with `curveRatio` of them quadratic curves
+    // Reversed contours wind the other way, to act as holes
+    sdf::Contour makeContour(std::mt19937 & random, const u32 segmentN, const f32 curveRatio, const fvec2 center, const f32 radius, const bool reversed)
+    {
+        std::uniform_real_distribution<f32> unit{0.0f, 1.0f};
+
+        List<fvec2> points{};
+        points.resize(segmentN);
+        for (u32 i{0u}; i < segmentN; ++i)
+        {
+            const f32 angle{(f32(i) + 0.25f * unit(random)) * 6.2831853f / f32(segmentN) * (reversed ? -1.0f : 1.0f)};
+            const f32 r{radius * (i % 2u ? 0.6f + 0.2f * unit(random) : 0.9f + 0.1f * unit(random))};
+            points[i] = center + fvec2{std::cos(angle), std::sin(angle)} * r;
+        }
+
+        sdf::Contour contour{};
+        for (u32 i{0u}; i < segmentN; ++i)
+        {
+            const fvec2 p1{points[i]};
+            const fvec2 p3{points[(i + 1u) % segmentN]};
+            if (unit(random) < curveRatio)
+            {
+                // Bulge the control point out from the chord
+                const fvec2 delta{p3 - p1};
+                const fvec2 p2{(p1 + p3) * 0.5f + fvec2{delta.y, -delta.x} * (0.25f * unit(random) - 0.125f) + delta * 0.01f};
+                contour.segments.push_back(sdf::Segment{p1, p2, p3});
+            }
+            else
+            {
+                contour.segments.push_back(sdf::Segment{p1, p3});
+            }
+        }
+
+        return contour;
+    }
+
+    sdf::Outline makeOutline(const u32 segmentN, const f32 curveRatio, const u32 size)
+    {
+        std::mt19937 random{segmentN * 1000u + u32(curveRatio * 100.0f)};
+
+        const f32 halfSize{f32(size) * 0.5f};
+
+        sdf::Outline outline{};
+        outline.contours.push_back(makeContour(random, segmentN - segmentN / 4u, curveRatio, fvec2{halfSize}, halfSize * 0.9f, false));
+        outline.contours.push_back(makeContour(random, max(segmentN / 4u, 3u), curveRatio, fvec2{halfSize}, halfSize * 0.3f, true));
+
+        return outline;
+    }
+
+    template <u32 n>
+    Image<u8, n> makeImage(const u32 size)
+    {
+        // Smooth gradient with some noise, so compression is neither trivial nor hopeless
+        std::mt19937 random{size * 10u + n};
+        std::uniform_int_distribution<u32> noise{0u, 15u};
+
+        Image<u8, n> image{size, size};
+        for (u32 y{0u}; y < size; ++y)
+        {
+            Pixel<u8, n> * const row{image.row(s32(y))};
+            for (u32 x{0u}; x < size; ++x)
+            {
+                u8 * const components{std::bit_cast<u8 *>(row + x)};
+                for (u32 c{0u}; c < n; ++c)
+                {
+                    components[c] = u8((x * (c + 1u) + y * (n - c) + noise(random)) & 0xFFu);
+                }
+            }
+        }
+
+        return image;
+    }
+
+    void benchGenerate()
+    {
+        for (const u32 segmentN : {8u, 64u, 512u})
+        {
+            for (const f32 curveRatio : {0.0f, 0.5f, 1.0f})
+            {
+                for (const u32 size : {32u, 128u, 512u})
+                {
+                    for (const f32 range : {2.0f, 8.0f, 32.0f})
+                    {
+                        const sdf::Outline outline{makeOutline(segmentN, curveRatio, size)};
+                        const sdf::PackedOutline packedOutline{outline};
+                        sdf::Outline simplifiedOutline{outline};
+                        simplifiedOutline.simplify(0.25f);
+
+                        char params[128];
+                        std::snprintf(params, sizeof(params), "segments=%u curves=%.2f size=%u range=%g", segmentN, curveRatio, size, range);
+
+                        const u64 pixelN{u64(size) * size};
+
+                        // Every way of generating must give the same field, so their timings compare the same work
+                        if (isEnabled("generate"))
+                        {
+                            const GrayImage image{sdf::generate(outline, size, range)};
+                            const GrayImage packedImage{sdf::generate(packedOutline, size, range)};
+                            const GrayImage sparseImage{sdf::generateSparse(packedOutline, size, range).toImage()};
+                            ABORT_IF(!std::equal(image.pixels(), image.pixels() + pixelN, packedImage.pixels()));
+                            ABORT_IF(!std::equal(image.pixels(), image.pixels() + pixelN, sparseImage.pixels()));
+                        }
+
+                        run("generate", params, pixelN, pixelN, [&]()
+                        {
+                            const GrayImage image{sdf::generate(outline, size, range)};
+                            ABORT_IF(image.width() != size);
+                        });
+
+                        run("generatePacked", params, pixelN, pixelN, [&]()
+                        {
+                            const GrayImage image{sdf::generate(packedOutline, size, range)};
+                            ABORT_IF(image.width() != size);
+                        });
+
+                        run("generateSparse", params, pixelN, pixelN, [&]()
+                        {
+                            const sdf::SparseSdf sparse{sdf::generateSparse(packedOutline, size, range)};
+                            ABORT_IF(sparse.size() != size);
+                        });
+
+                        run("generateSimplified", params, pixelN, pixelN, [&]()
+                        {
+                            const GrayImage image{sdf::generate(simplifiedOutline, size, range)};
+                            ABORT_IF(image.width() != size);
+                        });
+
+                        run("generateMsdf", params, pixelN, pixelN * 3u, [&]()
+                        {
+                            const RgbImage image{sdf::generateMsdf(outline, size, range)};
+                            ABORT_IF(image.width() != size);
+                        });
+
+                        // Full, half, and quarter size, so three levels' worth of pixels
+                        const u32 levelSizes[3]{size, size / 2u, size / 4u};
+                        const u64 levelPixelN{pixelN + pixelN / 4u + pixelN / 16u};
+                        run("generateLevels", params, levelPixelN, levelPixelN, [&]()
+                        {
+                            const List<GrayImage> levels{sdf::generateLevels<u8>(outline, f32(size), levelSizes, 3u, range)};
+                            ABORT_IF(levels.size() != 3u);
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    template <u32 n>
+    void benchImage(const std::filesystem::path & directory)
+    {
+        using Pixel = Pixel<u8, n>;
+
+        for (const u32 size : {256u, 1024u, 2048u})
+        {
+            char params[64];
+            std::snprintf(params, sizeof(params), "components=%u size=%u", n, size);
+
+            const u64 pixelN{u64(size) * size};
+            const u64 byteN{pixelN * sizeof(Pixel)};
+
+            Image<u8, n> image{makeImage<n>(size)};
+            Image<u8, n> other{size, size};
+
+            Pixel color{};
+            std::bit_cast<u8 *>(&color)[0] = 0x80u;
+
+            run("fill", params, pixelN, byteN, [&]() { image.view().fill(color); });
+
+            run("copy", params, pixelN, byteN, [&]() { other.view().copy(image); });
+
+            run("checkerboard", params, pixelN, byteN, [&]() { other.view().checkerboard(8u, Pixel{}, color); });
+
+            run("flipY", params, pixelN, byteN, [&]() { other.view().copyReoriented(image.view(), Orientation::flipY); });
+
+            run("transpose", params, pixelN, byteN, [&]() { other.view().copyReoriented(image.view(), Orientation::transpose); });
+
+            run("rotate90", params, pixelN, byteN, [&]() { other.view().copyReoriented(image.view(), Orientation::rotate90); });
+
+            run("rotate90InPlace", params, pixelN, byteN, [&]() { image.view().reorient(Orientation::rotate90); });
+
+            TiledImage<u8, n> tiled{image.size()};
+
+            run("toTiled", params, pixelN, byteN, [&]() { tiled.copy(image.view()); });
+
+            run("fromTiled", params, pixelN, byteN, [&]() { tiled.copyTo(other.view()); });
+
+            run("forEachRow", params, pixelN, byteN, [&]() { other.view().forEachRow([](const std::span<Pixel> row, s32) { std::ranges::reverse(row); }); });
+
+            run("parallelForRows", params, pixelN, byteN, [&]() { other.view().parallelForRows([](const std::span<Pixel> row, s32) { std::ranges::reverse(row); }); });
+
+            run("compare", params, pixelN, byteN * 2u, [&]() { ABORT_IF(!compare(image, other)); });
+
+            run("compareSsim", params, pixelN, byteN * 2u, [&]() { ABORT_IF(!compare(image, other, 0.0, true)); });
+
+            if constexpr (n == 1u)
+            {
+                run("encodeBc4", params, pixelN, byteN, [&]() { ABORT_IF(!bc::encodeBc4(image.view()).data); });
+            }
+            else if constexpr (n == 4u)
+            {
+                run("encodeBc1", params, pixelN, byteN, [&]() { ABORT_IF(!bc::encodeBc1(image.view()).data); });
+                run("encodeBc3", params, pixelN, byteN, [&]() { ABORT_IF(!bc::encodeBc3(image.view()).data); });
+            }
+
+            if (isEnabled("read") || isEnabled("write"))
+            {
+                image = makeImage<n>(size);
+                const std::filesystem::path file{directory / ("bench-" + std::to_string(n) + "-" + std::to_string(size) + ".png")};
+
+                // Always written at least once, for reading
+                ABORT_IF(!write(image, file));
+
+                run("write", params, pixelN, byteN, [&]() { ABORT_IF(!write(image, file)); });
+
+                run("read", params, pixelN, byteN, [&]() { ABORT_IF(!(read<u8, n>(file, false))); });
+
+                const Result<Image<u8, n>> readImage{read<u8, n>(file, false)};
+                ABORT_IF(!readImage || !std::equal(image.pixels(), image.pixels() + pixelN, readImage->pixels()));
+
+                std::filesystem::remove(file);
+            }
+
+            // `decode` uses the built-in decoder unless built without QCI_BUILTIN_PNG, in which case it is the stb_image baseline
+            if (isEnabled("decode"))
+            {
+                const Result<List<u8>> png{encode(image, ".png")};
+                ABORT_IF(!png);
+
+                run("decode", params, pixelN, byteN, [&]() { ABORT_IF(!(decode<u8, n>(png->data(), png->size(), false))); });
+
+                run("decodePng", params, pixelN, byteN, [&]() { ABORT_IF(!(decodePng<u8, n>(png->data(), png->size(), false))); });
+
+                const Result<Image<u8, n>> decoded{decodePng<u8, n>(png->data(), png->size(), false)};
+                ABORT_IF(!decoded || !std::equal(image.pixels(), image.pixels() + pixelN, decoded->pixels()));
+            }
+        }
+    }
+}
+
+int main(const int argc, const char * const * const argv)
+{
+    if (argc > 1)
+    {
+        filter = argv[1];
+    }
+
+    const std::filesystem::path directory{std::filesystem::temp_directory_path() / "qc-image-bench"};
+    std::filesystem::create_directories(directory);
+
+    benchGenerate();
+
+    benchImage<1u>(directory);
+    benchImage<2u>(directory);
+    benchImage<3u>(directory);
+    benchImage<4u>(directory);
+
+    std::filesystem::remove_all(directory);
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include <qc-image/image.hpp>
+
+///
+/// Asynchronous counterparts to `read` and `write`
+/// File IO is batched on a single IO thread through io_uring where available, and otherwise submitted to `defaultExecutor`
+/// Decoding and encoding are submitted to `defaultExecutor`, so they overlap with the IO of other files
+/// Any number of files may be in flight at once without a thread per file
+/// Callbacks are called on the IO thread or an executor thread, and should hand off any lengthy work
+///
+namespace qci
+{
+    template <Numeric T, u32 n> void readAsync(const std::filesystem::path & file, bool allowComponentPadding, std::function<void(Result<Image<T, n>>)> callback);
+    template <Numeric T, u32 n> nodisc std::future<Result<Image<T, n>>> readAsync(const std::filesystem::path & file, bool allowComponentPadding);
+
+    ///
+    /// Takes ownership of the image, which is released once written
+    ///
+    template <Numeric T, u32 n> void writeAsync(Image<T, n> && image, const std::filesystem::path & file, std::function<void(bool)> callback);
+    template <Numeric T, u32 n> nodisc std::future<bool> writeAsync(Image<T, n> && image, const std::filesystem::path & file);
+
+    ///
+    /// Whether file IO is going through io_uring, rather than the executor fallback
+    ///
+    nodisc bool isAsyncIoUringEnabled();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace qci
+{
+    template <Numeric T, u32 n>
+    inline std::future<Result<Image<T, n>>> readAsync(const std::filesystem::path & file, const bool allowComponentPadding)
+    {
+        const std::shared_ptr<std::promise<Result<Image<T, n>>>> promise{std::make_shared<std::promise<Result<Image<T, n>>>>()};
+        std::future<Result<Image<T, n>>> future{promise->get_future()};
+        readAsync<T, n>(file, allowComponentPadding, [promise](Result<Image<T, n>> image) { promise->set_value(std::move(image)); });
+        return future;
+    }
+
+    template <Numeric T, u32 n>
+    inline std::future<bool> writeAsync(Image<T, n> && image, const std::filesystem::path & file)
+    {
+        const std::shared_ptr<std::promise<bool>> promise{std::make_shared<std::promise<bool>>()};
+        std::future<bool> future{promise->get_future()};
+        writeAsync<T, n>(std::move(image), file, [promise](const bool success) { promise->set_value(success); });
+        return future;
+    }
+}
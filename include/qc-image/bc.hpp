@@ -0,0 +1,62 @@
+#pragma once
+
+#include <filesystem>
+
+#include <qc-core/list.hpp>
+
+#include <qc-image/image.hpp>
+
+///
+/// CPU encoders and reference decoders for GPU block compression formats
+/// Blocks are 4x4 texels and are stored top row first, left to right, as GPUs expect
+/// Images whose dimensions are not multiples of four are padded by repeating the edge texels
+///
+namespace qci::bc
+{
+    enum class Format : u8
+    {
+        bc1, // RGB, 8 bytes per block, also known as DXT1
+        bc3, // RGBA, 16 bytes per block, also known as DXT5
+        bc4  // Single channel, 8 bytes per block
+    };
+
+    struct CompressedImage
+    {
+        Format format{};
+        uivec2 size{};
+        List<u8> data{};
+
+        nodisc uivec2 blockCount() const { return (size + 3u) / 4u; }
+    };
+
+    nodisc constexpr u32 blockSize(const Format format) { return format == Format::bc3 ? 16u : 8u; }
+
+    ///
+    /// Encodes as BC4. Well suited to SDFs, as each block gets its own full eight step range
+    /// Rows of blocks are split across `executor`, as for the other encoders
+    ///
+    nodisc CompressedImage encodeBc4(const GrayImage::CView & image, Executor & executor = defaultExecutor());
+
+    ///
+    /// Encodes as BC1. Alpha is ignored and the result is opaque
+    ///
+    nodisc CompressedImage encodeBc1(const RgbaImage::CView & image, Executor & executor = defaultExecutor());
+
+    ///
+    /// Encodes as BC3, which is BC1 color plus BC4 alpha
+    ///
+    nodisc CompressedImage encodeBc3(const RgbaImage::CView & image, Executor & executor = defaultExecutor());
+
+    ///
+    /// Reference decoders
+    /// @return decoded image, or empty image if the compressed image has the wrong format or size
+    ///
+    nodisc GrayImage decodeBc4(const CompressedImage & image);
+    nodisc RgbaImage decodeBc1(const CompressedImage & image);
+    nodisc RgbaImage decodeBc3(const CompressedImage & image);
+
+    ///
+    /// Writes a DDS file with a single mip level
+    ///
+    nodisc bool writeDds(const CompressedImage & image, const std::filesystem::path & file);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <qc-image/image.hpp>
+
+namespace qci
+{
+    ///
+    /// Differences between two images of the same size, over all components
+    ///
+    struct ImageDiff
+    {
+        // Largest absolute difference of any component, in component units
+        f64 maxAbsDiff{};
+        // Pixels with any component differing by more than the tolerance
+        u64 mismatchN{};
+        // Mean squared component difference, in component units
+        f64 mse{};
+        // Peak signal-to-noise ratio in decibels, relative to the component type's max, or 1 for floating point. Infinite if identical
+        f64 psnr{};
+        // Mean structural similarity of 8x8 windows at a stride of 4, averaged across components. Only calculated if asked for, otherwise 1
+        f64 ssim{1.0};
+    };
+
+    ///
+    /// Compares two images component by component, such as to check generated output against a reference
+    /// Rows are split across `executor`, and `u8` components are compared sixteen at a time with SSE2 where available
+    /// Pixels are only checked individually against `tolerance` in rows whose max difference exceeds it
+    /// A NaN component differs from anything by infinity, so is always a mismatch, while equal infinities do not differ
+    /// @return the differences, or nothing if the sizes differ
+    ///
+    template <Numeric T, u32 n> nodisc Result<ImageDiff> compare(const ImageView<T, n, true> & a, const ImageView<T, n, true> & b, f64 tolerance = 0.0, bool calcSsim = false, Executor & executor = defaultExecutor());
+
+    ///
+    /// Same as above, but for whole images
+    ///
+    template <Numeric T, u32 n> nodisc Result<ImageDiff> compare(const Image<T, n> & a, const Image<T, n> & b, f64 tolerance = 0.0, bool calcSsim = false, Executor & executor = defaultExecutor());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace qci
+{
+    template <Numeric T, u32 n>
+    finline Result<ImageDiff> compare(const Image<T, n> & a, const Image<T, n> & b, const f64 tolerance, const bool calcSsim, Executor & executor)
+    {
+        return compare(a.view(), b.view(), tolerance, calcSsim, executor);
+    }
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include <qc-core/list.hpp>
+
+#include <qc-image/sdf.hpp>
+
+///
+/// Minimal TrueType reader that turns `glyf` glyphs into `sdf::Outline`s, and a cache of glyph SDFs generated on demand
+/// Only what outline generation needs is read: the character map, glyph outlines, and horizontal metrics
+/// Hinting instructions are ignored, and CFF based fonts are not supported
+///
+namespace qci::font
+{
+    struct GlyphMetrics
+    {
+        // In font units
+        u32 advance{};
+        s32 leftBearing{};
+    };
+
+    class Font
+    {
+      public:
+
+        Font() = default;
+
+        ///
+        /// Number of glyphs, any index below which is valid
+        ///
+        nodisc finline u32 glyphN() const { return _glyphN; }
+
+        nodisc finline u32 unitsPerEm() const { return _unitsPerEm; }
+
+        ///
+        /// Distance from the baseline to the top of the tallest glyphs, in font units
+        ///
+        nodisc finline s32 ascent() const { return _ascent; }
+
+        ///
+        /// Distance from the baseline to the bottom of the lowest glyphs, in font units, usually negative
+        ///
+        nodisc finline s32 descent() const { return _descent; }
+
+        nodisc finline s32 lineGap() const { return _lineGap; }
+
+        ///
+        /// @return index of the glyph for the unicode `codepoint`, or 0, the missing glyph, if there is none
+        ///
+        nodisc u32 glyphIndex(u32 codepoint) const;
+
+        nodisc GlyphMetrics metrics(u32 glyph) const;
+
+        ///
+        /// Reads the glyph's contours in font units, y up, with the origin on the baseline at the pen position
+        /// Lines and quadratic curves are produced as in the font, minus degenerate segments. Composite glyphs are flattened into one outline
+        /// Glyphs with nothing to draw, such as spaces, give an outline with no contours
+        /// Contours are filled by the nonzero rule, as TrueType specifies, so overlapping contours, common in composite and variable glyphs, stay filled
+        /// Overlaps are not removed though, so their edges within the glyph still count as edges for distance, and show as seams within half the range of them
+        /// @return the outline, or nothing if `glyph` is out of range or its data is malformed, including composites nesting too deep or reading too many glyphs and points in all
+        ///
+        nodisc Result<sdf::Outline> outline(u32 glyph) const;
+
+      private:
+
+        friend Result<Font> decode(List<u8> data, u32 fontIndex);
+
+        List<u8> _data{};
+        u32 _glyphN{};
+        u32 _unitsPerEm{};
+        s32 _ascent{};
+        s32 _descent{};
+        s32 _lineGap{};
+        bool _longLoca{};
+        u32 _hMetricN{};
+        u32 _glyfOffset{};
+        u32 _glyfSize{};
+        u32 _locaOffset{};
+        u32 _hmtxOffset{};
+        u32 _hmtxSize{};
+        // Chosen character map subtable, and the end of the `cmap` table as a bound on it
+        u32 _cmapOffset{};
+        u32 _cmapEnd{};
+        u32 _cmapFormat{};
+
+        nodisc bool _appendOutline(u32 glyph, u32 depth, u32 & budget, sdf::Outline & outline) const;
+    };
+
+    ///
+    /// Parses the font, taking ownership of the data
+    /// `fontIndex` selects the font within a TrueType collection, and must be 0 otherwise
+    /// @return the font, or nothing if the data is not a TrueType font with `glyf` outlines or is missing required tables
+    ///
+    nodisc Result<Font> decode(List<u8> data, u32 fontIndex = 0u);
+
+    ///
+    /// Reads and parses the font file, see `decode`
+    ///
+    nodisc Result<Font> read(const std::filesystem::path & file, u32 fontIndex = 0u);
+
+    ///
+    /// A glyph's SDF, sized to fit the glyph plus half the range on each side
+    ///
+    struct GlyphSdf
+    {
+        // Square, or empty if the glyph has nothing to draw
+        GrayImage image{};
+        // Position of the glyph's origin in image pixels, which may be outside the image
+        fvec2 origin{};
+        // Horizontal advance in pixels
+        f32 advance{};
+    };
+
+    ///
+    /// Generates glyph SDFs the first time they are asked for and keeps them until evicted, least recently used first, to stay within a byte budget
+    /// So only the glyphs actually used are ever generated, rather than a whole atlas up front
+    /// Safe to use from any number of threads. Different glyphs are generated concurrently, and a glyph already being generated is waited on rather than generated twice
+    ///
+    class GlyphCache
+    {
+      public:
+
+        ///
+        /// `font` must outlive the cache
+        /// Glyphs are generated at `emSize` pixels per em with the given SDF range, see `sdf::generate`
+        /// At least the most recent glyph is always kept, even if it alone is over `byteBudget`
+        ///
+        GlyphCache(const Font & font, f32 emSize, f32 range, u64 byteBudget);
+
+        GlyphCache(const GlyphCache &) = delete;
+        GlyphCache(GlyphCache && other);
+
+        GlyphCache & operator=(const GlyphCache &) = delete;
+        GlyphCache & operator=(GlyphCache && other);
+
+        ~GlyphCache();
+
+        ///
+        /// Gets the glyph's SDF, generating it if it is not cached
+        /// The result stays valid for as long as it is held, even once evicted
+        /// @return the SDF, or null if `glyph` is out of range or malformed
+        ///
+        nodisc std::shared_ptr<const GlyphSdf> get(u32 glyph);
+
+        ///
+        /// Same as above, but for the glyph mapped to the unicode `codepoint`
+        ///
+        nodisc std::shared_ptr<const GlyphSdf> getCodepoint(u32 codepoint);
+
+        ///
+        /// Total bytes of the glyphs currently cached
+        ///
+        nodisc u64 byteN() const;
+
+        ///
+        /// Number of glyphs currently cached, not counting any still being generated
+        ///
+        nodisc u32 glyphN() const;
+
+        ///
+        /// Evicts every glyph that is not still being generated
+        ///
+        void clear();
+
+      private:
+
+        struct _State;
+
+        std::unique_ptr<_State> _state;
+    };
+}
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <filesystem>
+#include <span>
 
 #include <qc-core/core.hpp>
+#include <qc-core/list.hpp>
 #include <qc-core/span.hpp>
 #include <qc-core/vector.hpp>
 
+#include <qc-image/parallel.hpp>
+
 namespace qci
 {
     using namespace qc;
@@ -14,6 +18,28 @@ namespace qci
 
     template <Numeric T, u32 n, bool constant> class ImageView;
 
+    ///
+    /// Ways an image can be rotated or mirrored. Rotations are counterclockwise, with y up
+    ///
+    enum class Orientation : u8
+    {
+        flipX,      // Mirrored left to right
+        flipY,      // Mirrored top to bottom, such as between bottom-up and top-down row order
+        rotate90,
+        rotate180,
+        rotate270,
+        transpose,  // Mirrored across the diagonal through the bottom left corner, swapping x and y
+        transverse  // Mirrored across the diagonal through the top left corner
+    };
+
+    ///
+    /// Whether the orientation swaps width and height
+    ///
+    nodisc constexpr bool swapsAxes(const Orientation orientation)
+    {
+        return orientation == Orientation::rotate90 || orientation == Orientation::rotate270 || orientation == Orientation::transpose || orientation == Orientation::transverse;
+    }
+
     template <Numeric T, u32 n>
     class Image
     {
@@ -47,6 +73,17 @@ namespace qci
 
         void fill(const Pixel & color);
 
+        ///
+        /// Rotates or mirrors the image, reallocating only if the orientation swaps the axes of a non-square image
+        /// If `parallel`, the work is split across `executor`
+        ///
+        void reorient(Orientation orientation, bool parallel = false, Executor & executor = defaultExecutor());
+
+        ///
+        /// A rotated or mirrored copy of the image
+        ///
+        nodisc Image reoriented(Orientation orientation, bool parallel = false, Executor & executor = defaultExecutor()) const;
+
         nodisc finline View view() { return View{*this, ivec2{}, _size}; }
         nodisc finline CView view() const { return CView{*this, ivec2{}, _size}; }
         nodisc finline View view(const ivec2 pos, const uivec2 size) { return View{*this, pos, size}; }
@@ -121,6 +158,18 @@ namespace qci
         nodisc Pixel & at(ivec2 p) const;
         nodisc Pixel & at(s32 x, s32 y) const;
 
+        ///
+        /// Calls `func(std::span<Pixel> row, s32 y)` for each row, bottom first
+        /// The view is checked once up front, then rows are reached by stepping a pointer, with no per row bounds checks
+        ///
+        template <typename F> void forEachRow(F && func) const;
+
+        ///
+        /// Same as `forEachRow`, but with the rows split into blocks of `grain` and spread across `executor`'s threads by `parallelFor`
+        /// Rows may be visited in any order, and `func` must be safe to call concurrently
+        ///
+        template <typename F> void parallelForRows(F && func, u32 grain = 16u, Executor & executor = defaultExecutor()) const;
+
         void fill(const Pixel & color) const requires (!constant);
 
         void outline(u32 thickness, const Pixel & color) const requires (!constant);
@@ -134,6 +183,29 @@ namespace qci
         void copy(const ImageView<T, n, true> & src) const requires (!constant);
         void copy(const Image & src) const requires (!constant);
 
+        ///
+        /// Copies `src` rotated or mirrored into this view, which must be the size of the result and must not overlap `src`
+        /// Orientations that swap axes are done in cache sized blocks, with SSE2 transposes for one and four byte pixels
+        /// If `parallel`, the work is split across `executor`
+        ///
+        void copyReoriented(const ImageView<T, n, true> & src, Orientation orientation, bool parallel = false, Executor & executor = defaultExecutor()) const requires (!constant);
+
+        ///
+        /// Rotates or mirrors the view's pixels in place. Orientations that swap axes require a square view
+        ///
+        void reorient(Orientation orientation, bool parallel = false, Executor & executor = defaultExecutor()) const requires (!constant);
+
+        ///
+        /// Blurs in place with a box filter `2 * radius + 1` pixels wide, clamping at the edges
+        /// Uses running sums, so cost does not depend on the radius. Rows, then strips of columns, are split across `executor`
+        ///
+        void boxBlur(u32 radius, Executor & executor = defaultExecutor()) const requires (!constant);
+
+        ///
+        /// Blurs in place with an approximate gaussian of standard deviation `sigma`, done as three box blur passes
+        ///
+        void gaussianBlur(f32 sigma, Executor & executor = defaultExecutor()) const requires (!constant);
+
       private:
 
         Image * _image{};
@@ -143,14 +215,36 @@ namespace qci
 
     ///
     /// ...
+    /// Component type may be `u8`, `u16`, or `f32`. 8-bit files are widened to 16 bits, and LDR files are loaded as float with gamma removed
+    /// Raw `.qci` files are also accepted, and are copied rather than mapped
     ///
     template <Numeric T, u32 n> nodisc Result<Image<T, n>> read(const std::filesystem::path & file, bool allowComponentPadding);
+
+    ///
+    /// Same as `read`, but from a file already in memory
+    ///
+    template <Numeric T, u32 n> nodisc Result<Image<T, n>> decode(const u8 * fileData, u64 fileSize, bool allowComponentPadding);
+
     nodisc Result<GrayImage> readGray(const std::filesystem::path & file);
     nodisc Result<GrayAlphaImage> readGrayAlpha(const std::filesystem::path & file, bool allowComponentPadding);
     nodisc Result<RgbImage> readRgb(const std::filesystem::path & file, bool allowComponentPadding);
     nodisc Result<RgbaImage> readRgba(const std::filesystem::path & file, bool allowComponentPadding);
 
+    ///
+    /// Writes `u8` and `u16` images as PNG, and `f32` images as Radiance HDR
+    /// Any image can also be written as a raw `.qci` file, which can then be memory mapped with `map`
+    /// Raw files are written straight from the pixels, without an encoded copy in memory
+    /// HDR files are always RGB and cannot hold negative values, so gray images are read back with three components
+    /// @return false if the file extension does not match a supported format for the component type, or writing fails
+    ///
     template <Numeric T, u32 n> nodisc bool write(const Image<T, n> & image, const std::filesystem::path & file);
+
+    ///
+    /// Same as `write`, but to memory, with the format chosen by `extension` in the same way
+    /// Raw `.qci` contents are limited to 4 GB, the most a list holds
+    /// @return file contents, or nothing if the format is unsupported or encoding fails
+    ///
+    template <Numeric T, u32 n> nodisc Result<List<u8>> encode(const Image<T, n> & image, const std::filesystem::path & extension);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -170,7 +264,7 @@ namespace qci
 
     template <Numeric T, u32 n>
     finline Image<T, n>::Image(const u32 width, const u32 height) :
-        Image{width, height, static_cast<Pixel *>(::operator new(width * height * sizeof(Pixel)))}
+        Image{width, height, static_cast<Pixel *>(::operator new(u64(width) * height * sizeof(Pixel)))}
     {}
 
     template <Numeric T, u32 n>
@@ -278,6 +372,49 @@ namespace qci
         return _image->row(_pos.y + y) + _pos.x;
     }
 
+    template <Numeric T, u32 n, bool constant>
+    template <typename F>
+    finline void ImageView<T, n, constant>::forEachRow(F && func) const
+    {
+        if (!_size.x || !_size.y)
+        {
+            return;
+        }
+
+        // Rows are stored bottom-up, so each row up is one image width back
+        const s64 pitch{s64(_image->width())};
+        Pixel * rowPixels{row(0)};
+        ASSERT(row(s32(_size.y) - 1) == rowPixels - (_size.y - 1u) * pitch);
+
+        for (u32 y{0u}; y < _size.y; ++y, rowPixels -= pitch)
+        {
+            func(std::span<Pixel>{rowPixels, _size.x}, s32(y));
+        }
+    }
+
+    template <Numeric T, u32 n, bool constant>
+    template <typename F>
+    finline void ImageView<T, n, constant>::parallelForRows(F && func, const u32 grain, Executor & executor) const
+    {
+        if (!_size.x || !_size.y)
+        {
+            return;
+        }
+
+        const s64 pitch{s64(_image->width())};
+        Pixel * const firstRow{row(0)};
+        ASSERT(row(s32(_size.y) - 1) == firstRow - (_size.y - 1u) * pitch);
+
+        executor.parallelFor(_size.y, grain, [&](const u32 beginY, const u32 endY)
+        {
+            Pixel * rowPixels{firstRow - beginY * pitch};
+            for (u32 y{beginY}; y < endY; ++y, rowPixels -= pitch)
+            {
+                func(std::span<Pixel>{rowPixels, _size.x}, s32(y));
+            }
+        });
+    }
+
     template <Numeric T, u32 n, bool constant>
     finline auto ImageView<T, n, constant>::at(const ivec2 p) const -> Pixel &
     {
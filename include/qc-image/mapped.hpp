@@ -0,0 +1,131 @@
+#pragma once
+
+#include <filesystem>
+
+#include <qc-image/image.hpp>
+
+///
+/// Raw `.qci` image container, which can be memory mapped and used in place with no decoding or copying
+/// The file is a `RawHeader` followed by the pixel rows at `dataOffset`, top row first, exactly as they are laid out in an `Image`
+/// Components are stored in native byte order, so files are only portable between machines of the same endianness
+/// Written by `write` when the file extension is `.qci`
+///
+namespace qci
+{
+    enum class RawComponentType : u32
+    {
+        uint8 = 1u,
+        uint16 = 2u,
+        float32 = 3u
+    };
+
+    template <Numeric T> inline constexpr RawComponentType rawComponentType{
+        std::is_same_v<T, u8> ? RawComponentType::uint8 :
+        std::is_same_v<T, u16> ? RawComponentType::uint16 :
+        std::is_same_v<T, f32> ? RawComponentType::float32 :
+        RawComponentType{}};
+
+    struct RawHeader
+    {
+        inline static constexpr char magic[4]{'Q', 'C', 'I', '\0'};
+        inline static constexpr u32 currentVersion{1u};
+        // Keeps the pixel data aligned for any component type and for SIMD loads
+        inline static constexpr u32 size{64u};
+
+        char fileMagic[4]{magic[0], magic[1], magic[2], magic[3]};
+        u32 version{currentVersion};
+        u32 width{};
+        u32 height{};
+        u32 componentN{};
+        RawComponentType componentType{};
+        // Bytes from the start of one row to the next
+        u32 pitch{};
+        u32 dataOffset{size};
+        u8 reserved[size - 32u]{};
+    };
+
+    static_assert(sizeof(RawHeader) == RawHeader::size);
+
+    ///
+    /// An image backed directly by a read only memory mapping of a `.qci` file
+    /// The mapping is shared, so any number of processes mapping the same file share the same physical pages
+    ///
+    template <Numeric T, u32 n>
+    class MappedImage
+    {
+      public:
+
+        MappedImage() = default;
+
+        MappedImage(const MappedImage &) = delete;
+        MappedImage(MappedImage && other);
+
+        MappedImage & operator=(const MappedImage &) = delete;
+        MappedImage & operator=(MappedImage && other);
+
+        ~MappedImage();
+
+        ///
+        /// The image's pixels point into the mapping and must not be modified or released
+        ///
+        nodisc finline const Image<T, n> & image() const { return _image; }
+
+        nodisc finline typename Image<T, n>::CView view() const { return _image.view(); }
+
+        nodisc finline uivec2 size() const { return _image.size(); }
+
+      private:
+
+        template <Numeric T_, u32 n_> friend Result<MappedImage<T_, n_>> map(const std::filesystem::path & file);
+
+        Image<T, n> _image{};
+        void * _mapping{};
+        u64 _mappingSize{};
+        void * _mappingHandle{};
+
+        void _unmap();
+    };
+
+    ///
+    /// Maps a `.qci` file written by `write`. Loading is constant time, pixels are paged in on first access
+    /// @return mapped image, or nothing if the file cannot be mapped or its header does not match `T` and `n`
+    ///
+    template <Numeric T, u32 n> nodisc Result<MappedImage<T, n>> map(const std::filesystem::path & file);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace qci
+{
+    template <Numeric T, u32 n>
+    finline MappedImage<T, n>::MappedImage(MappedImage && other) :
+        _image{std::move(other._image)},
+        _mapping{other._mapping},
+        _mappingSize{other._mappingSize},
+        _mappingHandle{other._mappingHandle}
+    {
+        other._mapping = nullptr;
+        other._mappingSize = 0u;
+        other._mappingHandle = nullptr;
+    }
+
+    template <Numeric T, u32 n>
+    finline MappedImage<T, n> & MappedImage<T, n>::operator=(MappedImage && other)
+    {
+        _unmap();
+        _image = std::move(other._image);
+        _mapping = other._mapping;
+        _mappingSize = other._mappingSize;
+        _mappingHandle = other._mappingHandle;
+        other._mapping = nullptr;
+        other._mappingSize = 0u;
+        other._mappingHandle = nullptr;
+        return *this;
+    }
+
+    template <Numeric T, u32 n>
+    finline MappedImage<T, n>::~MappedImage()
+    {
+        _unmap();
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <qc-core/core.hpp>
+
+namespace qci
+{
+    using namespace qc;
+
+    ///
+    /// Where the library runs its parallel work, so it can share threads with an application's own job system rather than compete with it
+    /// Implementing `submit` and `concurrency` is enough. `parallelFor` may also be overridden to hand ranges to the scheduler directly
+    ///
+    class Executor
+    {
+      public:
+
+        virtual ~Executor() = default;
+
+        ///
+        /// Runs `task` at some later point on any thread
+        /// Must not run it inline nor wait for it, and tasks must all eventually run, even if submitted from within another task
+        ///
+        virtual void submit(std::function<void()> task) = 0;
+
+        ///
+        /// Number of threads that can usefully work at once, counting the one calling `parallelFor`
+        ///
+        nodisc virtual u32 concurrency() const = 0;
+
+        ///
+        /// Splits `[0, count)` into blocks of `grain` elements, the last possibly smaller, and calls `func(begin, end)` for each
+        /// Each of up to `concurrency` workers starts with an even share of the blocks and takes them in order, then steals half of the largest remainder from other workers once its own run out
+        /// So uneven work, such as rows that cross more of an outline, still keeps every thread busy
+        /// The calling thread is one of the workers and blocks until all are done. It never waits on a worker that has yet to start, but takes its blocks instead
+        /// So calls may be nested within tasks, even when every thread is busy. Runs entirely on the calling thread if there is only one block
+        ///
+        virtual void parallelFor(u32 count, u32 grain, const std::function<void(u32, u32)> & func);
+    };
+
+    ///
+    /// Default executor, a fixed set of threads that each keep their own queue of tasks
+    /// Tasks submitted from a pool thread go to that thread's queue and are run newest first, and idle threads steal the oldest tasks of others
+    ///
+    class ThreadPool final : public Executor
+    {
+      public:
+
+        ///
+        /// Starts `threadN` threads, or one fewer than the hardware has if 0, as the thread calling `parallelFor` makes up the difference
+        /// At least one thread is always started so submitted tasks make progress
+        ///
+        explicit ThreadPool(u32 threadN = 0u);
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool(ThreadPool &&) = delete;
+
+        ThreadPool & operator=(const ThreadPool &) = delete;
+        ThreadPool & operator=(ThreadPool &&) = delete;
+
+        ///
+        /// Runs all remaining tasks, including any they submit, then joins the threads
+        ///
+        ~ThreadPool() override;
+
+        void submit(std::function<void()> task) override;
+
+        nodisc u32 concurrency() const override;
+
+        nodisc u32 threadN() const;
+
+      private:
+
+        struct _State;
+
+        std::unique_ptr<_State> _state;
+    };
+
+    ///
+    /// @return the executor set by `setDefaultExecutor`, or else a `ThreadPool` shared by the whole library, started on first use
+    ///
+    nodisc Executor & defaultExecutor();
+
+    ///
+    /// Sets the executor all library functions use by default, such as an adapter onto an engine's scheduler
+    /// `executor` must outlive any work given to it, and null restores the built in pool
+    /// Only affects calls that start afterwards
+    ///
+    void setDefaultExecutor(Executor * executor);
+
+    ///
+    /// Same as `Executor::parallelFor`, on `executor`
+    ///
+    void parallelFor(u32 count, u32 grain, const std::function<void(u32, u32)> & func, Executor & executor = defaultExecutor());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace qci
+{
+    finline void parallelFor(const u32 count, const u32 grain, const std::function<void(u32, u32)> & func, Executor & executor)
+    {
+        executor.parallelFor(count, grain, func);
+    }
+}
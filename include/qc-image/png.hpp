@@ -0,0 +1,95 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include <qc-core/span.hpp>
+
+#include <qc-image/image.hpp>
+
+namespace qci
+{
+    ///
+    /// Decodes a PNG file incrementally, one row at a time from the top, so memory use is bounded by a few rows regardless of image size
+    /// Only the file contents needed for the rows read so far are read from disk
+    /// Interlaced files cannot be decoded by row and are rejected by `open`
+    ///
+    class PngReader
+    {
+      public:
+
+        PngReader();
+
+        PngReader(const PngReader &) = delete;
+        PngReader(PngReader && other);
+
+        PngReader & operator=(const PngReader &) = delete;
+        PngReader & operator=(PngReader && other);
+
+        ~PngReader();
+
+        ///
+        /// Opens the file and reads everything up to the start of the pixel data
+        /// @return false if the file cannot be read, is not a PNG, or is interlaced
+        ///
+        nodisc bool open(const std::filesystem::path & file);
+
+        ///
+        /// Same as above, but decodes a file already in memory, which must outlive the reader
+        ///
+        nodisc bool open(const u8 * data, u64 size);
+
+        nodisc uivec2 size() const;
+
+        ///
+        /// Bits per sample in the file, or per palette index
+        ///
+        nodisc u32 bitDepth() const;
+
+        ///
+        /// Number of components after palette and transparency expansion, as `read` would report
+        ///
+        nodisc u32 componentN() const;
+
+        ///
+        /// Number of rows decoded so far, which is also the index from the top of the next row
+        ///
+        nodisc u32 rowsRead() const;
+
+        ///
+        /// Decodes the next row and converts the pixels in `[beginX, endX)` into `dst`
+        /// Components are expanded to `n` as by `read`, and the file must not have more than `n` components
+        /// @return false if there are no more rows or the data is corrupt
+        ///
+        template <Numeric T, u32 n> nodisc bool readRow(Pixel<T, n> * dst, u32 beginX, u32 endX);
+
+        ///
+        /// Decodes the next row without converting it
+        /// @return false if there are no more rows or the data is corrupt
+        ///
+        nodisc bool skipRow();
+
+      private:
+
+        struct _State;
+
+        std::unique_ptr<_State> _state;
+    };
+
+    ///
+    /// Reads only the given region of a PNG file, in the same coordinates as `Image::view`
+    /// Decoding stops after the last row of the region, and only the region's pixels are kept, so peak memory is the result plus a few rows
+    /// The region is clipped to the image. Interlaced files are supported, but are fully decoded first
+    /// Component type may be `u8` or `u16`
+    /// @return the region, or nothing if the file cannot be read or the clipped region is empty
+    ///
+    template <Numeric T, u32 n> nodisc Result<Image<T, n>> readRegion(const std::filesystem::path & file, const ispan2 & region, bool allowComponentPadding);
+
+    ///
+    /// Decodes a whole 8 bit, non-interlaced PNG in memory with the built-in decoder, which is faster than stb_image
+    /// Inflate uses multi-symbol table lookups, and unfiltering of three and four byte pixels uses SSE2 where available
+    /// Component type must be `u8`. `decode` only tries it first when built with `QCI_BUILTIN_PNG`, which is off by default
+    /// @return the image, or nothing if the data is not such a PNG, in which case `decode` should be used instead
+    ///
+    template <Numeric T, u32 n> nodisc Result<Image<T, n>> decodePng(const u8 * data, u64 size, bool allowComponentPadding);
+}
@@ -7,6 +7,12 @@
 
 namespace qci::sdf
 {
+  #ifdef QCI_SDF_STATS
+    inline constexpr bool statsEnabled{true};
+  #else
+    inline constexpr bool statsEnabled{false};
+  #endif
+
     struct Line
     {
         fvec2 p1, p2;
@@ -21,18 +27,44 @@ namespace qci::sdf
         nodisc bool isValid() const;
     };
 
+    struct Cubic
+    {
+        fvec2 p1, p2, p3, p4;
+
+        nodisc bool isValid() const;
+    };
+
+    enum class SegmentType : u8
+    {
+        line,
+        curve,
+        cubic
+    };
+
     struct Segment
     {
-        bool isCurve;
+        SegmentType type;
         union
         {
             Line line;
             Curve curve;
+            Cubic cubic;
         };
 
         Segment() = default;
         Segment(fvec2 p1, fvec2 p2);
         Segment(fvec2 p1, fvec2 p2, fvec2 p3);
+        Segment(fvec2 p1, fvec2 p2, fvec2 p3, fvec2 p4);
+
+        nodisc fvec2 start() const;
+
+        nodisc fvec2 end() const;
+
+        ///
+        /// Whether this is a quadratic curve, in place of the `isCurve` flag segments had before cubics
+        /// Cubics are neither lines nor curves, so code that handles every segment should switch on `type` instead
+        ///
+        nodisc bool isCurve() const;
 
         nodisc bool isValid() const;
     };
@@ -43,31 +75,399 @@ namespace qci::sdf
 
         void normalize();
 
+        ///
+        /// Reduces the number of segments, keeping every point within `tolerance` of the original contour and vice versa
+        /// Near-flat curves are demoted to lines, runs of nearly collinear lines are merged, and tiny lines between curves are dropped
+        /// Normalizes first. May leave fewer than two segments if the whole contour is within `tolerance` of a line
+        ///
+        void simplify(f32 tolerance);
+
         void transform(fvec2 scale, fvec2 translate);
 
         nodisc bool isValid() const;
     };
 
+    ///
+    /// How the contours decide which areas are inside
+    ///
+    enum class FillRule : u8
+    {
+        // Inside if a ray from the point crosses an odd number of edges, so overlapping areas are holes
+        evenOdd,
+        // Inside if the contours wind around the point a nonzero number of times, as TrueType glyphs are filled, so overlapping areas of the same direction stay inside
+        nonZero
+    };
+
     struct Outline
     {
         List<Contour> contours{};
+        FillRule fillRule{FillRule::evenOdd};
 
         void normalize();
 
+        ///
+        /// Simplifies each contour, see `Contour::simplify`, and removes those left with fewer than two segments
+        /// Worthwhile before generating from dense outlines, such as flattened or traced shapes, as generation cost scales with segment count
+        ///
+        void simplify(f32 tolerance);
+
         void transform(fvec2 scale, fvec2 translate);
 
         nodisc bool isValid() const;
 
     };
 
+    ///
+    /// Affine transform from outline coordinates to pixels, mapping `p` to `xAxis * p.x + yAxis * p.y + translate`
+    /// Lets a shared outline be generated at any size or placement without copying it
+    ///
+    struct Transform
+    {
+        fvec2 xAxis{1.0f, 0.0f};
+        fvec2 yAxis{0.0f, 1.0f};
+        fvec2 translate{};
+
+        ///
+        /// Same mapping as `Outline::transform`
+        ///
+        nodisc static Transform scaleTranslate(fvec2 scale, fvec2 translate);
+
+        nodisc fvec2 apply(fvec2 p) const;
+
+        nodisc bool isIdentity() const;
+
+        ///
+        /// Must be finite and invertible
+        ///
+        nodisc bool isValid() const;
+    };
+
     struct OutlineInvalidError {};
 
+    ///
+    /// Precomputed per-segment values used by generation, not meant for direct use. Only here so `PackedOutline` can hold them
+    ///
+    namespace detail
+    {
+        struct LineExt
+        {
+            fvec2 a;
+            f32 invLength2;
+        };
+
+        struct CurveExt
+        {
+            fvec2 a;
+            fvec2 b;
+            fvec2 c;
+            f32 maxHalfSubLineLength;
+        };
+
+        struct CubicExt
+        {
+            fvec2 a;
+            fvec2 b;
+            fvec2 c;
+            fvec2 d;
+            f32 maxHalfSubLineLength;
+            // Bounds of the pieces between extrema and inflection points, starting at 0 and ending at 1
+            u32 pieceN;
+            f32 pieceTs[8];
+        };
+    }
+
+    ///
+    /// Outline flattened into contiguous per-type segment arrays along with their precomputed extras and bounds
+    /// Cheap to build from an `Outline` and can be reused across any number of `generate` calls
+    /// Segment order within contours is not kept, only what generation needs
+    ///
+    struct PackedOutline
+    {
+        struct LineEntry
+        {
+            Line line;
+            detail::LineExt ext;
+            fspan2 bounds;
+        };
+
+        struct CurveEntry
+        {
+            Curve curve;
+            detail::CurveExt ext;
+            fspan2 bounds;
+        };
+
+        struct CubicEntry
+        {
+            Cubic cubic;
+            detail::CubicExt ext;
+            fspan2 bounds;
+        };
+
+        // A segment endpoint the contour passes through vertically, which may be a scanline intercept
+        struct VertexEntry
+        {
+            fvec2 p;
+            // 1 if the contour is heading up through it, otherwise -1
+            s32 winding;
+        };
+
+        // One past the last element of each array belonging to the contour
+        struct ContourEnd
+        {
+            u32 lineEnd;
+            u32 curveEnd;
+            u32 cubicEnd;
+            u32 vertexEnd;
+        };
+
+        List<LineEntry> lines{};
+        List<CurveEntry> curves{};
+        List<CubicEntry> cubics{};
+        List<VertexEntry> vertices{};
+        List<ContourEnd> contours{};
+        // Upper bound on scanline intercepts in any one row
+        u32 maxRowInterceptN{};
+        FillRule fillRule{FillRule::evenOdd};
+
+        PackedOutline() = default;
+        explicit PackedOutline(const Outline & outline, const Transform & transform = {});
+
+        ///
+        /// Repacks from `outline`, reusing existing storage
+        /// Points are transformed as they are packed, so the extras and bounds are in transformed space
+        /// Left empty if `outline.isValid()` or `transform.isValid()` is false, or if the transform collapses any segment
+        ///
+        void pack(const Outline & outline, const Transform & transform = {});
+
+        ///
+        /// Scales everything about the origin by `factor`, which must be positive
+        /// Much cheaper than repacking, as cubic piece bounds do not change, and exact for powers of two
+        ///
+        void scale(f32 factor);
+
+        nodisc bool isValid() const;
+    };
+
+    ///
+    /// Per-phase timings and counts from one `generate` call
+    /// Only collected when built with `QCI_SDF_STATS` defined, otherwise always zero
+    ///
+    struct GenerateStats
+    {
+        // Time spent calculating segment distances
+        f64 distanceSeconds{};
+        // Time spent collecting scanline intercepts
+        f64 interceptSeconds{};
+        // Time spent sorting row intercepts and inverting internal distances
+        f64 sortSeconds{};
+        // Time spent taking the square root of distances
+        f64 sqrtSeconds{};
+        // Time spent converting to the output image
+        f64 quantizeSeconds{};
+
+        // Pixels whose distance was evaluated for each segment type
+        u64 linePixelN{};
+        u64 curvePixelN{};
+        u64 cubicPixelN{};
+
+        // Closest point searches on curves and cubics, and the total bisection iterations they took
+        u64 closestPointSearchN{};
+        u64 closestPointIterationN{};
+
+        u32 rowN{};
+        u64 interceptN{};
+        // Rows whose intercepts did not pair up, an odd number of them or a nonzero winding past the last, which left the rest of the row outside
+        u32 oddInterceptRowN{};
+
+        nodisc f64 totalSeconds() const { return distanceSeconds + interceptSeconds + sortSeconds + sqrtSeconds + quantizeSeconds; }
+
+        nodisc f64 averageClosestPointIterations() const { return closestPointSearchN ? f64(closestPointIterationN) / f64(closestPointSearchN) : 0.0; }
+
+        nodisc f64 averageRowIntercepts() const { return rowN ? f64(interceptN) / f64(rowN) : 0.0; }
+    };
+
+    ///
+    /// SDF stored as square tiles, where only the tiles within half the range of the outline keep their pixels
+    /// Every other tile is entirely 0 or 255, so is stored as just a flag
+    /// For large fields that are mostly far from the outline, this is a small fraction of the size of a dense image
+    ///
+    class SparseSdf
+    {
+      public:
+
+        inline static constexpr u32 tileSize{32u};
+        inline static constexpr u32 tilePixelN{tileSize * tileSize};
+
+        enum class TileKind : u8
+        {
+            outside,    // Every pixel is 0
+            inside,     // Every pixel is 255
+            band        // Pixels are stored
+        };
+
+        SparseSdf() = default;
+
+        ///
+        /// Width and height in pixels
+        ///
+        nodisc finline u32 size() const { return _size; }
+
+        ///
+        /// Number of tiles across and up
+        ///
+        nodisc finline u32 tileCount() const { return _tileCount; }
+
+        nodisc TileKind tileKind(uivec2 tilePos) const;
+
+        ///
+        /// The `tilePixelN` pixels of the tile, bottom row first, or null if the tile is not `band`
+        /// Pixels of edge tiles past the edge of the field are padding
+        ///
+        nodisc const u8 * tilePixels(uivec2 tilePos) const;
+
+        ///
+        /// Number of tiles with stored pixels
+        ///
+        nodisc finline u32 bandTileN() const { return _pixels.size() / tilePixelN; }
+
+        ///
+        /// Bytes used by the tile table and stored pixels
+        ///
+        nodisc finline u64 byteN() const { return u64(_tiles.size()) * sizeof(u32) + _pixels.size(); }
+
+        nodisc u8 at(ivec2 p) const;
+        nodisc u8 at(s32 x, s32 y) const;
+
+        ///
+        /// Bilinearly interpolated value at `p`, in pixels with pixel centers at half coordinates, clamped at the edges
+        /// @return value from 0.0 to 1.0, the same scale as `generate`'s float output
+        ///
+        nodisc f32 sample(fvec2 p) const;
+
+        ///
+        /// Expands to the dense image `generate` would produce, a band of tiles at a time across `executor`
+        ///
+        nodisc GrayImage toImage(Executor & executor = defaultExecutor()) const;
+
+      private:
+
+        friend SparseSdf generateSparse(const PackedOutline & outline, u32 size, f32 range, Executor & executor);
+
+        // Tile table entries other than these are the index of the tile's pixels in units of `tilePixelN`
+        inline static constexpr u32 _outsideTile{~0u};
+        inline static constexpr u32 _insideTile{~0u - 1u};
+
+        u32 _size{};
+        u32 _tileCount{};
+        List<u32> _tiles{};
+        List<u8> _pixels{};
+    };
+
     ///
     /// ...
     /// Range is the total width of the distance gradient from 0.0 to 1.0
+    /// If `stats` is given, it is filled with timings and counts for this call
     /// @return generated image, or empty image if `outline.isValid()` is false
     ///
-    GrayImage generate(const Outline & outline, const u32 size, const f32 range);
+    GrayImage generate(const Outline & outline, const u32 size, const f32 range, GenerateStats * stats = nullptr);
+
+    ///
+    /// Same as above, but with the outline already packed
+    /// @return generated image, or empty image if `outline.isValid()` is false
+    ///
+    GrayImage generate(const PackedOutline & outline, u32 size, f32 range, GenerateStats * stats = nullptr);
+
+    ///
+    /// Same as above, but with `transform` applied to the outline on the fly, which is the same as generating from a transformed copy
+    /// @return generated image, or empty image if `outline.isValid()` or `transform.isValid()` is false
+    ///
+    GrayImage generate(const Outline & outline, const Transform & transform, u32 size, f32 range, GenerateStats * stats = nullptr);
+
+    ///
+    /// Same as above, but with `u8`, `u16`, or `f32` output
+    /// Integer outputs span 0.0 to 1.0 over the range as above, just with more precision for `u16`
+    /// Float output is the same mapping without quantization or clamping
+    /// Float pixels more than half the range from the outline are only known to be beyond the range, and may be infinite
+    ///
+    template <Numeric T> nodisc Image<T, 1u> generate(const Outline & outline, u32 size, f32 range, GenerateStats * stats = nullptr);
+    template <Numeric T> nodisc Image<T, 1u> generate(const PackedOutline & outline, u32 size, f32 range, GenerateStats * stats = nullptr);
+    template <Numeric T> nodisc Image<T, 1u> generate(const Outline & outline, const Transform & transform, u32 size, f32 range, GenerateStats * stats = nullptr);
+
+    ///
+    /// Same as above, but generates into `dst`, which must be square
+    /// @return false if `outline.isValid()` is false or `dst` is not square
+    ///
+    template <Numeric T> nodisc bool generate(const PackedOutline & outline, const ImageView<T, 1u, false> & dst, f32 range, GenerateStats * stats = nullptr);
+
+    ///
+    /// Generates the outline at several sizes, validating and packing it only once
+    /// Outline coordinates are in pixels of an image `outlineSize` across, and are scaled to each level's size
+    /// Each level is the same as `generate` with the outline scaled by `size / outlineSize`, up to rounding, and exactly for power of two ratios
+    /// Range is in pixels of each level
+    /// @return one image per size, or nothing if `outline.isValid()` is false, or `outlineSize` or any size is not positive
+    ///
+    template <Numeric T> nodisc List<Image<T, 1u>> generateLevels(const Outline & outline, f32 outlineSize, const u32 * sizes, u32 levelN, f32 range);
+
+    ///
+    /// Same as above, but generates into the given views, which must be square
+    /// @return false if `outline.isValid()` is false, `outlineSize` is not positive, or any view is empty or not square
+    ///
+    template <Numeric T> nodisc bool generateLevels(const Outline & outline, f32 outlineSize, const ImageView<T, 1u, false> * levels, u32 levelN, f32 range);
+
+    ///
+    /// Generates straight into sparse form, the same as `generate` followed by keeping only the tiles near the outline
+    /// Works a band of tiles at a time, and only calculates distances for tiles that segments are within half the range of
+    /// Neither the dense image nor a dense distance buffer is ever allocated, so very large fields are practical
+    /// Bands are split across `executor`
+    /// @return generated SDF, or empty SDF if `outline.isValid()` is false
+    ///
+    nodisc SparseSdf generateSparse(const Outline & outline, u32 size, f32 range, Executor & executor = defaultExecutor());
+
+    ///
+    /// Same as above, but with `transform` applied to the outline on the fly
+    /// @return generated SDF, or empty SDF if `outline.isValid()` or `transform.isValid()` is false
+    ///
+    nodisc SparseSdf generateSparse(const Outline & outline, const Transform & transform, u32 size, f32 range, Executor & executor = defaultExecutor());
+
+    ///
+    /// Same as above, but with the outline already packed
+    /// @return generated SDF, or empty SDF if `outline.isValid()` is false
+    ///
+    nodisc SparseSdf generateSparse(const PackedOutline & outline, u32 size, f32 range, Executor & executor = defaultExecutor());
+
+    ///
+    /// Generates a multi-channel SDF, where the median of the three channels is the distance, but with sharp corners kept sharp
+    /// Each contour's segments are colored so that the two edges at a corner share only one channel, and each channel holds the signed pseudo-distance to its closest edge
+    /// Inside and outside come from the same scanline pass as `generate`, and override the channels' sign where their median disagrees
+    /// Range is the total width of the distance gradient from 0.0 to 1.0, as for `generate`
+    /// @return generated image, or empty image if `outline.isValid()` is false
+    ///
+    RgbImage generateMsdf(const Outline & outline, u32 size, f32 range);
+
+    ///
+    /// Same as above, but with `transform` applied to the outline on the fly, which is the same as generating from a transformed copy
+    /// Corners are those of the transformed outline, as a transform that is not a similarity changes the angles between segments
+    /// @return generated image, or empty image if `outline.isValid()` or `transform.isValid()` is false
+    ///
+    RgbImage generateMsdf(const Outline & outline, const Transform & transform, u32 size, f32 range);
+
+    ///
+    /// Generates an SDF the same size as `mask` using an exact euclidean distance transform
+    /// Mask pixels with a value of at least 128 are inside, and the edge is taken to be halfway between pixel centers
+    /// Range is the total width of the distance gradient from 0.0 to 1.0, as for `generate`
+    /// Rows, then strips of columns, are split across `executor`
+    /// @return generated image, or empty image if `mask` is empty
+    ///
+    GrayImage generateFromMask(const GrayImage::CView & mask, f32 range, Executor & executor = defaultExecutor());
+
+    ///
+    /// Rasterizes the filled outline into `view` as anti-aliased coverage, with outline coordinates in pixels relative to the view
+    /// Line areas are accumulated exactly, and curves are first flattened to well within a pixel
+    /// Coverage is the absolute accumulated winding, clamped to 1, so overlapping contours of the same direction do not double up
+    /// @return false if `outline.isValid()` is false
+    ///
+    bool rasterize(const Outline & outline, const GrayImage::View & view);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -75,12 +475,99 @@ namespace qci::sdf
 namespace qci::sdf
 {
     finline Segment::Segment(const fvec2 p1, const fvec2 p2) :
-        isCurve{false},
+        type{SegmentType::line},
         line{p1, p2}
     {}
 
     finline Segment::Segment(const fvec2 p1, const fvec2 p2, const fvec2 p3) :
-        isCurve{true},
+        type{SegmentType::curve},
         curve{p1, p2, p3}
     {}
+
+    finline Segment::Segment(const fvec2 p1, const fvec2 p2, const fvec2 p3, const fvec2 p4) :
+        type{SegmentType::cubic},
+        cubic{p1, p2, p3, p4}
+    {}
+
+    finline Transform Transform::scaleTranslate(const fvec2 scale, const fvec2 translate)
+    {
+        return Transform{.xAxis = {scale.x, 0.0f}, .yAxis = {0.0f, scale.y}, .translate = translate};
+    }
+
+    finline fvec2 Transform::apply(const fvec2 p) const
+    {
+        return xAxis * p.x + yAxis * p.y + translate;
+    }
+
+    finline bool Transform::isIdentity() const
+    {
+        return xAxis == fvec2{1.0f, 0.0f} && yAxis == fvec2{0.0f, 1.0f} && translate == fvec2{};
+    }
+
+    inline PackedOutline::PackedOutline(const Outline & outline, const Transform & transform)
+    {
+        pack(outline, transform);
+    }
+
+    finline bool PackedOutline::isValid() const
+    {
+        return bool(contours);
+    }
+
+    finline auto SparseSdf::tileKind(const uivec2 tilePos) const -> TileKind
+    {
+        ASSERT(tilePos.x < _tileCount && tilePos.y < _tileCount);
+
+        const u32 tile{_tiles[tilePos.y * _tileCount + tilePos.x]};
+        return tile == _outsideTile ? TileKind::outside : tile == _insideTile ? TileKind::inside : TileKind::band;
+    }
+
+    finline const u8 * SparseSdf::tilePixels(const uivec2 tilePos) const
+    {
+        ASSERT(tilePos.x < _tileCount && tilePos.y < _tileCount);
+
+        const u32 tile{_tiles[tilePos.y * _tileCount + tilePos.x]};
+        return tile >= _insideTile ? nullptr : _pixels.data() + u64(tile) * tilePixelN;
+    }
+
+    finline u8 SparseSdf::at(const ivec2 p) const
+    {
+        return at(p.x, p.y);
+    }
+
+    finline u8 SparseSdf::at(const s32 x, const s32 y) const
+    {
+        ASSERT(x >= 0 && u32(x) < _size && y >= 0 && u32(y) < _size);
+
+        const u32 tile{_tiles[(u32(y) / tileSize) * _tileCount + u32(x) / tileSize]};
+        switch (tile)
+        {
+            case _outsideTile: return 0u;
+            case _insideTile: return 255u;
+            default: return _pixels[u64(tile) * tilePixelN + (u32(y) % tileSize) * tileSize + u32(x) % tileSize];
+        }
+    }
+
+    finline fvec2 Segment::start() const
+    {
+        // The first point is in the same place for every type
+        return line.p1;
+    }
+
+    finline fvec2 Segment::end() const
+    {
+        switch (type)
+        {
+            case SegmentType::line: return line.p2;
+            case SegmentType::curve: return curve.p3;
+            case SegmentType::cubic: return cubic.p4;
+        }
+
+        return {};
+    }
+
+    finline bool Segment::isCurve() const
+    {
+        return type == SegmentType::curve;
+    }
 }
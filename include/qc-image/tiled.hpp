@@ -0,0 +1,216 @@
+#pragma once
+
+#include <utility>
+
+#include <qc-image/image.hpp>
+
+namespace qci
+{
+    ///
+    /// An image stored as square tiles of `tileSize` pixels, rather than as whole rows
+    /// Each tile is contiguous, with its rows in the same bottom-up order as `Image`, and tiles are in row order too
+    /// Pixels that are near in 2D are near in memory, so column walks and neighborhood kernels touch a few cache lines instead of one per row
+    /// Storage is padded out to whole tiles. Padding pixels are never read by the conversions, and are only written by `fill`
+    ///
+    template <Numeric T, u32 n>
+    class TiledImage
+    {
+      public:
+
+        static_assert(n >= 1u && n <= 4u);
+
+        using ComponentT = T;
+        using Pixel = Pixel<T, n>;
+
+        inline static constexpr u32 componentN{n};
+        inline static constexpr u32 tileSize{8u};
+        inline static constexpr u32 tilePixelN{tileSize * tileSize};
+
+        TiledImage() = default;
+        explicit TiledImage(uivec2 size);
+        TiledImage(u32 width, u32 height);
+
+        ///
+        /// Converts from linear layout
+        ///
+        explicit TiledImage(const ImageView<T, n, true> & src);
+
+        TiledImage(const TiledImage &) = delete;
+        TiledImage(TiledImage && other);
+
+        TiledImage & operator=(const TiledImage &) = delete;
+        TiledImage & operator=(TiledImage && other);
+
+        ~TiledImage();
+
+        void fill(const Pixel & color);
+
+        ///
+        /// Copies `src` into the tiles, with its bottom left corner at `pos`, clipped to the image
+        /// Bands of tile rows are split across `executor`
+        ///
+        void copy(const ImageView<T, n, true> & src, ivec2 pos = {}, Executor & executor = defaultExecutor());
+
+        ///
+        /// Converts the part of the image under `dst`, with its bottom left corner at `pos`, to linear layout
+        /// Bands of tile rows are split across `executor`
+        ///
+        void copyTo(const ImageView<T, n, false> & dst, ivec2 pos = {}, Executor & executor = defaultExecutor()) const;
+
+        ///
+        /// Converts the whole image to linear layout
+        ///
+        nodisc Image<T, n> toImage(Executor & executor = defaultExecutor()) const;
+
+        nodisc finline uivec2 size() const { return _size; }
+
+        nodisc finline u32 width() const { return _size.x; };
+
+        nodisc finline u32 height() const { return _size.y; };
+
+        ///
+        /// Number of tiles across and up
+        ///
+        nodisc finline uivec2 tileCounts() const { return _tileCounts; }
+
+        nodisc finline Pixel * pixels() { return _pixels; };
+        nodisc finline const Pixel * pixels() const { return _pixels; };
+
+        ///
+        /// The `tilePixelN` pixels of the tile at `tilePos`, in tiles, bottom row first
+        ///
+        nodisc Pixel * tile(ivec2 tilePos);
+        nodisc const Pixel * tile(ivec2 tilePos) const;
+
+        ///
+        /// The `tileSize` pixels of row `y` within the tile at `tilePos`
+        ///
+        nodisc Pixel * tileRow(ivec2 tilePos, u32 y);
+        nodisc const Pixel * tileRow(ivec2 tilePos, u32 y) const;
+
+        nodisc Pixel & at(ivec2 p);
+        nodisc const Pixel & at(ivec2 p) const;
+        nodisc Pixel & at(s32 x, s32 y);
+        nodisc const Pixel & at(s32 x, s32 y) const;
+
+      private:
+
+        uivec2 _size{};
+        uivec2 _tileCounts{};
+        Pixel * _pixels{};
+
+        nodisc u64 _index(s32 x, s32 y) const;
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace qci
+{
+    template <Numeric T, u32 n>
+    finline TiledImage<T, n>::TiledImage(const uivec2 size) :
+        TiledImage{size.x, size.y}
+    {}
+
+    template <Numeric T, u32 n>
+    finline TiledImage<T, n>::TiledImage(const u32 width, const u32 height) :
+        _size{width, height},
+        _tileCounts{(width + tileSize - 1u) / tileSize, (height + tileSize - 1u) / tileSize},
+        _pixels{static_cast<Pixel *>(::operator new(u64(_tileCounts.x) * _tileCounts.y * tilePixelN * sizeof(Pixel)))}
+    {}
+
+    template <Numeric T, u32 n>
+    finline TiledImage<T, n>::TiledImage(const ImageView<T, n, true> & src) :
+        TiledImage{src.size()}
+    {
+        copy(src);
+    }
+
+    template <Numeric T, u32 n>
+    finline TiledImage<T, n>::TiledImage(TiledImage && other) :
+        _size{std::exchange(other._size, {})},
+        _tileCounts{std::exchange(other._tileCounts, {})},
+        _pixels{std::exchange(other._pixels, nullptr)}
+    {}
+
+    template <Numeric T, u32 n>
+    finline TiledImage<T, n> & TiledImage<T, n>::operator=(TiledImage && other)
+    {
+        ::operator delete(_pixels);
+        _size = std::exchange(other._size, {});
+        _tileCounts = std::exchange(other._tileCounts, {});
+        _pixels = std::exchange(other._pixels, nullptr);
+        return *this;
+    }
+
+    template <Numeric T, u32 n>
+    finline TiledImage<T, n>::~TiledImage()
+    {
+        ::operator delete(_pixels);
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::tile(const ivec2 tilePos) -> Pixel *
+    {
+        ASSERT(tilePos.x >= 0 && u32(tilePos.x) < _tileCounts.x && tilePos.y >= 0 && u32(tilePos.y) < _tileCounts.y);
+
+        return _pixels + (u64(tilePos.y) * _tileCounts.x + u32(tilePos.x)) * tilePixelN;
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::tile(const ivec2 tilePos) const -> const Pixel *
+    {
+        ASSERT(tilePos.x >= 0 && u32(tilePos.x) < _tileCounts.x && tilePos.y >= 0 && u32(tilePos.y) < _tileCounts.y);
+
+        return _pixels + (u64(tilePos.y) * _tileCounts.x + u32(tilePos.x)) * tilePixelN;
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::tileRow(const ivec2 tilePos, const u32 y) -> Pixel *
+    {
+        ASSERT(y < tileSize);
+
+        return tile(tilePos) + y * tileSize;
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::tileRow(const ivec2 tilePos, const u32 y) const -> const Pixel *
+    {
+        ASSERT(y < tileSize);
+
+        return tile(tilePos) + y * tileSize;
+    }
+
+    template <Numeric T, u32 n>
+    finline u64 TiledImage<T, n>::_index(const s32 x, const s32 y) const
+    {
+        ASSERT(x >= 0 && u32(x) < _size.x && y >= 0 && u32(y) < _size.y);
+
+        const u64 tileIndex{u64(u32(y) / tileSize) * _tileCounts.x + u32(x) / tileSize};
+        return tileIndex * tilePixelN + (u32(y) % tileSize) * tileSize + u32(x) % tileSize;
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::at(const ivec2 p) -> Pixel &
+    {
+        return at(p.x, p.y);
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::at(const ivec2 p) const -> const Pixel &
+    {
+        return at(p.x, p.y);
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::at(const s32 x, const s32 y) -> Pixel &
+    {
+        return _pixels[_index(x, y)];
+    }
+
+    template <Numeric T, u32 n>
+    finline auto TiledImage<T, n>::at(const s32 x, const s32 y) const -> const Pixel &
+    {
+        return _pixels[_index(x, y)];
+    }
+}
@@ -0,0 +1,683 @@
+#include <qc-image/async.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <qc-core/utils.hpp>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define QCI_HAS_IO_URING
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/eventfd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace qci
+{
+    namespace
+    {
+        // Max bytes per individual read or write, as the kernel caps them at a little under 2 GiB
+        constexpr u64 _maxIoChunkSize{u64(1u) << 30};
+
+        struct _IoRequest
+        {
+            bool isWrite{};
+            std::filesystem::path file{};
+            // Filled by reads, and the contents to write for writes
+            List<u8> data{};
+            std::function<void(bool success, List<u8> && data)> done{};
+
+            // IO thread state
+            u64 offset{};
+            int fd{-1};
+        };
+
+        // Does the request synchronously on the calling thread
+        void _doRequestSync(_IoRequest & request)
+        {
+            if (request.isWrite)
+            {
+                request.done(utils::writeFile(request.file, request.data.data(), request.data.size()), std::move(request.data));
+            }
+            else
+            {
+                Result<List<u8>> data{utils::readFile(request.file)};
+                if (data)
+                {
+                    request.done(true, std::move(*data));
+                }
+                else
+                {
+                    request.done(false, {});
+                }
+            }
+        }
+
+      #ifdef QCI_HAS_IO_URING
+
+        // Thin wrapper over the raw io_uring system calls, as liburing is not a dependency
+        class _Ring
+        {
+          public:
+
+            _Ring() = default;
+
+            _Ring(const _Ring &) = delete;
+
+            ~_Ring()
+            {
+                if (_sqes) ::munmap(_sqes, _sqesSize);
+                if (_cqRing && _cqRing != _sqRing) ::munmap(_cqRing, _cqRingSize);
+                if (_sqRing) ::munmap(_sqRing, _sqRingSize);
+                if (_fd >= 0) ::close(_fd);
+            }
+
+            nodisc bool init(const u32 entryN)
+            {
+                io_uring_params params{};
+                _fd = int(::syscall(__NR_io_uring_setup, entryN, &params));
+                FAIL_IF(_fd < 0);
+
+                _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+                _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool singleMap{bool(params.features & IORING_FEAT_SINGLE_MMAP)};
+                if (singleMap)
+                {
+                    _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+                }
+
+                _sqRing = _map(_sqRingSize, IORING_OFF_SQ_RING);
+                FAIL_IF(!_sqRing);
+                _cqRing = singleMap ? _sqRing : _map(_cqRingSize, IORING_OFF_CQ_RING);
+                FAIL_IF(!_cqRing);
+                _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                _sqes = static_cast<io_uring_sqe *>(_map(_sqesSize, IORING_OFF_SQES));
+                FAIL_IF(!_sqes);
+
+                u8 * const sq{static_cast<u8 *>(_sqRing)};
+                _sqHead = std::bit_cast<u32 *>(sq + params.sq_off.head);
+                _sqTail = std::bit_cast<u32 *>(sq + params.sq_off.tail);
+                _sqMask = *std::bit_cast<const u32 *>(sq + params.sq_off.ring_mask);
+                _sqArray = std::bit_cast<u32 *>(sq + params.sq_off.array);
+                _sqEntryN = params.sq_entries;
+                _sqLocalTail = *_sqTail;
+                _sqSubmittedTail = _sqLocalTail;
+
+                u8 * const cq{static_cast<u8 *>(_cqRing)};
+                _cqHead = std::bit_cast<u32 *>(cq + params.cq_off.head);
+                _cqTail = std::bit_cast<u32 *>(cq + params.cq_off.tail);
+                _cqMask = *std::bit_cast<const u32 *>(cq + params.cq_off.ring_mask);
+                _cqes = std::bit_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+                return true;
+            }
+
+            nodisc u32 entryN() const { return _sqEntryN; }
+
+            // Whether the kernel supports all of `opcodes`. Kernels too old to probe are too old for plain reads and writes too
+            nodisc bool supports(const std::initializer_list<u8> opcodes) const
+            {
+                alignas(io_uring_probe) u8 buffer[sizeof(io_uring_probe) + 256u * sizeof(io_uring_probe_op)]{};
+                io_uring_probe & probe{*std::bit_cast<io_uring_probe *>(&buffer[0])};
+                FAIL_IF(::syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, &probe, 256u) < 0);
+
+                for (const u8 opcode : opcodes)
+                {
+                    FAIL_IF(opcode > probe.last_op || opcode >= probe.ops_len);
+                    FAIL_IF(!(probe.ops[opcode].flags & IO_URING_OP_SUPPORTED));
+                }
+
+                return true;
+            }
+
+            // Returns a zeroed submission entry, or null if the queue is full
+            nodisc io_uring_sqe * nextSqe()
+            {
+                const u32 head{std::atomic_ref<u32>{*_sqHead}.load(std::memory_order::acquire)};
+                if (_sqLocalTail - head >= _sqEntryN)
+                {
+                    return nullptr;
+                }
+
+                const u32 index{_sqLocalTail & _sqMask};
+                _sqArray[index] = index;
+                io_uring_sqe * const sqe{_sqes + index};
+                std::memset(sqe, 0, sizeof(io_uring_sqe));
+                ++_sqLocalTail;
+                return sqe;
+            }
+
+            // Submits all new entries and waits for at least `waitN` completions
+            // Returns early, without error, if the kernel is short of resources or completion room, which reaping completions relieves
+            // @return false if the ring can no longer be entered, in which case entries it did not take are left for `dropUnsubmitted`
+            nodisc bool submitAndWait(const u32 waitN)
+            {
+                std::atomic_ref<u32>{*_sqTail}.store(_sqLocalTail, std::memory_order::release);
+
+                while (true)
+                {
+                    const u32 submitN{_sqLocalTail - _sqSubmittedTail};
+                    const long result{::syscall(__NR_io_uring_enter, _fd, submitN, waitN, waitN ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0)};
+                    if (result >= 0)
+                    {
+                        _sqSubmittedTail += u32(result);
+                        return true;
+                    }
+                    if (errno == EAGAIN || errno == EBUSY)
+                    {
+                        return true;
+                    }
+                    FAIL_IF(errno != EINTR);
+                }
+            }
+
+            // Takes back the entries the kernel has not consumed, calling `func` with the user data of each
+            template <typename F>
+            void dropUnsubmitted(F && func)
+            {
+                const u32 head{std::atomic_ref<u32>{*_sqHead}.load(std::memory_order::acquire)};
+                for (u32 tail{head}; tail != _sqLocalTail; ++tail)
+                {
+                    func(_sqes[_sqArray[tail & _sqMask]].user_data);
+                }
+
+                _sqLocalTail = head;
+                _sqSubmittedTail = head;
+                std::atomic_ref<u32>{*_sqTail}.store(_sqLocalTail, std::memory_order::release);
+            }
+
+            template <typename F>
+            void forEachCompletion(F && func)
+            {
+                u32 head{*_cqHead};
+                const u32 tail{std::atomic_ref<u32>{*_cqTail}.load(std::memory_order::acquire)};
+                for (; head != tail; ++head)
+                {
+                    const io_uring_cqe & cqe{_cqes[head & _cqMask]};
+                    func(cqe.user_data, cqe.res);
+                }
+                std::atomic_ref<u32>{*_cqHead}.store(head, std::memory_order::release);
+            }
+
+          private:
+
+            int _fd{-1};
+
+            void * _sqRing{};
+            size_t _sqRingSize{};
+            void * _cqRing{};
+            size_t _cqRingSize{};
+            io_uring_sqe * _sqes{};
+            size_t _sqesSize{};
+
+            u32 * _sqHead{};
+            u32 * _sqTail{};
+            u32 _sqMask{};
+            u32 * _sqArray{};
+            u32 _sqEntryN{};
+            u32 _sqLocalTail{};
+            u32 _sqSubmittedTail{};
+
+            u32 * _cqHead{};
+            u32 * _cqTail{};
+            u32 _cqMask{};
+            io_uring_cqe * _cqes{};
+
+            nodisc void * _map(const size_t size, const u64 offset) const
+            {
+                void * const ptr{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, off_t(offset))};
+                return ptr == MAP_FAILED ? nullptr : ptr;
+            }
+        };
+
+        // Owns the ring and the thread that feeds it
+        // Other threads queue requests and wake the IO thread through an eventfd whose read is always pending in the ring
+        class _UringService
+        {
+          public:
+
+            nodisc bool init()
+            {
+                FAIL_IF(!_ring.init(256u));
+                FAIL_IF(!_ring.supports({IORING_OP_READ, IORING_OP_WRITE}));
+
+                _eventFd = ::eventfd(0u, EFD_CLOEXEC);
+                FAIL_IF(_eventFd < 0);
+
+                _queueEventRead();
+                FAIL_IF(!_ring.submitAndWait(0u));
+
+                _thread = std::jthread{[this]() { _run(); }};
+
+                return true;
+            }
+
+            ~_UringService()
+            {
+                if (_thread.joinable())
+                {
+                    {
+                        const std::scoped_lock lock{_mutex};
+                        _stopping = true;
+                    }
+                    _wake();
+                    _thread.join();
+                }
+
+                if (_eventFd >= 0)
+                {
+                    ::close(_eventFd);
+                }
+            }
+
+            // Takes the request unless the IO thread can no longer be woken, in which case it is left for the caller to do
+            nodisc bool submit(std::unique_ptr<_IoRequest> & request)
+            {
+                {
+                    const std::scoped_lock lock{_mutex};
+                    if (_failed)
+                    {
+                        return false;
+                    }
+                    _queue.push_back(std::move(request));
+                }
+                _wake();
+                return true;
+            }
+
+          private:
+
+            // User data for the eventfd read, which no request can have
+            inline static constexpr u64 _eventUserData{0u};
+
+            _Ring _ring{};
+            int _eventFd{-1};
+            u64 _eventValue{};
+            std::jthread _thread{};
+
+            std::mutex _mutex{};
+            std::deque<std::unique_ptr<_IoRequest>> _queue{};
+            bool _stopping{};
+            // Set by the IO thread if the eventfd read or entering the ring fails, after which it finishes what it has and exits
+            bool _failed{};
+
+            void _wake()
+            {
+                const u64 one{1u};
+                [[maybe_unused]] const ssize_t result{::write(_eventFd, &one, sizeof(one))};
+            }
+
+            void _queueEventRead()
+            {
+                io_uring_sqe * const sqe{_ring.nextSqe()};
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = _eventFd;
+                sqe->addr = std::bit_cast<u64>(&_eventValue);
+                sqe->len = sizeof(_eventValue);
+                sqe->user_data = _eventUserData;
+            }
+
+            // Opens the file and, for reads, sizes the buffer. Cheap metadata calls are done directly
+            nodisc static bool _open(_IoRequest & request)
+            {
+                if (request.isWrite)
+                {
+                    request.fd = ::open(request.file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                    return request.fd >= 0;
+                }
+                else
+                {
+                    request.fd = ::open(request.file.c_str(), O_RDONLY | O_CLOEXEC);
+                    FAIL_IF(request.fd < 0);
+
+                    struct stat fileStat{};
+                    FAIL_IF(::fstat(request.fd, &fileStat) || fileStat.st_size < 0 || u64(fileStat.st_size) > std::numeric_limits<u32>::max());
+                    request.data.resize(u32(fileStat.st_size));
+                    return true;
+                }
+            }
+
+            nodisc static bool _isDone(const _IoRequest & request)
+            {
+                return request.offset >= request.data.size();
+            }
+
+            void _queueIo(_IoRequest & request, io_uring_sqe & sqe)
+            {
+                sqe.opcode = request.isWrite ? IORING_OP_WRITE : IORING_OP_READ;
+                sqe.fd = request.fd;
+                sqe.off = request.offset;
+                sqe.addr = std::bit_cast<u64>(request.data.data() + request.offset);
+                sqe.len = u32(std::min(request.data.size() - request.offset, _maxIoChunkSize));
+                sqe.user_data = std::bit_cast<u64>(&request);
+            }
+
+            static void _finish(std::unique_ptr<_IoRequest> && request, const bool success)
+            {
+                if (request->fd >= 0)
+                {
+                    ::close(request->fd);
+                    request->fd = -1;
+                }
+
+                request->done(success, success ? std::move(request->data) : List<u8>{});
+            }
+
+            // Starts the request over synchronously on the executor, for when the ring can no longer take it
+            static void _finishOnExecutor(std::unique_ptr<_IoRequest> && request)
+            {
+                if (request->fd >= 0)
+                {
+                    ::close(request->fd);
+                    request->fd = -1;
+                }
+                request->offset = 0u;
+
+                defaultExecutor().submit([request = std::shared_ptr<_IoRequest>{std::move(request)}]() { _doRequestSync(*request); });
+            }
+
+            void _run()
+            {
+                std::deque<std::unique_ptr<_IoRequest>> pending{};
+                List<_IoRequest *> ready{};
+                u32 inFlightN{0u};
+                bool stopping{false};
+                bool eventReadFailed{false};
+                bool ringFailed{false};
+
+                while (true)
+                {
+                    {
+                        const std::scoped_lock lock{_mutex};
+                        for (std::unique_ptr<_IoRequest> & request : _queue)
+                        {
+                            pending.push_back(std::move(request));
+                        }
+                        _queue.clear();
+                        stopping = _stopping;
+                    }
+
+                    if (ringFailed)
+                    {
+                        for (std::unique_ptr<_IoRequest> & request : pending)
+                        {
+                            _finishOnExecutor(std::move(request));
+                        }
+                        pending.clear();
+                    }
+
+                    // Start as many pending requests as the ring has room for, keeping one entry for the eventfd read
+                    while (!pending.empty() && inFlightN + 1u < _ring.entryN())
+                    {
+                        std::unique_ptr<_IoRequest> request{std::move(pending.front())};
+                        pending.pop_front();
+
+                        if (!_open(*request))
+                        {
+                            _finish(std::move(request), false);
+                            continue;
+                        }
+
+                        if (_isDone(*request))
+                        {
+                            _finish(std::move(request), true);
+                            continue;
+                        }
+
+                        // Owned by the ring until completion
+                        _IoRequest * const inFlightRequest{request.release()};
+                        _queueIo(*inFlightRequest, *_ring.nextSqe());
+                        ++inFlightN;
+                    }
+
+                    // Without the eventfd read nothing could wake the ring, and no new requests can arrive
+                    if ((stopping || eventReadFailed || ringFailed) && pending.empty() && !inFlightN)
+                    {
+                        return;
+                    }
+
+                    if (ringFailed)
+                    {
+                        // Requests the kernel took still complete, there is just no waiting on them
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    }
+                    else if (!_ring.submitAndWait(1u))
+                    {
+                        {
+                            const std::scoped_lock lock{_mutex};
+                            _failed = true;
+                        }
+                        ringFailed = true;
+
+                        _ring.dropUnsubmitted([&](const u64 userData)
+                        {
+                            if (userData != _eventUserData)
+                            {
+                                --inFlightN;
+                                _finishOnExecutor(std::unique_ptr<_IoRequest>{std::bit_cast<_IoRequest *>(userData)});
+                            }
+                        });
+                    }
+
+                    _ring.forEachCompletion([&](const u64 userData, const s32 result)
+                    {
+                        if (userData == _eventUserData)
+                        {
+                            if (ringFailed)
+                            {
+                                return;
+                            }
+                            // Requeuing a read that failed would just fail again, spinning the thread
+                            if (result >= 0 || result == -EINTR || result == -EAGAIN)
+                            {
+                                _queueEventRead();
+                            }
+                            else
+                            {
+                                const std::scoped_lock lock{_mutex};
+                                _failed = true;
+                                eventReadFailed = true;
+                            }
+                            return;
+                        }
+
+                        _IoRequest * const request{std::bit_cast<_IoRequest *>(userData)};
+
+                        if (result == -EINTR || result == -EAGAIN)
+                        {
+                            ready.push_back(request);
+                        }
+                        else if (result <= 0)
+                        {
+                            // Error, or the file shrank while being read
+                            --inFlightN;
+                            _finish(std::unique_ptr<_IoRequest>{request}, false);
+                        }
+                        else
+                        {
+                            request->offset += u32(result);
+                            if (_isDone(*request))
+                            {
+                                --inFlightN;
+                                _finish(std::unique_ptr<_IoRequest>{request}, true);
+                            }
+                            else
+                            {
+                                // Short read or write, continue from where it left off
+                                ready.push_back(request);
+                            }
+                        }
+                    });
+
+                    // Each in flight request has at most one entry, so there is always room to requeue
+                    for (_IoRequest * const request : ready)
+                    {
+                        if (ringFailed)
+                        {
+                            --inFlightN;
+                            _finishOnExecutor(std::unique_ptr<_IoRequest>{request});
+                        }
+                        else
+                        {
+                            _queueIo(*request, *_ring.nextSqe());
+                        }
+                    }
+                    ready.clear();
+                }
+            }
+        };
+
+      #endif
+
+        class _AsyncIo
+        {
+          public:
+
+            _AsyncIo()
+            {
+                // Starts the built in pool, if it is to be used, before this so it outlives the IO thread, which submits to it
+                static_cast<void>(defaultExecutor());
+
+              #ifdef QCI_HAS_IO_URING
+                _uring = std::make_unique<_UringService>();
+                if (!_uring->init())
+                {
+                    // Commonly unavailable in containers and sandboxes
+                    _uring.reset();
+                }
+              #endif
+            }
+
+            nodisc bool isUringEnabled() const
+            {
+              #ifdef QCI_HAS_IO_URING
+                return bool(_uring);
+              #else
+                return false;
+              #endif
+            }
+
+            void submit(std::unique_ptr<_IoRequest> && request)
+            {
+              #ifdef QCI_HAS_IO_URING
+                if (_uring && _uring->submit(request))
+                {
+                    return;
+                }
+              #endif
+
+                defaultExecutor().submit([request = std::shared_ptr<_IoRequest>{std::move(request)}]() { _doRequestSync(*request); });
+            }
+
+            void post(std::function<void()> && task)
+            {
+                defaultExecutor().submit(std::move(task));
+            }
+
+          private:
+
+          #ifdef QCI_HAS_IO_URING
+            std::unique_ptr<_UringService> _uring{};
+          #endif
+        };
+
+        _AsyncIo & _asyncIo()
+        {
+            static _AsyncIo asyncIo{};
+            return asyncIo;
+        }
+    }
+
+    template <Numeric T, u32 n>
+    void readAsync(const std::filesystem::path & file, const bool allowComponentPadding, std::function<void(Result<Image<T, n>>)> callback)
+    {
+        std::unique_ptr<_IoRequest> request{std::make_unique<_IoRequest>()};
+        request->isWrite = false;
+        request->file = file;
+        request->done = [allowComponentPadding, callback = std::move(callback)](const bool success, List<u8> && data) mutable
+        {
+            if (!success)
+            {
+                callback(Result<Image<T, n>>{});
+                return;
+            }
+
+            // Decode off the IO thread so it can keep other files moving
+            _asyncIo().post([allowComponentPadding, callback = std::move(callback), data = std::move(data)]()
+            {
+                callback(decode<T, n>(data.data(), data.size(), allowComponentPadding));
+            });
+        };
+
+        _asyncIo().submit(std::move(request));
+    }
+
+    template <Numeric T, u32 n>
+    void writeAsync(Image<T, n> && image, const std::filesystem::path & file, std::function<void(bool)> callback)
+    {
+        const std::shared_ptr<Image<T, n>> sharedImage{std::make_shared<Image<T, n>>(std::move(image))};
+
+        _asyncIo().post([sharedImage, file, callback = std::move(callback)]() mutable
+        {
+            Result<List<u8>> data{encode(*sharedImage, file.extension())};
+
+            if (!data)
+            {
+                callback(false);
+                return;
+            }
+
+            std::unique_ptr<_IoRequest> request{std::make_unique<_IoRequest>()};
+            request->isWrite = true;
+            request->file = file;
+            request->data = std::move(*data);
+            request->done = [callback = std::move(callback)](const bool success, List<u8> &&)
+            {
+                callback(success);
+            };
+
+            _asyncIo().submit(std::move(request));
+        });
+    }
+
+    bool isAsyncIoUringEnabled()
+    {
+        return _asyncIo().isUringEnabled();
+    }
+
+    // Explicit template specialization
+
+    template void readAsync<u8, 1u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u8, 1u>>)>);
+    template void readAsync<u8, 2u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u8, 2u>>)>);
+    template void readAsync<u8, 3u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u8, 3u>>)>);
+    template void readAsync<u8, 4u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u8, 4u>>)>);
+    template void readAsync<u16, 1u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u16, 1u>>)>);
+    template void readAsync<u16, 2u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u16, 2u>>)>);
+    template void readAsync<u16, 3u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u16, 3u>>)>);
+    template void readAsync<u16, 4u>(const std::filesystem::path &, bool, std::function<void(Result<Image<u16, 4u>>)>);
+    template void readAsync<f32, 1u>(const std::filesystem::path &, bool, std::function<void(Result<Image<f32, 1u>>)>);
+    template void readAsync<f32, 2u>(const std::filesystem::path &, bool, std::function<void(Result<Image<f32, 2u>>)>);
+    template void readAsync<f32, 3u>(const std::filesystem::path &, bool, std::function<void(Result<Image<f32, 3u>>)>);
+    template void readAsync<f32, 4u>(const std::filesystem::path &, bool, std::function<void(Result<Image<f32, 4u>>)>);
+
+    template void writeAsync<u8, 1u>(Image<u8, 1u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u8, 2u>(Image<u8, 2u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u8, 3u>(Image<u8, 3u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u8, 4u>(Image<u8, 4u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u16, 1u>(Image<u16, 1u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u16, 2u>(Image<u16, 2u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u16, 3u>(Image<u16, 3u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<u16, 4u>(Image<u16, 4u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<f32, 1u>(Image<f32, 1u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<f32, 2u>(Image<f32, 2u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<f32, 3u>(Image<f32, 3u> &&, const std::filesystem::path &, std::function<void(bool)>);
+    template void writeAsync<f32, 4u>(Image<f32, 4u> &&, const std::filesystem::path &, std::function<void(bool)>);
+}
@@ -0,0 +1,606 @@
+#include <qc-image/bc.hpp>
+
+#include <qc-core/utils.hpp>
+
+#include <qc-image/parallel.hpp>
+
+namespace qci::bc
+{
+    namespace
+    {
+        // Texels of one block, top row first, in structure of arrays form so per-texel loops vectorize
+        struct _GrayBlock
+        {
+            u8 values[16];
+        };
+
+        struct _RgbaBlock
+        {
+            u8 components[4][16];
+        };
+
+        // Loads the 4x4 block at block coordinates `blockPos`, counting rows down from the top, repeating edge texels
+        template <u32 n, typename Block>
+        void _loadBlock(const ImageView<u8, n, true> & image, const uivec2 blockPos, Block & block)
+        {
+            const u32 maxX{image.width() - 1u};
+            const u32 maxY{image.height() - 1u};
+
+            for (u32 j{0u}; j < 4u; ++j)
+            {
+                const u32 rowFromTop{min(blockPos.y * 4u + j, maxY)};
+                const Pixel<u8, n> * const row{image.row(s32(maxY - rowFromTop))};
+
+                for (u32 i{0u}; i < 4u; ++i)
+                {
+                    const u8 * const texel{std::bit_cast<const u8 *>(row + min(blockPos.x * 4u + i, maxX))};
+
+                    if constexpr (n == 1u)
+                    {
+                        block.values[j * 4u + i] = texel[0];
+                    }
+                    else
+                    {
+                        for (u32 c{0u}; c < n; ++c)
+                        {
+                            block.components[c][j * 4u + i] = texel[c];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Stores a decoded block, skipping texels outside the image
+        template <u32 n>
+        void _storeBlock(const ImageView<u8, n, false> & image, const uivec2 blockPos, const u8 (&texels)[16][n])
+        {
+            for (u32 j{0u}; j < 4u; ++j)
+            {
+                const u32 rowFromTop{blockPos.y * 4u + j};
+                if (rowFromTop >= image.height()) break;
+
+                Pixel<u8, n> * const row{image.row(s32(image.height() - 1u - rowFromTop))};
+
+                for (u32 i{0u}; i < 4u; ++i)
+                {
+                    const u32 x{blockPos.x * 4u + i};
+                    if (x >= image.width()) break;
+
+                    std::copy_n(texels[j * 4u + i], n, std::bit_cast<u8 *>(row + x));
+                }
+            }
+        }
+
+        void _writeU16(u8 * const dst, const u16 v)
+        {
+            dst[0] = u8(v);
+            dst[1] = u8(v >> 8);
+        }
+
+        u16 _readU16(const u8 * const src)
+        {
+            return u16(src[0] | (src[1] << 8));
+        }
+
+        //
+        // BC4
+        //
+
+        void _bc4Palette(const u8 e0, const u8 e1, u8 (&palette)[8])
+        {
+            palette[0] = e0;
+            palette[1] = e1;
+
+            if (e0 > e1)
+            {
+                for (u32 i{2u}; i < 8u; ++i)
+                {
+                    palette[i] = u8(((8u - i) * e0 + (i - 1u) * e1 + 3u) / 7u);
+                }
+            }
+            else
+            {
+                for (u32 i{2u}; i < 6u; ++i)
+                {
+                    palette[i] = u8(((6u - i) * e0 + (i - 1u) * e1 + 2u) / 5u);
+                }
+                palette[6] = 0u;
+                palette[7] = 255u;
+            }
+        }
+
+        // Picks the nearest palette entry for each value, returning the total squared error
+        u32 _bc4Indices(const u8 (&values)[16], const u8 (&palette)[8], u8 (&indices)[16])
+        {
+            u32 totalError{0u};
+
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                u32 bestError{~0u};
+                for (u32 i{0u}; i < 8u; ++i)
+                {
+                    const s32 delta{s32(values[t]) - s32(palette[i])};
+                    const u32 error{u32(delta * delta)};
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        indices[t] = u8(i);
+                    }
+                }
+                totalError += bestError;
+            }
+
+            return totalError;
+        }
+
+        void _encodeBc4Block(const u8 (&values)[16], u8 * const dst)
+        {
+            u8 lo{255u}, hi{0u};
+            // Range excluding exact 0 and 255, for the six step mode
+            u8 innerLo{255u}, innerHi{0u};
+            for (const u8 v : values)
+            {
+                minify(lo, v);
+                maxify(hi, v);
+                if (v != 0u && v != 255u)
+                {
+                    minify(innerLo, v);
+                    maxify(innerHi, v);
+                }
+            }
+
+            u8 e0, e1;
+            u8 indices[16]{};
+
+            if (lo == hi)
+            {
+                e0 = lo;
+                e1 = lo;
+            }
+            else
+            {
+                // Eight steps over the whole range
+                u8 palette8[8];
+                u8 indices8[16];
+                _bc4Palette(hi, lo, palette8);
+                const u32 error8{_bc4Indices(values, palette8, indices8)};
+
+                // Six steps over the range between the saturated values, which are represented exactly
+                if (innerLo > innerHi) innerLo = innerHi = 0u;
+                u8 palette6[8];
+                u8 indices6[16];
+                _bc4Palette(innerLo, innerHi, palette6);
+                const u32 error6{_bc4Indices(values, palette6, indices6)};
+
+                if (error8 <= error6)
+                {
+                    e0 = hi;
+                    e1 = lo;
+                    std::copy_n(indices8, 16u, indices);
+                }
+                else
+                {
+                    e0 = innerLo;
+                    e1 = innerHi;
+                    std::copy_n(indices6, 16u, indices);
+                }
+            }
+
+            dst[0] = e0;
+            dst[1] = e1;
+
+            u64 bits{0u};
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                bits |= u64(indices[t]) << (3u * t);
+            }
+            for (u32 i{0u}; i < 6u; ++i)
+            {
+                dst[2u + i] = u8(bits >> (8u * i));
+            }
+        }
+
+        void _decodeBc4Block(const u8 * const src, u8 (&values)[16][1])
+        {
+            u8 palette[8];
+            _bc4Palette(src[0], src[1], palette);
+
+            u64 bits{0u};
+            for (u32 i{0u}; i < 6u; ++i)
+            {
+                bits |= u64(src[2u + i]) << (8u * i);
+            }
+
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                values[t][0] = palette[(bits >> (3u * t)) & 7u];
+            }
+        }
+
+        //
+        // BC1
+        //
+
+        u16 _to565(const fvec3 & color)
+        {
+            const u32 r{u32(clamp(color.x, 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f)};
+            const u32 g{u32(clamp(color.y, 0.0f, 255.0f) * (63.0f / 255.0f) + 0.5f)};
+            const u32 b{u32(clamp(color.z, 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f)};
+            return u16((r << 11) | (g << 5) | b);
+        }
+
+        ivec3 _from565(const u16 color)
+        {
+            const s32 r{(color >> 11) & 31};
+            const s32 g{(color >> 5) & 63};
+            const s32 b{color & 31};
+            return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+        }
+
+        void _bc1Palette(const u16 c0, const u16 c1, const bool fourColor, ivec3 (&palette)[4])
+        {
+            palette[0] = _from565(c0);
+            palette[1] = _from565(c1);
+
+            if (fourColor)
+            {
+                palette[2] = (2 * palette[0] + palette[1]) / 3;
+                palette[3] = (palette[0] + 2 * palette[1]) / 3;
+            }
+            else
+            {
+                palette[2] = (palette[0] + palette[1]) / 2;
+                palette[3] = ivec3{0};
+            }
+        }
+
+        // Picks the nearest four color mode palette entry for each texel, returning the total squared error
+        u32 _bc1Indices(const _RgbaBlock & block, const u16 c0, const u16 c1, u8 (&indices)[16])
+        {
+            ivec3 palette[4];
+            _bc1Palette(c0, c1, true, palette);
+
+            u32 totalError{0u};
+
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                const ivec3 color{block.components[0][t], block.components[1][t], block.components[2][t]};
+                u32 bestError{~0u};
+                for (u32 i{0u}; i < 4u; ++i)
+                {
+                    const ivec3 delta{color - palette[i]};
+                    const u32 error{u32(dot(delta, delta))};
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        indices[t] = u8(i);
+                    }
+                }
+                totalError += bestError;
+            }
+
+            return totalError;
+        }
+
+        // Least squares endpoints for the given indices, or false if they are degenerate
+        bool _refineBc1Endpoints(const _RgbaBlock & block, const u8 (&indices)[16], fvec3 & e0, fvec3 & e1)
+        {
+            constexpr f32 weights[4]{1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+            f32 aa{0.0f}, ab{0.0f}, bb{0.0f};
+            fvec3 ax{0.0f}, bx{0.0f};
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                const f32 a{weights[indices[t]]};
+                const f32 b{1.0f - a};
+                const fvec3 x{f32(block.components[0][t]), f32(block.components[1][t]), f32(block.components[2][t])};
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                ax += a * x;
+                bx += b * x;
+            }
+
+            const f32 det{aa * bb - ab * ab};
+            if (abs(det) < 1.0e-6f)
+            {
+                return false;
+            }
+
+            const f32 invDet{1.0f / det};
+            e0 = (bb * ax - ab * bx) * invDet;
+            e1 = (aa * bx - ab * ax) * invDet;
+            return true;
+        }
+
+        void _encodeBc1Block(const _RgbaBlock & block, u8 * const dst)
+        {
+            // Principal axis of the colors
+
+            fvec3 mean{0.0f};
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                mean += fvec3{f32(block.components[0][t]), f32(block.components[1][t]), f32(block.components[2][t])};
+            }
+            mean /= 16.0f;
+
+            f32 cov[6]{};
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                const fvec3 d{fvec3{f32(block.components[0][t]), f32(block.components[1][t]), f32(block.components[2][t])} - mean};
+                cov[0] += d.x * d.x;
+                cov[1] += d.x * d.y;
+                cov[2] += d.x * d.z;
+                cov[3] += d.y * d.y;
+                cov[4] += d.y * d.z;
+                cov[5] += d.z * d.z;
+            }
+
+            fvec3 axis{1.0f, 1.0f, 1.0f};
+            for (u32 i{0u}; i < 4u; ++i)
+            {
+                axis = fvec3{
+                    cov[0] * axis.x + cov[1] * axis.y + cov[2] * axis.z,
+                    cov[1] * axis.x + cov[3] * axis.y + cov[4] * axis.z,
+                    cov[2] * axis.x + cov[4] * axis.y + cov[5] * axis.z};
+                const f32 length2{dot(axis, axis)};
+                if (length2 < 1.0e-12f)
+                {
+                    axis = fvec3{0.0f};
+                    break;
+                }
+                axis /= std::sqrt(length2);
+            }
+
+            // Range fit along the axis
+
+            f32 minT{0.0f}, maxT{0.0f};
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                const fvec3 d{fvec3{f32(block.components[0][t]), f32(block.components[1][t]), f32(block.components[2][t])} - mean};
+                const f32 proj{dot(d, axis)};
+                minify(minT, proj);
+                maxify(maxT, proj);
+            }
+
+            u16 c0{_to565(mean + axis * maxT)};
+            u16 c1{_to565(mean + axis * minT)};
+            u8 indices[16];
+            u32 error{_bc1Indices(block, c0, c1, indices)};
+
+            // One least squares refinement, kept only if better
+
+            fvec3 e0, e1;
+            if (_refineBc1Endpoints(block, indices, e0, e1))
+            {
+                const u16 refinedC0{_to565(e0)};
+                const u16 refinedC1{_to565(e1)};
+                u8 refinedIndices[16];
+                const u32 refinedError{_bc1Indices(block, refinedC0, refinedC1, refinedIndices)};
+                if (refinedError < error)
+                {
+                    c0 = refinedC0;
+                    c1 = refinedC1;
+                    error = refinedError;
+                    std::copy_n(refinedIndices, 16u, indices);
+                }
+            }
+
+            // Four color mode requires `c0 > c1`
+            if (c0 < c1)
+            {
+                std::swap(c0, c1);
+                for (u8 & index : indices) index ^= 1u;
+            }
+            else if (c0 == c1)
+            {
+                for (u8 & index : indices) index = 0u;
+            }
+
+            _writeU16(dst, c0);
+            _writeU16(dst + 2, c1);
+
+            u32 bits{0u};
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                bits |= u32(indices[t]) << (2u * t);
+            }
+            for (u32 i{0u}; i < 4u; ++i)
+            {
+                dst[4u + i] = u8(bits >> (8u * i));
+            }
+        }
+
+        void _decodeBc1Block(const u8 * const src, const bool alwaysFourColor, u8 (&texels)[16][4])
+        {
+            const u16 c0{_readU16(src)};
+            const u16 c1{_readU16(src + 2)};
+            const bool fourColor{alwaysFourColor || c0 > c1};
+
+            ivec3 palette[4];
+            _bc1Palette(c0, c1, fourColor, palette);
+
+            const u32 bits{u32(src[4]) | (u32(src[5]) << 8) | (u32(src[6]) << 16) | (u32(src[7]) << 24)};
+
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                const u32 index{(bits >> (2u * t)) & 3u};
+                const ivec3 & color{palette[index]};
+                texels[t][0] = u8(color.x);
+                texels[t][1] = u8(color.y);
+                texels[t][2] = u8(color.z);
+                texels[t][3] = !fourColor && index == 3u ? 0u : 255u;
+            }
+        }
+
+        //
+        // Common
+        //
+
+        template <u32 n, typename EncodeBlockF>
+        CompressedImage _encode(const ImageView<u8, n, true> & image, const Format format, Executor & executor, const EncodeBlockF & encodeBlock)
+        {
+            CompressedImage compressed{.format = format, .size = image.size()};
+
+            FAIL_IF(!image.width() || !image.height());
+
+            const uivec2 blockCount{compressed.blockCount()};
+            const u32 rowSize{blockCount.x * blockSize(format)};
+            compressed.data.resize(blockCount.y * rowSize);
+
+            executor.parallelFor(blockCount.y, 4u, [&](const u32 beginRow, const u32 endRow)
+            {
+                for (uivec2 blockPos{0u, beginRow}; blockPos.y < endRow; ++blockPos.y)
+                {
+                    u8 * dst{compressed.data.data() + blockPos.y * rowSize};
+                    for (blockPos.x = 0u; blockPos.x < blockCount.x; ++blockPos.x, dst += blockSize(format))
+                    {
+                        encodeBlock(blockPos, dst);
+                    }
+                }
+            });
+
+            return compressed;
+        }
+
+        template <u32 n, typename DecodeBlockF>
+        Image<u8, n> _decode(const CompressedImage & compressed, const Format format, const DecodeBlockF & decodeBlock)
+        {
+            const uivec2 blockCount{compressed.blockCount()};
+
+            FAIL_IF(compressed.format != format);
+            FAIL_IF(!compressed.size.x || !compressed.size.y);
+            FAIL_IF(compressed.data.size() != blockCount.x * blockCount.y * blockSize(format));
+
+            Image<u8, n> image{compressed.size};
+            const typename Image<u8, n>::View view{image.view()};
+
+            const u8 * src{compressed.data.data()};
+            for (uivec2 blockPos{0u}; blockPos.y < blockCount.y; ++blockPos.y)
+            {
+                for (blockPos.x = 0u; blockPos.x < blockCount.x; ++blockPos.x, src += blockSize(format))
+                {
+                    u8 texels[16][n];
+                    decodeBlock(src, texels);
+                    _storeBlock<n>(view, blockPos, texels);
+                }
+            }
+
+            return image;
+        }
+    }
+
+    CompressedImage encodeBc4(const GrayImage::CView & image, Executor & executor)
+    {
+        return _encode<1u>(image, Format::bc4, executor, [&](const uivec2 blockPos, u8 * const dst)
+        {
+            _GrayBlock block;
+            _loadBlock<1u>(image, blockPos, block);
+            _encodeBc4Block(block.values, dst);
+        });
+    }
+
+    CompressedImage encodeBc1(const RgbaImage::CView & image, Executor & executor)
+    {
+        return _encode<4u>(image, Format::bc1, executor, [&](const uivec2 blockPos, u8 * const dst)
+        {
+            _RgbaBlock block;
+            _loadBlock<4u>(image, blockPos, block);
+            _encodeBc1Block(block, dst);
+        });
+    }
+
+    CompressedImage encodeBc3(const RgbaImage::CView & image, Executor & executor)
+    {
+        return _encode<4u>(image, Format::bc3, executor, [&](const uivec2 blockPos, u8 * const dst)
+        {
+            _RgbaBlock block;
+            _loadBlock<4u>(image, blockPos, block);
+            _encodeBc4Block(block.components[3], dst);
+            _encodeBc1Block(block, dst + 8);
+        });
+    }
+
+    GrayImage decodeBc4(const CompressedImage & image)
+    {
+        return _decode<1u>(image, Format::bc4, [](const u8 * const src, u8 (&texels)[16][1])
+        {
+            _decodeBc4Block(src, texels);
+        });
+    }
+
+    RgbaImage decodeBc1(const CompressedImage & image)
+    {
+        return _decode<4u>(image, Format::bc1, [](const u8 * const src, u8 (&texels)[16][4])
+        {
+            _decodeBc1Block(src, false, texels);
+        });
+    }
+
+    RgbaImage decodeBc3(const CompressedImage & image)
+    {
+        return _decode<4u>(image, Format::bc3, [](const u8 * const src, u8 (&texels)[16][4])
+        {
+            u8 alphas[16][1];
+            _decodeBc4Block(src, alphas);
+            _decodeBc1Block(src + 8, true, texels);
+            for (u32 t{0u}; t < 16u; ++t)
+            {
+                texels[t][3] = alphas[t][0];
+            }
+        });
+    }
+
+    bool writeDds(const CompressedImage & image, const std::filesystem::path & file)
+    {
+        constexpr u32 headerSize{128u};
+
+        FAIL_IF(!image.size.x || !image.size.y || !image.data);
+
+        List<u8> data{};
+        data.resize(headerSize + image.data.size());
+        std::fill_n(data.data(), headerSize, u8(0u));
+
+        const auto writeU32{[&data](const u32 offset, const u32 v)
+        {
+            for (u32 i{0u}; i < 4u; ++i)
+            {
+                data[offset + i] = u8(v >> (8u * i));
+            }
+        }};
+
+        const auto fourCc{[](const char (&code)[5]) -> u32
+        {
+            return u32(u8(code[0])) | (u32(u8(code[1])) << 8) | (u32(u8(code[2])) << 16) | (u32(u8(code[3])) << 24);
+        }};
+
+        u32 formatCode{};
+        switch (image.format)
+        {
+            case Format::bc1: formatCode = fourCc("DXT1"); break;
+            case Format::bc3: formatCode = fourCc("DXT5"); break;
+            case Format::bc4: formatCode = fourCc("BC4U"); break;
+        }
+
+        writeU32(0u, fourCc("DDS "));
+        // DDS_HEADER
+        writeU32(4u, 124u); // Size
+        writeU32(8u, 0x1u | 0x2u | 0x4u | 0x1000u | 0x80000u); // Flags: caps, height, width, pixel format, linear size
+        writeU32(12u, image.size.y);
+        writeU32(16u, image.size.x);
+        writeU32(20u, image.data.size()); // Linear size
+        writeU32(28u, 1u); // Mip count
+        // DDS_PIXELFORMAT
+        writeU32(76u, 32u); // Size
+        writeU32(80u, 0x4u); // Flags: four CC
+        writeU32(84u, formatCode);
+        // Caps
+        writeU32(108u, 0x1000u); // Texture
+
+        std::copy_n(image.data.data(), image.data.size(), data.data() + headerSize);
+
+        FAIL_IF(!utils::writeFile(file, data.data(), data.size()));
+
+        return true;
+    }
+}
@@ -0,0 +1,319 @@
+#include <qc-image/compare.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define _QCI_COMPARE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#include <cmath>
+#include <mutex>
+
+#include <qc-image/parallel.hpp>
+
+namespace qci
+{
+    namespace
+    {
+        // Totals over some rows, combined across threads at the end
+        struct _DiffTotals
+        {
+            f64 maxAbsDiff;
+            u64 mismatchN;
+            f64 squaredDiffSum;
+        };
+
+        // Side length and stride of SSIM windows
+        constexpr u32 _ssimWindowSize{8u};
+        constexpr u32 _ssimWindowStride{4u};
+
+        template <typename T>
+        constexpr f64 _peak()
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                return 1.0;
+            }
+            else
+            {
+                return f64(std::numeric_limits<T>::max());
+            }
+        }
+
+        // NaNs differ from everything by infinity, and equal infinities differ by nothing
+        template <typename T>
+        finline f64 _absDiff(const T a, const T b)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (a == b)
+                {
+                    return 0.0;
+                }
+                const f64 d{std::abs(f64(a) - f64(b))};
+                return d == d ? d : std::numeric_limits<f64>::infinity();
+            }
+            else
+            {
+                return a > b ? f64(a - b) : f64(b - a);
+            }
+        }
+
+        // Max absolute difference and sum of squared differences of `count` components
+        template <typename T>
+        void _diffComponents(const T * const a, const T * const b, const u64 count, f64 & maxAbsDiff, f64 & squaredDiffSum)
+        {
+            if constexpr (std::is_integral_v<T>)
+            {
+                // Integer accumulation so the loop vectorizes
+                u32 maxDiff{0u};
+                u64 sum{0u};
+                for (u64 i{0u}; i < count; ++i)
+                {
+                    const u32 d{a[i] > b[i] ? u32(a[i] - b[i]) : u32(b[i] - a[i])};
+                    maxDiff = max(maxDiff, d);
+                    sum += u64(d) * d;
+                }
+                maxAbsDiff = max(maxAbsDiff, f64(maxDiff));
+                squaredDiffSum += f64(sum);
+            }
+            else
+            {
+                f32 maxDiff{0.0f};
+                f64 sum{0.0};
+                for (u64 i{0u}; i < count; ++i)
+                {
+                    // Same as `_absDiff`, but selected without branches so the loop vectorizes
+                    const f32 absDiff{abs(a[i] - b[i])};
+                    const f32 d{a[i] == b[i] ? 0.0f : absDiff == absDiff ? absDiff : number::inf<f32>};
+                    maxDiff = max(maxDiff, d);
+                    sum += f64(d) * d;
+                }
+                maxAbsDiff = max(maxAbsDiff, f64(maxDiff));
+                squaredDiffSum += sum;
+            }
+        }
+
+      #ifdef _QCI_COMPARE_SSE2
+        template <>
+        void _diffComponents(const u8 * const a, const u8 * const b, const u64 count, f64 & maxAbsDiff, f64 & squaredDiffSum)
+        {
+            const __m128i zero{_mm_setzero_si128()};
+            __m128i maxV{zero};
+            __m128i sumV{zero};
+            u64 sum{0u};
+            u32 blockN{0u};
+
+            // Each 32 bit lane gains at most 4 * 255^2 per block, so must be flushed before 2^31 / 260100 blocks
+            const auto flush{[&]()
+            {
+                alignas(16) u32 lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i *>(lanes), sumV);
+                sum += u64(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+                sumV = zero;
+                blockN = 0u;
+            }};
+
+            u64 i{0u};
+            for (; i + 16u <= count; i += 16u)
+            {
+                const __m128i va{_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i))};
+                const __m128i vb{_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i))};
+                const __m128i d{_mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va))};
+                maxV = _mm_max_epu8(maxV, d);
+
+                const __m128i lo{_mm_unpacklo_epi8(d, zero)};
+                const __m128i hi{_mm_unpackhi_epi8(d, zero)};
+                sumV = _mm_add_epi32(sumV, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+
+                if (++blockN == 4096u)
+                {
+                    flush();
+                }
+            }
+
+            flush();
+
+            alignas(16) u8 maxes[16];
+            _mm_store_si128(reinterpret_cast<__m128i *>(maxes), maxV);
+            u32 maxDiff{0u};
+            for (const u8 m : maxes)
+            {
+                maxDiff = max(maxDiff, u32(m));
+            }
+
+            for (; i < count; ++i)
+            {
+                const u32 d{a[i] > b[i] ? u32(a[i] - b[i]) : u32(b[i] - a[i])};
+                maxDiff = max(maxDiff, d);
+                sum += d * d;
+            }
+
+            maxAbsDiff = max(maxAbsDiff, f64(maxDiff));
+            squaredDiffSum += f64(sum);
+        }
+      #endif
+
+        template <typename T, u32 n>
+        u64 _countMismatches(const T * const a, const T * const b, const u32 width, const f64 tolerance)
+        {
+            u64 mismatchN{0u};
+            for (u32 x{0u}; x < width; ++x)
+            {
+                for (u32 c{0u}; c < n; ++c)
+                {
+                    if (_absDiff(a[x * n + c], b[x * n + c]) > tolerance)
+                    {
+                        ++mismatchN;
+                        break;
+                    }
+                }
+            }
+            return mismatchN;
+        }
+
+        // Sum over components of the SSIM of the window with its bottom left corner at `pos`
+        template <typename T, u32 n>
+        f64 _windowSsim(const ImageView<T, n, true> & a, const ImageView<T, n, true> & b, const ivec2 pos, const uivec2 windowSize)
+        {
+            constexpr f64 c1{(0.01 * _peak<T>()) * (0.01 * _peak<T>())};
+            constexpr f64 c2{(0.03 * _peak<T>()) * (0.03 * _peak<T>())};
+
+            f64 sumA[n]{}, sumB[n]{}, sumAA[n]{}, sumBB[n]{}, sumAB[n]{};
+
+            for (u32 y{0u}; y < windowSize.y; ++y)
+            {
+                const T * const rowA{std::bit_cast<const T *>(a.row(pos.y + s32(y)) + pos.x)};
+                const T * const rowB{std::bit_cast<const T *>(b.row(pos.y + s32(y)) + pos.x)};
+
+                for (u32 x{0u}; x < windowSize.x; ++x)
+                {
+                    for (u32 c{0u}; c < n; ++c)
+                    {
+                        const f64 va{f64(rowA[x * n + c])};
+                        const f64 vb{f64(rowB[x * n + c])};
+                        sumA[c] += va;
+                        sumB[c] += vb;
+                        sumAA[c] += va * va;
+                        sumBB[c] += vb * vb;
+                        sumAB[c] += va * vb;
+                    }
+                }
+            }
+
+            const f64 invN{1.0 / f64(windowSize.x * windowSize.y)};
+            f64 ssim{0.0};
+
+            for (u32 c{0u}; c < n; ++c)
+            {
+                const f64 meanA{sumA[c] * invN};
+                const f64 meanB{sumB[c] * invN};
+                const f64 varA{sumAA[c] * invN - meanA * meanA};
+                const f64 varB{sumBB[c] * invN - meanB * meanB};
+                const f64 covar{sumAB[c] * invN - meanA * meanB};
+                ssim += ((2.0 * meanA * meanB + c1) * (2.0 * covar + c2)) / ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+            }
+
+            return ssim;
+        }
+
+        template <typename T, u32 n>
+        f64 _ssim(const ImageView<T, n, true> & a, const ImageView<T, n, true> & b, Executor & executor)
+        {
+            // Images smaller than a window are taken as a single window
+            const uivec2 windowSize{min(a.size(), uivec2{_ssimWindowSize})};
+            const uivec2 windowCounts{(a.size() - windowSize) / _ssimWindowStride + 1u};
+
+            std::mutex mutex{};
+            f64 total{0.0};
+
+            executor.parallelFor(windowCounts.y, 4u, [&](const u32 beginY, const u32 endY)
+            {
+                f64 sum{0.0};
+                for (u32 wy{beginY}; wy < endY; ++wy)
+                {
+                    for (u32 wx{0u}; wx < windowCounts.x; ++wx)
+                    {
+                        sum += _windowSsim(a, b, ivec2(uivec2{wx, wy} * _ssimWindowStride), windowSize);
+                    }
+                }
+
+                const std::scoped_lock lock{mutex};
+                total += sum;
+            });
+
+            return total / (f64(windowCounts.x) * f64(windowCounts.y) * n);
+        }
+    }
+
+    template <Numeric T, u32 n>
+    Result<ImageDiff> compare(const ImageView<T, n, true> & a, const ImageView<T, n, true> & b, const f64 tolerance, const bool calcSsim, Executor & executor)
+    {
+        FAIL_IF(a.size() != b.size());
+
+        const u32 width{a.width()};
+        const u32 height{a.height()};
+        const u64 rowComponentN{u64(width) * n};
+
+        std::mutex mutex{};
+        _DiffTotals totals{};
+
+        // At least a few tens of thousands of components per chunk, so small images stay on one thread
+        const u32 grain{u32(max(u64(1u), (u64(1u) << 16) / max(rowComponentN, u64(1u))))};
+
+        executor.parallelFor(height, grain, [&](const u32 beginY, const u32 endY)
+        {
+            _DiffTotals chunkTotals{};
+
+            for (u32 y{beginY}; y < endY; ++y)
+            {
+                const T * const rowA{std::bit_cast<const T *>(a.row(s32(y)))};
+                const T * const rowB{std::bit_cast<const T *>(b.row(s32(y)))};
+
+                f64 rowMaxAbsDiff{0.0};
+                _diffComponents(rowA, rowB, rowComponentN, rowMaxAbsDiff, chunkTotals.squaredDiffSum);
+
+                if (rowMaxAbsDiff > tolerance)
+                {
+                    chunkTotals.mismatchN += _countMismatches<T, n>(rowA, rowB, width, tolerance);
+                }
+
+                chunkTotals.maxAbsDiff = max(chunkTotals.maxAbsDiff, rowMaxAbsDiff);
+            }
+
+            const std::scoped_lock lock{mutex};
+            totals.maxAbsDiff = max(totals.maxAbsDiff, chunkTotals.maxAbsDiff);
+            totals.mismatchN += chunkTotals.mismatchN;
+            totals.squaredDiffSum += chunkTotals.squaredDiffSum;
+        });
+
+        const u64 componentN{rowComponentN * height};
+
+        ImageDiff diff{};
+        diff.maxAbsDiff = totals.maxAbsDiff;
+        diff.mismatchN = totals.mismatchN;
+        diff.mse = componentN ? totals.squaredDiffSum / f64(componentN) : 0.0;
+        diff.psnr = diff.mse > 0.0 ? 10.0 * std::log10(_peak<T>() * _peak<T>() / diff.mse) : std::numeric_limits<f64>::infinity();
+
+        if (calcSsim && componentN)
+        {
+            diff.ssim = _ssim(a, b, executor);
+        }
+
+        return diff;
+    }
+
+    // Explicit template specialization
+
+    template Result<ImageDiff> compare<u8, 1u>(const ImageView<u8, 1u, true> &, const ImageView<u8, 1u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u8, 2u>(const ImageView<u8, 2u, true> &, const ImageView<u8, 2u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u8, 3u>(const ImageView<u8, 3u, true> &, const ImageView<u8, 3u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u8, 4u>(const ImageView<u8, 4u, true> &, const ImageView<u8, 4u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u16, 1u>(const ImageView<u16, 1u, true> &, const ImageView<u16, 1u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u16, 2u>(const ImageView<u16, 2u, true> &, const ImageView<u16, 2u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u16, 3u>(const ImageView<u16, 3u, true> &, const ImageView<u16, 3u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<u16, 4u>(const ImageView<u16, 4u, true> &, const ImageView<u16, 4u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<f32, 1u>(const ImageView<f32, 1u, true> &, const ImageView<f32, 1u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<f32, 2u>(const ImageView<f32, 2u, true> &, const ImageView<f32, 2u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<f32, 3u>(const ImageView<f32, 3u, true> &, const ImageView<f32, 3u, true> &, f64, bool, Executor &);
+    template Result<ImageDiff> compare<f32, 4u>(const ImageView<f32, 4u, true> &, const ImageView<f32, 4u, true> &, f64, bool, Executor &);
+}
@@ -0,0 +1,826 @@
+#include <qc-image/font.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <qc-core/utils.hpp>
+
+namespace qci::font
+{
+    namespace
+    {
+        // Composite glyphs nesting deeper than this are taken to be malformed or cyclic
+        constexpr u32 _maxCompositeDepth{8u};
+
+        // Most glyphs plus points read for any one outline, so composites referencing the same glyphs over and over cannot take exponential time
+        constexpr u32 _outlineBudget{1u << 17};
+
+        // Simple glyph point flags
+        constexpr u8 _onCurveFlag{1u << 0};
+        constexpr u8 _xShortFlag{1u << 1};
+        constexpr u8 _yShortFlag{1u << 2};
+        constexpr u8 _repeatFlag{1u << 3};
+        constexpr u8 _xSameOrPositiveFlag{1u << 4};
+        constexpr u8 _ySameOrPositiveFlag{1u << 5};
+
+        // Composite glyph component flags
+        constexpr u16 _argsAreWordsFlag{1u << 0};
+        constexpr u16 _argsAreOffsetsFlag{1u << 1};
+        constexpr u16 _scaleFlag{1u << 3};
+        constexpr u16 _moreComponentsFlag{1u << 5};
+        constexpr u16 _xyScaleFlag{1u << 6};
+        constexpr u16 _twoByTwoFlag{1u << 7};
+
+        u16 _readU16BigEndian(const u8 * const src)
+        {
+            return u16((u32(src[0]) << 8) | u32(src[1]));
+        }
+
+        s16 _readS16BigEndian(const u8 * const src)
+        {
+            return s16(_readU16BigEndian(src));
+        }
+
+        u32 _readU32BigEndian(const u8 * const src)
+        {
+            return (u32(src[0]) << 24) | (u32(src[1]) << 16) | (u32(src[2]) << 8) | u32(src[3]);
+        }
+
+        // 2.14 fixed point
+        f32 _readF2Dot14(const u8 * const src)
+        {
+            return f32(_readS16BigEndian(src)) * (1.0f / 16384.0f);
+        }
+
+        struct _TableRecord
+        {
+            u32 offset;
+            u32 size;
+        };
+
+        // Finds the table in the font's directory at `fontOffset`, checking that it lies within the data
+        nodisc Result<_TableRecord> _findTable(const List<u8> & data, const u32 fontOffset, const char (& tag)[5])
+        {
+            FAIL_IF(u64(fontOffset) + 12u > data.size());
+            const u32 tableN{_readU16BigEndian(data.data() + fontOffset + 4u)};
+            FAIL_IF(u64(fontOffset) + 12u + u64(tableN) * 16u > data.size());
+
+            for (u32 i{0u}; i < tableN; ++i)
+            {
+                const u8 * const record{data.data() + fontOffset + 12u + i * 16u};
+                if (!std::memcmp(record, tag, 4u))
+                {
+                    const u32 offset{_readU32BigEndian(record + 8u)};
+                    const u32 size{_readU32BigEndian(record + 12u)};
+                    FAIL_IF(u64(offset) + size > data.size());
+                    return _TableRecord{offset, size};
+                }
+            }
+
+            return {};
+        }
+
+        // Higher is better, 0 is unusable
+        u32 _cmapSubtableScore(const u32 platform, const u32 encoding, const u32 format)
+        {
+            const bool unicode{platform == 0u || (platform == 3u && (encoding == 1u || encoding == 10u))};
+            const bool symbol{platform == 3u && encoding == 0u};
+
+            if (!unicode && !symbol)
+            {
+                return 0u;
+            }
+
+            switch (format)
+            {
+                case 12u: return 4u;
+                case 4u: return unicode ? 3u : 2u;
+                case 6u: return 1u;
+                default: return 0u;
+            }
+        }
+
+        void _addLine(sdf::Contour & contour, const fvec2 p1, const fvec2 p2)
+        {
+            if (p1 != p2)
+            {
+                contour.segments.push_back(sdf::Segment{p1, p2});
+            }
+        }
+
+        // Degenerate curves are left for `normalize` to demote or drop
+        void _addCurve(sdf::Contour & contour, const fvec2 p1, const fvec2 p2, const fvec2 p3)
+        {
+            contour.segments.push_back(sdf::Segment{p1, p2, p3});
+        }
+
+        // TrueType contours are quadratic B-splines: two off curve points in a row have an implied on curve point halfway between them
+        void _addContour(const fvec2 * const points, const u8 * const flags, const u32 pointN, sdf::Outline & outline)
+        {
+            if (pointN < 2u)
+            {
+                return;
+            }
+
+            // Start on an on curve point if there is one, otherwise on the implied point before the first
+            u32 startI{0u};
+            while (startI < pointN && !(flags[startI] & _onCurveFlag))
+            {
+                ++startI;
+            }
+            const bool allOff{startI == pointN};
+            const fvec2 start{allOff ? (points[pointN - 1u] + points[0]) * 0.5f : points[startI]};
+            if (allOff)
+            {
+                startI = pointN - 1u;
+            }
+
+            sdf::Contour & contour{outline.contours.emplace_back()};
+            fvec2 prev{start};
+            fvec2 control{};
+            bool hasControl{false};
+
+            for (u32 k{1u}; k <= pointN; ++k)
+            {
+                const u32 i{(startI + k) % pointN};
+                const fvec2 p{points[i]};
+
+                if (flags[i] & _onCurveFlag)
+                {
+                    if (hasControl)
+                    {
+                        _addCurve(contour, prev, control, p);
+                        hasControl = false;
+                    }
+                    else
+                    {
+                        _addLine(contour, prev, p);
+                    }
+                    prev = p;
+                }
+                else
+                {
+                    if (hasControl)
+                    {
+                        const fvec2 mid{(control + p) * 0.5f};
+                        _addCurve(contour, prev, control, mid);
+                        prev = mid;
+                    }
+                    control = p;
+                    hasControl = true;
+                }
+            }
+
+            // Only reached with a pending control point if every point was off curve
+            if (hasControl)
+            {
+                _addCurve(contour, prev, control, start);
+            }
+            else
+            {
+                _addLine(contour, prev, start);
+            }
+
+            contour.normalize();
+            if (contour.segments.size() < 2u)
+            {
+                outline.contours.pop_back();
+            }
+        }
+
+        nodisc std::shared_ptr<const GlyphSdf> _generateGlyph(const Font & font, const u32 glyph, const f32 emSize, const f32 range)
+        {
+            const Result<sdf::Outline> outline{font.outline(glyph)};
+            if (!outline)
+            {
+                return nullptr;
+            }
+
+            const f32 scale{emSize / f32(font.unitsPerEm())};
+
+            std::shared_ptr<GlyphSdf> sdf{std::make_shared<GlyphSdf>()};
+            sdf->advance = f32(font.metrics(glyph).advance) * scale;
+
+            if (outline->contours)
+            {
+                // Control points bound their curves, so are enough for the bounds
+                fspan2 bounds{fvec2{number::inf<f32>}, fvec2{-number::inf<f32>}};
+                for (const sdf::Contour & contour : outline->contours)
+                {
+                    for (const sdf::Segment & segment : contour.segments)
+                    {
+                        minify(bounds.min, segment.line.p1);
+                        maxify(bounds.max, segment.line.p1);
+                        minify(bounds.min, segment.line.p2);
+                        maxify(bounds.max, segment.line.p2);
+                        if (segment.type == sdf::SegmentType::curve)
+                        {
+                            minify(bounds.min, segment.curve.p3);
+                            maxify(bounds.max, segment.curve.p3);
+                        }
+                    }
+                }
+
+                // Half the range on each side is enough for every pixel beyond it to saturate
+                const fvec2 extent{(bounds.max - bounds.min) * scale};
+                const u32 size{max(u32(std::ceil(max(extent.x, extent.y) + range)), 1u)};
+                const fvec2 translate{fvec2{f32(size) * 0.5f} - (bounds.min + bounds.max) * (scale * 0.5f)};
+
+                sdf->image = sdf::generate(*outline, sdf::Transform::scaleTranslate(fvec2{scale}, translate), size, range);
+                sdf->origin = translate;
+            }
+
+            return sdf;
+        }
+
+        struct _CacheEntry
+        {
+            std::shared_future<std::shared_ptr<const GlyphSdf>> sdf{};
+            // Position in the recency list, most recent first
+            std::list<u32>::iterator recency{};
+            u64 byteN{};
+            bool ready{};
+        };
+    }
+
+    Result<Font> decode(List<u8> data, const u32 fontIndex)
+    {
+        FAIL_IF(data.size() < 12u || data.size() > u64(std::numeric_limits<u32>::max()));
+
+        // Collections start with a header listing each font's table directory
+        u32 fontOffset{0u};
+        if (!std::memcmp(data.data(), "ttcf", 4u))
+        {
+            const u32 fontN{_readU32BigEndian(data.data() + 8u)};
+            FAIL_IF(fontIndex >= fontN || 12u + u64(fontIndex) * 4u + 4u > data.size());
+            fontOffset = _readU32BigEndian(data.data() + 12u + fontIndex * 4u);
+        }
+        else
+        {
+            FAIL_IF(fontIndex != 0u);
+        }
+
+        // Either TrueType version, but not `OTTO`, which has CFF outlines instead of `glyf`
+        FAIL_IF(u64(fontOffset) + 4u > data.size());
+        const u32 version{_readU32BigEndian(data.data() + fontOffset)};
+        FAIL_IF(version != 0x00010000u && version != 0x74727565u);
+
+        const Result<_TableRecord> head{_findTable(data, fontOffset, "head")};
+        const Result<_TableRecord> maxp{_findTable(data, fontOffset, "maxp")};
+        const Result<_TableRecord> hhea{_findTable(data, fontOffset, "hhea")};
+        const Result<_TableRecord> hmtx{_findTable(data, fontOffset, "hmtx")};
+        const Result<_TableRecord> loca{_findTable(data, fontOffset, "loca")};
+        const Result<_TableRecord> glyf{_findTable(data, fontOffset, "glyf")};
+        const Result<_TableRecord> cmap{_findTable(data, fontOffset, "cmap")};
+        FAIL_IF(!head || !maxp || !hhea || !hmtx || !loca || !glyf || !cmap);
+        FAIL_IF(head->size < 54u || maxp->size < 6u || hhea->size < 36u || cmap->size < 4u);
+
+        Font font{};
+        const u8 * const bytes{data.data()};
+
+        font._unitsPerEm = _readU16BigEndian(bytes + head->offset + 18u);
+        font._longLoca = _readS16BigEndian(bytes + head->offset + 50u) != 0;
+        font._glyphN = _readU16BigEndian(bytes + maxp->offset + 4u);
+        font._ascent = _readS16BigEndian(bytes + hhea->offset + 4u);
+        font._descent = _readS16BigEndian(bytes + hhea->offset + 6u);
+        font._lineGap = _readS16BigEndian(bytes + hhea->offset + 8u);
+        font._hMetricN = _readU16BigEndian(bytes + hhea->offset + 34u);
+        FAIL_IF(!font._unitsPerEm || !font._glyphN);
+        FAIL_IF(!font._hMetricN || font._hMetricN > font._glyphN || u64(font._hMetricN) * 4u > hmtx->size);
+        FAIL_IF(u64(font._glyphN + 1u) * (font._longLoca ? 4u : 2u) > loca->size);
+
+        font._glyfOffset = glyf->offset;
+        font._glyfSize = glyf->size;
+        font._locaOffset = loca->offset;
+        font._hmtxOffset = hmtx->offset;
+        font._hmtxSize = hmtx->size;
+
+        // Pick the best unicode character map
+        const u32 subtableN{_readU16BigEndian(bytes + cmap->offset + 2u)};
+        FAIL_IF(4u + u64(subtableN) * 8u > cmap->size);
+        u32 bestScore{0u};
+        for (u32 i{0u}; i < subtableN; ++i)
+        {
+            const u8 * const record{bytes + cmap->offset + 4u + i * 8u};
+            const u32 subtableOffset{_readU32BigEndian(record + 4u)};
+            if (u64(subtableOffset) + 2u > cmap->size)
+            {
+                continue;
+            }
+
+            const u32 format{_readU16BigEndian(bytes + cmap->offset + subtableOffset)};
+            const u32 score{_cmapSubtableScore(_readU16BigEndian(record), _readU16BigEndian(record + 2u), format)};
+            if (score > bestScore)
+            {
+                bestScore = score;
+                font._cmapOffset = cmap->offset + subtableOffset;
+                font._cmapFormat = format;
+            }
+        }
+        FAIL_IF(!bestScore);
+        font._cmapEnd = cmap->offset + cmap->size;
+
+        font._data = std::move(data);
+        return font;
+    }
+
+    Result<Font> read(const std::filesystem::path & file, const u32 fontIndex)
+    {
+        Result<List<u8>> fileData{utils::readFile(file)};
+
+        FAIL_IF(!fileData);
+
+        return decode(std::move(*fileData), fontIndex);
+    }
+
+    u32 Font::glyphIndex(const u32 codepoint) const
+    {
+        const u8 * const table{_data.data() + _cmapOffset};
+        const u64 tableSize{_cmapEnd - _cmapOffset};
+        u32 glyph{0u};
+
+        if (_cmapFormat == 4u)
+        {
+            // Segments of consecutive codepoints, sorted by end code
+            if (codepoint > 0xFFFFu || tableSize < 14u)
+            {
+                return 0u;
+            }
+
+            const u32 segmentN{_readU16BigEndian(table + 6u) / 2u};
+            if (16u + u64(segmentN) * 8u > tableSize)
+            {
+                return 0u;
+            }
+
+            const u8 * const endCodes{table + 14u};
+            const u8 * const startCodes{endCodes + segmentN * 2u + 2u};
+            const u8 * const idDeltas{startCodes + segmentN * 2u};
+            const u8 * const idRangeOffsets{idDeltas + segmentN * 2u};
+
+            u32 low{0u}, high{segmentN};
+            while (low < high)
+            {
+                const u32 mid{(low + high) / 2u};
+                if (_readU16BigEndian(endCodes + mid * 2u) < codepoint)
+                {
+                    low = mid + 1u;
+                }
+                else
+                {
+                    high = mid;
+                }
+            }
+
+            if (low == segmentN || _readU16BigEndian(startCodes + low * 2u) > codepoint)
+            {
+                return 0u;
+            }
+
+            const u32 idDelta{_readU16BigEndian(idDeltas + low * 2u)};
+            const u32 idRangeOffset{_readU16BigEndian(idRangeOffsets + low * 2u)};
+            if (!idRangeOffset)
+            {
+                glyph = (codepoint + idDelta) & 0xFFFFu;
+            }
+            else
+            {
+                // Offset is relative to the range offset itself
+                const u64 glyphOffset{u64(idRangeOffsets - table) + low * 2u + idRangeOffset + (codepoint - _readU16BigEndian(startCodes + low * 2u)) * 2u};
+                if (glyphOffset + 2u > tableSize)
+                {
+                    return 0u;
+                }
+
+                glyph = _readU16BigEndian(table + glyphOffset);
+                if (glyph)
+                {
+                    glyph = (glyph + idDelta) & 0xFFFFu;
+                }
+            }
+        }
+        else if (_cmapFormat == 12u)
+        {
+            // Groups of consecutive codepoints mapping to consecutive glyphs, sorted by start code
+            if (tableSize < 16u)
+            {
+                return 0u;
+            }
+
+            const u32 groupN{_readU32BigEndian(table + 12u)};
+            if (16u + u64(groupN) * 12u > tableSize)
+            {
+                return 0u;
+            }
+
+            u32 low{0u}, high{groupN};
+            while (low < high)
+            {
+                const u32 mid{(low + high) / 2u};
+                const u8 * const group{table + 16u + mid * 12u};
+                if (codepoint < _readU32BigEndian(group))
+                {
+                    high = mid;
+                }
+                else if (codepoint > _readU32BigEndian(group + 4u))
+                {
+                    low = mid + 1u;
+                }
+                else
+                {
+                    glyph = _readU32BigEndian(group + 8u) + (codepoint - _readU32BigEndian(group));
+                    break;
+                }
+            }
+        }
+        else if (_cmapFormat == 6u)
+        {
+            // One dense run of codepoints
+            if (tableSize < 10u)
+            {
+                return 0u;
+            }
+
+            const u32 firstCode{_readU16BigEndian(table + 6u)};
+            const u32 entryN{_readU16BigEndian(table + 8u)};
+            if (codepoint >= firstCode && codepoint - firstCode < entryN && 10u + u64(codepoint - firstCode) * 2u + 2u <= tableSize)
+            {
+                glyph = _readU16BigEndian(table + 10u + (codepoint - firstCode) * 2u);
+            }
+        }
+
+        return glyph < _glyphN ? glyph : 0u;
+    }
+
+    GlyphMetrics Font::metrics(const u32 glyph) const
+    {
+        if (glyph >= _glyphN)
+        {
+            return {};
+        }
+
+        // Glyphs past the last full metric share its advance, and only have their left bearing listed
+        const u8 * const hmtx{_data.data() + _hmtxOffset};
+        if (glyph < _hMetricN)
+        {
+            return GlyphMetrics{.advance = _readU16BigEndian(hmtx + glyph * 4u), .leftBearing = _readS16BigEndian(hmtx + glyph * 4u + 2u)};
+        }
+
+        GlyphMetrics metrics{.advance = _readU16BigEndian(hmtx + (_hMetricN - 1u) * 4u)};
+        const u64 bearingOffset{u64(_hMetricN) * 4u + u64(glyph - _hMetricN) * 2u};
+        if (bearingOffset + 2u <= _hmtxSize)
+        {
+            metrics.leftBearing = _readS16BigEndian(hmtx + bearingOffset);
+        }
+        return metrics;
+    }
+
+    Result<sdf::Outline> Font::outline(const u32 glyph) const
+    {
+        sdf::Outline outline{.fillRule = sdf::FillRule::nonZero};
+        u32 budget{_outlineBudget};
+        FAIL_IF(!_appendOutline(glyph, 0u, budget, outline));
+        return outline;
+    }
+
+    bool Font::_appendOutline(const u32 glyph, const u32 depth, u32 & budget, sdf::Outline & outline) const
+    {
+        FAIL_IF(glyph >= _glyphN || depth > _maxCompositeDepth);
+        FAIL_IF(!budget);
+        --budget;
+
+        const u8 * const loca{_data.data() + _locaOffset};
+        const u32 glyphBegin{_longLoca ? _readU32BigEndian(loca + glyph * 4u) : u32(_readU16BigEndian(loca + glyph * 2u)) * 2u};
+        const u32 glyphEnd{_longLoca ? _readU32BigEndian(loca + glyph * 4u + 4u) : u32(_readU16BigEndian(loca + glyph * 2u + 2u)) * 2u};
+        FAIL_IF(glyphBegin > glyphEnd || glyphEnd > _glyfSize);
+
+        // No data means nothing to draw
+        if (glyphBegin == glyphEnd)
+        {
+            return true;
+        }
+
+        FAIL_IF(glyphEnd - glyphBegin < 10u);
+
+        const u8 * const glyphData{_data.data() + _glyfOffset + glyphBegin};
+        const u8 * const end{_data.data() + _glyfOffset + glyphEnd};
+        const s32 contourN{_readS16BigEndian(glyphData)};
+
+        if (contourN >= 0)
+        {
+            const u8 * const contourEnds{glyphData + 10u};
+            FAIL_IF(end - contourEnds < contourN * 2 + 2);
+
+            if (!contourN)
+            {
+                return true;
+            }
+
+            const u32 pointN{_readU16BigEndian(contourEnds + (contourN - 1) * 2u) + 1u};
+            FAIL_IF(pointN > budget);
+            budget -= pointN;
+            const u32 instructionN{_readU16BigEndian(contourEnds + contourN * 2u)};
+            const u8 * src{contourEnds + contourN * 2u + 2u};
+            FAIL_IF(end - src < s64(instructionN));
+            src += instructionN;
+
+            static thread_local List<u8> flags{};
+            static thread_local List<fvec2> points{};
+            flags.resize(pointN);
+            points.resize(pointN);
+
+            for (u32 i{0u}; i < pointN;)
+            {
+                FAIL_IF(src >= end);
+                const u8 flag{*src++};
+                u32 repeatN{1u};
+                if (flag & _repeatFlag)
+                {
+                    FAIL_IF(src >= end);
+                    repeatN += *src++;
+                }
+                FAIL_IF(repeatN > pointN - i);
+                std::fill_n(flags.data() + i, repeatN, flag);
+                i += repeatN;
+            }
+
+            // X and y deltas are stored separately, each either a byte with the sign in the flag, a word, or nothing for the same value
+            const auto readCoordinates{[&](const u8 shortFlag, const u8 sameOrPositiveFlag, const u32 component) -> bool
+            {
+                s32 value{0};
+                for (u32 i{0u}; i < pointN; ++i)
+                {
+                    const u8 flag{flags[i]};
+                    if (flag & shortFlag)
+                    {
+                        FAIL_IF(src >= end);
+                        const s32 delta{*src++};
+                        value += (flag & sameOrPositiveFlag) ? delta : -delta;
+                    }
+                    else if (!(flag & sameOrPositiveFlag))
+                    {
+                        FAIL_IF(end - src < 2);
+                        value += _readS16BigEndian(src);
+                        src += 2;
+                    }
+                    points[i][component] = f32(value);
+                }
+                return true;
+            }};
+            FAIL_IF(!readCoordinates(_xShortFlag, _xSameOrPositiveFlag, 0u));
+            FAIL_IF(!readCoordinates(_yShortFlag, _ySameOrPositiveFlag, 1u));
+
+            u32 contourBegin{0u};
+            for (s32 i{0}; i < contourN; ++i)
+            {
+                const u32 contourEnd{_readU16BigEndian(contourEnds + i * 2u) + 1u};
+                FAIL_IF(contourEnd < contourBegin || contourEnd > pointN);
+                _addContour(points.data() + contourBegin, flags.data() + contourBegin, contourEnd - contourBegin, outline);
+                contourBegin = contourEnd;
+            }
+
+            return true;
+        }
+
+        // Composite glyph, made of other glyphs each with its own transform
+        const u8 * src{glyphData + 10u};
+        while (true)
+        {
+            FAIL_IF(end - src < 4);
+            const u16 flags{_readU16BigEndian(src)};
+            const u32 component{_readU16BigEndian(src + 2u)};
+            src += 4;
+
+            sdf::Transform transform{};
+            if (flags & _argsAreWordsFlag)
+            {
+                FAIL_IF(end - src < 4);
+                transform.translate = fvec2{f32(_readS16BigEndian(src)), f32(_readS16BigEndian(src + 2u))};
+                src += 4;
+            }
+            else
+            {
+                FAIL_IF(end - src < 2);
+                transform.translate = fvec2{f32(s8(src[0])), f32(s8(src[1]))};
+                src += 2;
+            }
+
+            // Otherwise the arguments are point numbers to line up, which is rare and not supported, so the component is left in place
+            if (!(flags & _argsAreOffsetsFlag))
+            {
+                transform.translate = {};
+            }
+
+            if (flags & _scaleFlag)
+            {
+                FAIL_IF(end - src < 2);
+                const f32 scale{_readF2Dot14(src)};
+                transform.xAxis = fvec2{scale, 0.0f};
+                transform.yAxis = fvec2{0.0f, scale};
+                src += 2;
+            }
+            else if (flags & _xyScaleFlag)
+            {
+                FAIL_IF(end - src < 4);
+                transform.xAxis = fvec2{_readF2Dot14(src), 0.0f};
+                transform.yAxis = fvec2{0.0f, _readF2Dot14(src + 2u)};
+                src += 4;
+            }
+            else if (flags & _twoByTwoFlag)
+            {
+                FAIL_IF(end - src < 8);
+                transform.xAxis = fvec2{_readF2Dot14(src), _readF2Dot14(src + 2u)};
+                transform.yAxis = fvec2{_readF2Dot14(src + 4u), _readF2Dot14(src + 6u)};
+                src += 8;
+            }
+
+            const u32 firstContour{outline.contours.size()};
+            FAIL_IF(!_appendOutline(component, depth + 1u, budget, outline));
+
+            if (!transform.isIdentity())
+            {
+                // A mirroring transform turns the contours around, so they are reversed to keep winding the same way as the rest of the glyph
+                const bool isMirrored{cross(transform.xAxis, transform.yAxis) < 0.0f};
+
+                for (u32 i{firstContour}; i < outline.contours.size(); ++i)
+                {
+                    List<sdf::Segment> & segments{outline.contours[i].segments};
+                    for (sdf::Segment & segment : segments)
+                    {
+                        segment.line.p1 = transform.apply(segment.line.p1);
+                        segment.line.p2 = transform.apply(segment.line.p2);
+                        if (segment.type == sdf::SegmentType::curve)
+                        {
+                            segment.curve.p3 = transform.apply(segment.curve.p3);
+                        }
+
+                        if (isMirrored)
+                        {
+                            if (segment.type == sdf::SegmentType::curve)
+                            {
+                                std::swap(segment.curve.p1, segment.curve.p3);
+                            }
+                            else
+                            {
+                                std::swap(segment.line.p1, segment.line.p2);
+                            }
+                        }
+                    }
+
+                    if (isMirrored)
+                    {
+                        std::reverse(segments.begin(), segments.end());
+                    }
+
+                    // A collapsing transform can leave degenerate segments
+                    outline.contours[i].normalize();
+                }
+
+                const u32 contourN{outline.contours.size()};
+                u32 keptN{firstContour};
+                for (u32 i{firstContour}; i < contourN; ++i)
+                {
+                    if (outline.contours[i].segments.size() >= 2u)
+                    {
+                        if (keptN != i)
+                        {
+                            outline.contours[keptN] = std::move(outline.contours[i]);
+                        }
+                        ++keptN;
+                    }
+                }
+                outline.contours.resize(keptN);
+            }
+
+            if (!(flags & _moreComponentsFlag))
+            {
+                return true;
+            }
+        }
+    }
+
+    struct GlyphCache::_State
+    {
+        const Font * font{};
+        f32 emSize{};
+        f32 range{};
+        u64 byteBudget{};
+
+        mutable std::mutex mutex{};
+        std::unordered_map<u32, _CacheEntry> entries{};
+        // Glyph indices, most recently used first
+        std::list<u32> recency{};
+        u64 byteN{};
+        u32 readyN{};
+
+        // Must be called with the mutex held
+        void evict(const u32 keepGlyph)
+        {
+            auto it{recency.end()};
+            while (byteN > byteBudget && it != recency.begin())
+            {
+                --it;
+                const u32 glyph{*it};
+                const auto entryIt{entries.find(glyph)};
+
+                // Glyphs still being generated are not counted yet, and have waiters
+                if (glyph == keepGlyph || !entryIt->second.ready)
+                {
+                    continue;
+                }
+
+                byteN -= entryIt->second.byteN;
+                --readyN;
+                entries.erase(entryIt);
+                it = recency.erase(it);
+            }
+        }
+    };
+
+    GlyphCache::GlyphCache(const Font & font, const f32 emSize, const f32 range, const u64 byteBudget) :
+        _state{std::make_unique<_State>()}
+    {
+        _state->font = &font;
+        _state->emSize = emSize;
+        _state->range = range;
+        _state->byteBudget = byteBudget;
+    }
+
+    GlyphCache::GlyphCache(GlyphCache && other) = default;
+
+    GlyphCache & GlyphCache::operator=(GlyphCache && other) = default;
+
+    GlyphCache::~GlyphCache() = default;
+
+    std::shared_ptr<const GlyphSdf> GlyphCache::get(const u32 glyph)
+    {
+        _State & state{*_state};
+        std::promise<std::shared_ptr<const GlyphSdf>> promise{};
+
+        {
+            std::unique_lock lock{state.mutex};
+
+            const auto it{state.entries.find(glyph)};
+            if (it != state.entries.end())
+            {
+                state.recency.splice(state.recency.begin(), state.recency, it->second.recency);
+                const std::shared_future<std::shared_ptr<const GlyphSdf>> sdf{it->second.sdf};
+                lock.unlock();
+                return sdf.get();
+            }
+
+            state.recency.push_front(glyph);
+            state.entries.emplace(glyph, _CacheEntry{.sdf = promise.get_future().share(), .recency = state.recency.begin()});
+        }
+
+        // Generate without the lock, so other glyphs can be looked up and generated meanwhile
+        std::shared_ptr<const GlyphSdf> sdf{_generateGlyph(*state.font, glyph, state.emSize, state.range)};
+        promise.set_value(sdf);
+
+        {
+            const std::scoped_lock lock{state.mutex};
+
+            _CacheEntry & entry{state.entries.find(glyph)->second};
+            entry.byteN = sizeof(GlyphSdf) + (sdf ? u64(sdf->image.width()) * sdf->image.height() : 0u);
+            entry.ready = true;
+            state.byteN += entry.byteN;
+            ++state.readyN;
+
+            state.evict(glyph);
+        }
+
+        return sdf;
+    }
+
+    std::shared_ptr<const GlyphSdf> GlyphCache::getCodepoint(const u32 codepoint)
+    {
+        return get(_state->font->glyphIndex(codepoint));
+    }
+
+    u64 GlyphCache::byteN() const
+    {
+        const std::scoped_lock lock{_state->mutex};
+        return _state->byteN;
+    }
+
+    u32 GlyphCache::glyphN() const
+    {
+        const std::scoped_lock lock{_state->mutex};
+        return _state->readyN;
+    }
+
+    void GlyphCache::clear()
+    {
+        const std::scoped_lock lock{_state->mutex};
+
+        const u64 byteBudget{_state->byteBudget};
+        _state->byteBudget = 0u;
+        _state->evict(std::numeric_limits<u32>::max());
+        _state->byteBudget = byteBudget;
+    }
+}
@@ -1,14 +1,29 @@
 #include <qc-image/image.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define _QCI_IMAGE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#include <fstream>
+
 #include <qc-core/utils.hpp>
 
+#include <qc-image/mapped.hpp>
+#include <qc-image/parallel.hpp>
+#include <qc-image/png.hpp>
+
 namespace qci
 {
     static void * _realloc(void * const oldPtr, const size_t oldSize, const size_t newSize)
     {
         void * const newPtr{::operator new(newSize)};
-        memcpy(newPtr, oldPtr, oldSize);
-        operator delete(oldPtr);
+        // stb grows buffers from null
+        if (oldPtr)
+        {
+            memcpy(newPtr, oldPtr, oldSize);
+            operator delete(oldPtr);
+        }
         return newPtr;
     }
 }
@@ -39,12 +54,645 @@ GCC_DIAGNOSTIC_POP
 
 namespace qci
 {
+    namespace
+    {
+        void _appendU32BigEndian(List<u8> & dst, const u32 v)
+        {
+            dst.push_back(u8(v >> 24));
+            dst.push_back(u8(v >> 16));
+            dst.push_back(u8(v >> 8));
+            dst.push_back(u8(v));
+        }
+
+        void _appendPngChunk(List<u8> & dst, const char (&type)[5], const u8 * const data, const u32 size)
+        {
+            _appendU32BigEndian(dst, size);
+            const u32 typeOffset{dst.size()};
+            dst.resize(typeOffset + 4u + size);
+            std::copy_n(type, 4u, dst.data() + typeOffset);
+            std::copy_n(data, size, dst.data() + typeOffset + 4u);
+            _appendU32BigEndian(dst, stbiw__crc32(dst.data() + typeOffset, s32(4u + size)));
+        }
+
+        // stb_image_write only writes 8-bit PNGs, so 16-bit ones are assembled here around its zlib compressor
+        // Every row uses the sub filter, which suits the smooth content 16-bit images are typically used for
+        template <u32 n>
+        List<u8> _encodePng16(const Image<u16, n> & image)
+        {
+            constexpr u8 colorTypes[4]{0u, 4u, 2u, 6u};
+            constexpr u32 pixelSize{2u * n};
+
+            FAIL_IF(!image.width() || !image.height());
+
+            const u32 rowSize{1u + image.width() * pixelSize};
+
+            List<u8> filtered{};
+            filtered.resize(image.height() * rowSize);
+
+            // Memory row 0 is the top row, as PNG expects
+            const u16 * src{std::bit_cast<const u16 *>(image.pixels())};
+            for (u32 y{0u}; y < image.height(); ++y)
+            {
+                u8 * const dst{filtered.data() + y * rowSize};
+                dst[0] = 1u; // Sub filter
+                u8 * const bytes{dst + 1};
+
+                for (u32 i{0u}; i < image.width() * n; ++i, ++src)
+                {
+                    bytes[2u * i] = u8(*src >> 8);
+                    bytes[2u * i + 1u] = u8(*src);
+                }
+
+                for (u32 i{rowSize - 2u}; i >= pixelSize; --i)
+                {
+                    bytes[i] = u8(bytes[i] - bytes[i - pixelSize]);
+                }
+            }
+
+            s32 compressedSize{};
+            u8 * const compressed{stbi_zlib_compress(filtered.data(), s32(filtered.size()), &compressedSize, stbi_write_png_compression_level)};
+            const qc::ScopeGuard compressedGuard{[&]() { STBIW_FREE(compressed); }};
+
+            FAIL_IF(!compressed || compressedSize <= 0);
+
+            List<u8> png{};
+            png.reserve(8u + 25u + 12u + u32(compressedSize) + 12u);
+
+            constexpr u8 signature[8]{0x89u, 'P', 'N', 'G', '\r', '\n', 0x1Au, '\n'};
+            png.resize(8u);
+            std::copy_n(signature, 8u, png.data());
+
+            u8 header[13]{};
+            for (u32 i{0u}; i < 4u; ++i)
+            {
+                header[i] = u8(image.width() >> (24u - 8u * i));
+                header[4u + i] = u8(image.height() >> (24u - 8u * i));
+            }
+            header[8] = 16u; // Bit depth
+            header[9] = colorTypes[n - 1u];
+
+            _appendPngChunk(png, "IHDR", header, 13u);
+            _appendPngChunk(png, "IDAT", compressed, u32(compressedSize));
+            _appendPngChunk(png, "IEND", nullptr, 0u);
+
+            return png;
+        }
+
+        // Header of a `.qci` file holding the image, or nothing if a row is too long for the pitch
+        template <Numeric T, u32 n>
+        Result<RawHeader> _rawHeader(const Image<T, n> & image)
+        {
+            const u64 pitch{u64(image.width()) * sizeof(Pixel<T, n>)};
+            FAIL_IF(pitch > std::numeric_limits<u32>::max());
+
+            RawHeader header{};
+            header.width = image.width();
+            header.height = image.height();
+            header.componentN = n;
+            header.componentType = rawComponentType<T>;
+            header.pitch = u32(pitch);
+            return header;
+        }
+
+        // Max components processed per column strip by the vertical blur pass
+        constexpr u32 _blurStripCompN{256u};
+
+        // Max bytes a strip of columns is gathered into, so taller images get narrower strips rather than more memory
+        constexpr u64 _blurStripByteBudget{u64(1u) << 20};
+
+        // Max bytes of row scratch each thread keeps between blurs. Wider images free theirs when done
+        constexpr u64 _blurRowRetainedByteN{u64(1u) << 20};
+
+        // Accumulator for blur running sums. Must represent sums of the component type exactly enough to not drift
+        template <Numeric T> using _BlurAcc = std::conditional_t<sizeof(T) == 1u, f32, f64>;
+
+        template <Numeric T>
+        finline T _blurResult(const _BlurAcc<T> v)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                return T(v);
+            }
+            else
+            {
+                return T(v + _BlurAcc<T>(0.5));
+            }
+        }
+
+        // Box blurs a single line of `length` pixels of `n` interleaved components from `src` into `dst`
+        template <Numeric T, u32 n>
+        void _boxBlurLine(const T * const src, T * const dst, const u32 length, const u32 radius)
+        {
+            using Acc = _BlurAcc<T>;
+
+            const u32 last{length - 1u};
+            const Acc invDiameter{Acc(1) / Acc(2u * radius + 1u)};
+
+            Acc sums[n];
+            for (u32 c{0u}; c < n; ++c)
+            {
+                sums[c] = Acc(src[c]) * Acc(radius + 1u);
+            }
+            for (u32 i{1u}; i <= radius; ++i)
+            {
+                const T * const p{src + min(i, last) * n};
+                for (u32 c{0u}; c < n; ++c)
+                {
+                    sums[c] += Acc(p[c]);
+                }
+            }
+
+            for (u32 x{0u}; x < length; ++x)
+            {
+                const T * const add{src + min(x + radius + 1u, last) * n};
+                const T * const sub{src + (x > radius ? x - radius : 0u) * n};
+                T * const d{dst + x * n};
+                for (u32 c{0u}; c < n; ++c)
+                {
+                    d[c] = _blurResult<T>(sums[c] * invDiameter);
+                    sums[c] += Acc(add[c]) - Acc(sub[c]);
+                }
+            }
+        }
+
+        // Box blurs `compN` adjacent columns of `height` rows vertically. Consecutive rows are `srcPitch` and `dstPitch` components apart
+        // Each step only touches two contiguous source rows and one destination row, and the inner loop vectorizes across the columns
+        template <Numeric T>
+        void _boxBlurColumns(const T * const src, const u32 srcPitch, T * const dst, const s64 dstPitch, const u32 compN, const u32 height, const u32 radius)
+        {
+            using Acc = _BlurAcc<T>;
+
+            ASSERT(compN <= _blurStripCompN);
+
+            const u32 last{height - 1u};
+            const Acc invDiameter{Acc(1) / Acc(2u * radius + 1u)};
+
+            Acc sums[_blurStripCompN];
+            for (u32 c{0u}; c < compN; ++c)
+            {
+                sums[c] = Acc(src[c]) * Acc(radius + 1u);
+            }
+            for (u32 i{1u}; i <= radius; ++i)
+            {
+                const T * const r{src + min(i, last) * srcPitch};
+                for (u32 c{0u}; c < compN; ++c)
+                {
+                    sums[c] += Acc(r[c]);
+                }
+            }
+
+            for (u32 y{0u}; y < height; ++y)
+            {
+                const T * const add{src + min(y + radius + 1u, last) * srcPitch};
+                const T * const sub{src + (y > radius ? y - radius : 0u) * srcPitch};
+                T * const d{dst + s64(y) * dstPitch};
+                for (u32 c{0u}; c < compN; ++c)
+                {
+                    d[c] = _blurResult<T>(sums[c] * invDiameter);
+                    sums[c] += Acc(add[c]) - Acc(sub[c]);
+                }
+            }
+        }
+
+        // Applies successive box blurs of the given radii, first horizontally then vertically
+        template <Numeric T, u32 n>
+        void _boxBlur(const ImageView<T, n, false> & view, const u32 * const radii, const u32 passN, Executor & executor)
+        {
+            const u32 width{view.width()};
+            const u32 height{view.height()};
+
+            if (!width || !height || !passN)
+            {
+                return;
+            }
+
+            // Horizontal passes, row by row through a two line scratch buffer
+
+            executor.parallelFor(height, 16u, [&](const u32 beginY, const u32 endY)
+            {
+                static thread_local List<T> scratch{};
+                scratch.resize(2u * width * n);
+
+                for (u32 y{beginY}; y < endY; ++y)
+                {
+                    T * const row{std::bit_cast<T *>(view.row(s32(y)))};
+                    T * src{scratch.data()};
+                    T * dst{src + width * n};
+
+                    std::copy_n(row, width * n, src);
+
+                    for (u32 i{0u}; i < passN; ++i)
+                    {
+                        if (i + 1u == passN)
+                        {
+                            dst = row;
+                        }
+
+                        _boxBlurLine<T, n>(src, dst, width, radii[i]);
+                        std::swap(src, dst);
+                    }
+                }
+
+                if (u64(scratch.size()) * sizeof(T) > _blurRowRetainedByteN)
+                {
+                    scratch = {};
+                }
+            });
+
+            // Vertical passes, strip by strip of columns gathered into contiguous scratch rows
+            // The scratch is only held for a block of strips, and blocks are sized to give each thread a few
+
+            const u64 budgetCompN{_blurStripByteBudget / (2u * u64(height) * sizeof(T))};
+            const u32 stripWidth{max(u32(min(budgetCompN, u64(_blurStripCompN))) / n, 1u)};
+            const u32 stripN{(width + stripWidth - 1u) / stripWidth};
+            const u32 stripGrain{max(stripN / (4u * max(executor.concurrency(), 1u)), 1u)};
+            const s64 dstPitch{-s64(view.image()->width()) * s64(n)};
+
+            executor.parallelFor(stripN, stripGrain, [&](const u32 beginStrip, const u32 endStrip)
+            {
+                List<T> scratch{};
+                scratch.resize(2u * height * stripWidth * n);
+
+                for (u32 strip{beginStrip}; strip < endStrip; ++strip)
+                {
+                    const u32 x{strip * stripWidth};
+                    const u32 compN{min(stripWidth, width - x) * n};
+                    T * src{scratch.data()};
+                    T * dst{src + height * compN};
+
+                    for (u32 y{0u}; y < height; ++y)
+                    {
+                        std::copy_n(std::bit_cast<const T *>(view.row(s32(y)) + x), compN, src + y * compN);
+                    }
+
+                    for (u32 i{0u}; i < passN; ++i)
+                    {
+                        if (i + 1u == passN)
+                        {
+                            _boxBlurColumns<T>(src, compN, std::bit_cast<T *>(view.row(0) + x), dstPitch, compN, height, radii[i]);
+                        }
+                        else
+                        {
+                            _boxBlurColumns<T>(src, compN, dst, s64(compN), compN, height, radii[i]);
+                            std::swap(src, dst);
+                        }
+                    }
+                }
+            });
+        }
+
+        // Side length of the square blocks that axis swapping orientations are done in, so a block of source rows and of destination rows both stay in cache
+        constexpr u32 _orientBlockSize{32u};
+
+        // Each orientation is an optional swap of axes, followed by optional flips of the destination axes
+        struct _OrientSteps
+        {
+            bool swap;
+            bool flipX;
+            bool flipY;
+        };
+
+        constexpr _OrientSteps _orientSteps(const Orientation orientation)
+        {
+            switch (orientation)
+            {
+                case Orientation::flipX: return {false, true, false};
+                case Orientation::flipY: return {false, false, true};
+                case Orientation::rotate90: return {true, true, false};
+                case Orientation::rotate180: return {false, true, true};
+                case Orientation::rotate270: return {true, false, true};
+                case Orientation::transpose: return {true, false, false};
+                case Orientation::transverse: return {true, true, true};
+            }
+            return {};
+        }
+
+        // Source pixel (x, y) goes to `origin[x * strideX + y * strideY]`
+        template <typename Pixel>
+        struct _OrientTarget
+        {
+            Pixel * origin;
+            s64 strideX;
+            s64 strideY;
+        };
+
+        // Rows are stored bottom-up, so pixel (x, y) of a view is at `row(0)[x - y * pitch]`
+        template <typename Pixel>
+        _OrientTarget<Pixel> _orientTarget(Pixel * const dstRow0, const s64 dstPitch, const uivec2 dstSize, const _OrientSteps steps)
+        {
+            Pixel * const origin{dstRow0 + (steps.flipX ? s64(dstSize.x) - 1 : 0) - (steps.flipY ? s64(dstSize.y) - 1 : 0) * dstPitch};
+            const s64 stepX{steps.flipX ? -1 : 1};
+            const s64 stepY{steps.flipY ? dstPitch : -dstPitch};
+            return steps.swap ? _OrientTarget<Pixel>{origin, stepY, stepX} : _OrientTarget<Pixel>{origin, stepX, stepY};
+        }
+
+        // Writes `src` to `dst` in reverse order
+        template <typename Pixel>
+        void _reverseCopy(const Pixel * const src, Pixel * const dst, const u32 length)
+        {
+            u32 i{0u};
+
+            #ifdef _QCI_IMAGE_SSE2
+            {
+                if constexpr (sizeof(Pixel) == 4u)
+                {
+                    for (; i + 4u <= length; i += 4u)
+                    {
+                        const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))};
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (length - 4u - i)), _mm_shuffle_epi32(v, 0x1B));
+                    }
+                }
+                else if constexpr (sizeof(Pixel) == 1u)
+                {
+                    for (; i + 16u <= length; i += 16u)
+                    {
+                        __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))};
+                        // Swap the bytes of each 16-bit lane, then reverse the lanes
+                        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (length - 16u - i)), _mm_shuffle_epi32(v, 0x4E));
+                    }
+                }
+            }
+            #endif
+
+            for (; i < length; ++i)
+            {
+                dst[length - 1u - i] = src[i];
+            }
+        }
+
+        #ifdef _QCI_IMAGE_SSE2
+
+        // Transposes a `k` by `k` tile of one or four byte pixels with unpacks
+        // Source rows are loaded in the order their pixels land in memory, so a flipped destination costs nothing extra
+        template <typename Pixel>
+        finline void _transposeTileSimd(const Pixel * const src, const s64 srcPitch, Pixel * const dst, const s64 strideX, const s64 strideY)
+        {
+            const bool reversed{strideY < 0};
+
+            if constexpr (sizeof(Pixel) == 4u)
+            {
+                __m128i r[4];
+                for (s64 i{0}; i < 4; ++i)
+                {
+                    r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src - (reversed ? 3 - i : i) * srcPitch));
+                }
+
+                const __m128i t0{_mm_unpacklo_epi32(r[0], r[1])};
+                const __m128i t1{_mm_unpacklo_epi32(r[2], r[3])};
+                const __m128i t2{_mm_unpackhi_epi32(r[0], r[1])};
+                const __m128i t3{_mm_unpackhi_epi32(r[2], r[3])};
+                const __m128i columns[4]{_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1), _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)};
+
+                Pixel * const base{dst + (reversed ? 3 * strideY : 0)};
+                for (s64 i{0}; i < 4; ++i)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(base + i * strideX), columns[i]);
+                }
+            }
+            else
+            {
+                __m128i r[8];
+                for (s64 i{0}; i < 8; ++i)
+                {
+                    r[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src - (reversed ? 7 - i : i) * srcPitch));
+                }
+
+                const __m128i a0{_mm_unpacklo_epi8(r[0], r[1])};
+                const __m128i a1{_mm_unpacklo_epi8(r[2], r[3])};
+                const __m128i a2{_mm_unpacklo_epi8(r[4], r[5])};
+                const __m128i a3{_mm_unpacklo_epi8(r[6], r[7])};
+                const __m128i b0{_mm_unpacklo_epi16(a0, a1)};
+                const __m128i b1{_mm_unpackhi_epi16(a0, a1)};
+                const __m128i b2{_mm_unpacklo_epi16(a2, a3)};
+                const __m128i b3{_mm_unpackhi_epi16(a2, a3)};
+                // Each holds two columns of eight
+                const __m128i columnPairs[4]{_mm_unpacklo_epi32(b0, b2), _mm_unpackhi_epi32(b0, b2), _mm_unpacklo_epi32(b1, b3), _mm_unpackhi_epi32(b1, b3)};
+
+                Pixel * const base{dst + (reversed ? 7 * strideY : 0)};
+                for (s64 i{0}; i < 4; ++i)
+                {
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(base + (2 * i) * strideX), columnPairs[i]);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(base + (2 * i + 1) * strideX), _mm_unpackhi_epi64(columnPairs[i], columnPairs[i]));
+                }
+            }
+        }
+
+        #endif
+
+        // Writes the `width` by `height` block of source pixels at `src` to where `dst`, `strideX`, and `strideY` say, for axis swapping orientations
+        // `strideY` is then always one pixel, forwards or back
+        template <typename Pixel>
+        void _transposeBlock(const Pixel * const src, const s64 srcPitch, Pixel * const dst, const s64 strideX, const s64 strideY, const u32 width, const u32 height)
+        {
+            u32 y{0u};
+
+            #ifdef _QCI_IMAGE_SSE2
+            {
+                if constexpr (sizeof(Pixel) == 4u || sizeof(Pixel) == 1u)
+                {
+                    constexpr u32 tileSize{sizeof(Pixel) == 4u ? 4u : 8u};
+
+                    for (; y + tileSize <= height; y += tileSize)
+                    {
+                        u32 x{0u};
+                        for (; x + tileSize <= width; x += tileSize)
+                        {
+                            _transposeTileSimd(src + x - s64(y) * srcPitch, srcPitch, dst + s64(x) * strideX + s64(y) * strideY, strideX, strideY);
+                        }
+
+                        for (u32 ty{y}; ty < y + tileSize; ++ty)
+                        {
+                            for (u32 tx{x}; tx < width; ++tx)
+                            {
+                                dst[s64(tx) * strideX + s64(ty) * strideY] = src[tx - s64(ty) * srcPitch];
+                            }
+                        }
+                    }
+                }
+            }
+            #endif
+
+            for (; y < height; ++y)
+            {
+                const Pixel * const srcRow{src - s64(y) * srcPitch};
+                Pixel * const dstColumn{dst + s64(y) * strideY};
+                for (u32 x{0u}; x < width; ++x)
+                {
+                    dstColumn[s64(x) * strideX] = srcRow[x];
+                }
+            }
+        }
+
+        // Runs `func` over `[0, count)`, across the executor's threads if there is one
+        void _forRange(const u32 count, const u32 grain, Executor * const executor, const std::function<void(u32, u32)> & func)
+        {
+            if (executor)
+            {
+                executor->parallelFor(count, grain, func);
+            }
+            else if (count)
+            {
+                func(0u, count);
+            }
+        }
+
+        template <typename Pixel>
+        void _copyOriented(const Pixel * const srcRow0, const s64 srcPitch, const uivec2 srcSize, const _OrientTarget<Pixel> & target, const bool swap, Executor * const executor)
+        {
+            if (!swap)
+            {
+                // Whole rows go to whole rows, reversed if flipped horizontally
+                _forRange(srcSize.y, 64u, executor, [&](const u32 beginY, const u32 endY)
+                {
+                    for (u32 y{beginY}; y < endY; ++y)
+                    {
+                        const Pixel * const srcRow{srcRow0 - s64(y) * srcPitch};
+                        Pixel * const dst{target.origin + s64(y) * target.strideY};
+                        if (target.strideX > 0)
+                        {
+                            std::copy_n(srcRow, srcSize.x, dst);
+                        }
+                        else
+                        {
+                            _reverseCopy(srcRow, dst - (s64(srcSize.x) - 1), srcSize.x);
+                        }
+                    }
+                });
+
+                return;
+            }
+
+            const u32 blockRowN{(srcSize.y + _orientBlockSize - 1u) / _orientBlockSize};
+
+            _forRange(blockRowN, 1u, executor, [&](const u32 beginBlockRow, const u32 endBlockRow)
+            {
+                for (u32 blockRow{beginBlockRow}; blockRow < endBlockRow; ++blockRow)
+                {
+                    const u32 y{blockRow * _orientBlockSize};
+                    const u32 height{min(_orientBlockSize, srcSize.y - y)};
+
+                    for (u32 x{0u}; x < srcSize.x; x += _orientBlockSize)
+                    {
+                        const u32 width{min(_orientBlockSize, srcSize.x - x)};
+                        _transposeBlock(srcRow0 + x - s64(y) * srcPitch, srcPitch, target.origin + s64(x) * target.strideX + s64(y) * target.strideY, target.strideX, target.strideY, width, height);
+                    }
+                }
+            });
+        }
+
+        // Mirrors rows in place: each row is swapped with its opposite if flipping vertically, and reversed if flipping horizontally
+        template <typename Pixel>
+        void _flipInPlace(Pixel * const row0, const s64 pitch, const uivec2 size, const bool flipX, const bool flipY, Executor * const executor)
+        {
+            if (!flipX && !flipY)
+            {
+                return;
+            }
+
+            const u32 pairN{flipY ? (size.y + 1u) / 2u : size.y};
+
+            _forRange(pairN, 64u, executor, [&](const u32 begin, const u32 end)
+            {
+                static thread_local List<Pixel> scratch{};
+                scratch.resize(size.x);
+
+                for (u32 y{begin}; y < end; ++y)
+                {
+                    Pixel * const a{row0 - s64(y) * pitch};
+                    Pixel * const b{flipY ? row0 - s64(size.y - 1u - y) * pitch : a};
+
+                    if (!flipX)
+                    {
+                        std::swap_ranges(a, a + size.x, b);
+                    }
+                    else
+                    {
+                        std::copy_n(a, size.x, scratch.data());
+                        if (b != a)
+                        {
+                            _reverseCopy(b, a, size.x);
+                        }
+                        _reverseCopy(scratch.data(), b, size.x);
+                    }
+                }
+            });
+        }
+
+        // Transposes a square region in place, swapping each block above the diagonal with its mirror through a scratch block
+        template <typename Pixel>
+        void _transposeInPlace(Pixel * const row0, const s64 pitch, const u32 size, Executor * const executor)
+        {
+            const u32 blockN{(size + _orientBlockSize - 1u) / _orientBlockSize};
+
+            // Pixel (x, y) goes to (y, x)
+            const auto at{[row0, pitch](const u32 x, const u32 y) { return row0 + x - s64(y) * pitch; }};
+
+            _forRange(blockN, 1u, executor, [&](const u32 beginBlock, const u32 endBlock)
+            {
+                static thread_local List<Pixel> scratch{};
+                scratch.resize(_orientBlockSize * _orientBlockSize);
+                // Scratch rows go upwards in memory, the opposite of image rows
+                constexpr s64 scratchPitch{-s64(_orientBlockSize)};
+
+                for (u32 blockY{beginBlock}; blockY < endBlock; ++blockY)
+                {
+                    const u32 y{blockY * _orientBlockSize};
+                    const u32 height{min(_orientBlockSize, size - y)};
+
+                    for (u32 blockX{blockY}; blockX < blockN; ++blockX)
+                    {
+                        const u32 x{blockX * _orientBlockSize};
+                        const u32 width{min(_orientBlockSize, size - x)};
+
+                        for (u32 i{0u}; i < height; ++i)
+                        {
+                            std::copy_n(at(x, y + i), width, scratch.data() + i * _orientBlockSize);
+                        }
+
+                        if (blockX != blockY)
+                        {
+                            // The mirror block moves into this one's place
+                            _transposeBlock(at(y, x), pitch, at(x, y), -pitch, 1, height, width);
+                        }
+
+                        _transposeBlock(scratch.data(), scratchPitch, at(y, x), -pitch, 1, width, height);
+                    }
+                }
+            });
+        }
+    }
+
     template <Numeric T, u32 n>
     void Image<T, n>::fill(const Pixel & color)
     {
         std::fill_n(_pixels, _size.x * _size.y, color);
     }
 
+    template <Numeric T, u32 n>
+    void Image<T, n>::reorient(const Orientation orientation, const bool parallel, Executor & executor)
+    {
+        if (swapsAxes(orientation) && _size.x != _size.y)
+        {
+            Image reorientedImage{reoriented(orientation, parallel, executor)};
+            std::swap(_size, reorientedImage._size);
+            std::swap(_pixels, reorientedImage._pixels);
+        }
+        else
+        {
+            view().reorient(orientation, parallel, executor);
+        }
+    }
+
+    template <Numeric T, u32 n>
+    auto Image<T, n>::reoriented(const Orientation orientation, const bool parallel, Executor & executor) const -> Image
+    {
+        Image image{swapsAxes(orientation) ? uivec2{_size.y, _size.x} : _size};
+        image.view().copyReoriented(view(), orientation, parallel, executor);
+        return image;
+    }
+
     template <Numeric T, u32 n>
     auto Image<T, n>::release() -> Pixel *
     {
@@ -139,15 +787,138 @@ namespace qci
         copy(src.view());
     }
 
+    template <Numeric T, u32 n, bool constant>
+    void ImageView<T, n, constant>::copyReoriented(const ImageView<T, n, true> & src, const Orientation orientation, const bool parallel, Executor & executor) const requires (!constant)
+    {
+        const _OrientSteps steps{_orientSteps(orientation)};
+
+        ASSERT((steps.swap ? uivec2{src._size.y, src._size.x} : src._size) == _size);
+
+        if (!_size.x || !_size.y)
+        {
+            return;
+        }
+
+        const _OrientTarget<Pixel> target{_orientTarget(row(0), s64(_image->_size.x), _size, steps)};
+        _copyOriented(src.row(0), s64(src._image->_size.x), src._size, target, steps.swap, parallel ? &executor : nullptr);
+    }
+
+    template <Numeric T, u32 n, bool constant>
+    void ImageView<T, n, constant>::reorient(const Orientation orientation, const bool parallel, Executor & executor) const requires (!constant)
+    {
+        const _OrientSteps steps{_orientSteps(orientation)};
+
+        ASSERT(!steps.swap || _size.x == _size.y);
+
+        if (!_size.x || !_size.y)
+        {
+            return;
+        }
+
+        const s64 pitch{s64(_image->_size.x)};
+
+        if (steps.swap)
+        {
+            _transposeInPlace(row(0), pitch, _size.x, parallel ? &executor : nullptr);
+        }
+
+        _flipInPlace(row(0), pitch, _size, steps.flipX, steps.flipY, parallel ? &executor : nullptr);
+    }
+
+    template <Numeric T, u32 n, bool constant>
+    void ImageView<T, n, constant>::boxBlur(const u32 radius, Executor & executor) const requires (!constant)
+    {
+        if (radius)
+        {
+            _boxBlur(*this, &radius, 1u, executor);
+        }
+    }
+
+    template <Numeric T, u32 n, bool constant>
+    void ImageView<T, n, constant>::gaussianBlur(const f32 sigma, Executor & executor) const requires (!constant)
+    {
+        // Box widths whose successive application best approximates the gaussian variance
+        // See "Fast Almost-Gaussian Filtering", Kovesi 2010
+
+        constexpr u32 passN{3u};
+
+        if (!(sigma > 0.0f))
+        {
+            return;
+        }
+
+        const f32 variance12{12.0f * sigma * sigma};
+        u32 lowWidth{u32(std::sqrt(variance12 / f32(passN) + 1.0f))};
+        if (!(lowWidth % 2u)) --lowWidth;
+        const u32 highWidth{lowWidth + 2u};
+        const f32 lowWidthF{f32(lowWidth)};
+        const f32 lowPassN{std::round((variance12 - f32(passN) * lowWidthF * lowWidthF - 4.0f * f32(passN) * lowWidthF - 3.0f * f32(passN)) / (-4.0f * lowWidthF - 4.0f))};
+
+        u32 radii[passN];
+        for (u32 i{0u}; i < passN; ++i)
+        {
+            radii[i] = (f32(i) < lowPassN ? lowWidth : highWidth) / 2u;
+        }
+
+        _boxBlur(*this, radii, passN, executor);
+    }
+
     template <Numeric T, u32 n>
-    Result<Image<T, n>> read(const std::filesystem::path & file, const bool allowComponentPadding)
+    Result<Image<T, n>> decode(const u8 * const fileData, const u64 fileSize, const bool allowComponentPadding)
     {
-        const Result<List<u8>> fileData{utils::readFile(file)};
+        static_assert(std::is_same_v<T, u8> || std::is_same_v<T, u16> || std::is_same_v<T, f32>);
 
-        FAIL_IF(!fileData);
+        FAIL_IF(fileSize > u64(std::numeric_limits<s32>::max()));
+
+        // Raw container, copied out as is
+        if (fileSize >= sizeof(RawHeader) && !std::memcmp(fileData, RawHeader::magic, sizeof(RawHeader::magic)))
+        {
+            RawHeader header;
+            std::memcpy(&header, fileData, sizeof(RawHeader));
+
+            FAIL_IF(header.version != RawHeader::currentVersion);
+            FAIL_IF(header.componentN != n || header.componentType != rawComponentType<T>);
+            FAIL_IF(!header.width || !header.height);
+            FAIL_IF(header.pitch < header.width * sizeof(Pixel<T, n>));
+            FAIL_IF(fileSize < u64(header.dataOffset) + u64(header.pitch) * header.height);
+
+            Image<T, n> image{header.width, header.height};
+            for (u32 y{0u}; y < header.height; ++y)
+            {
+                std::memcpy(image.pixels() + y * header.width, fileData + header.dataOffset + y * header.pitch, header.width * sizeof(Pixel<T, n>));
+            }
+
+            return image;
+        }
+
+        #ifdef QCI_BUILTIN_PNG
+        {
+            // Anything the built-in decoder does not handle goes to stb_image
+            if constexpr (std::is_same_v<T, u8>)
+            {
+                Result<Image<T, n>> image{decodePng<T, n>(fileData, fileSize, allowComponentPadding)};
+                if (image)
+                {
+                    return image;
+                }
+            }
+        }
+        #endif
 
         s32 width, height, channels;
-        u8 * const data{stbi_load_from_memory(fileData->data(), s32(fileData->size()), &width, &height, &channels, allowComponentPadding ? s32(n) : 0)};
+        T * data;
+        if constexpr (std::is_same_v<T, u8>)
+        {
+            data = stbi_load_from_memory(fileData, s32(fileSize), &width, &height, &channels, allowComponentPadding ? s32(n) : 0);
+        }
+        else if constexpr (std::is_same_v<T, u16>)
+        {
+            data = stbi_load_16_from_memory(fileData, s32(fileSize), &width, &height, &channels, allowComponentPadding ? s32(n) : 0);
+        }
+        else
+        {
+            data = stbi_loadf_from_memory(fileData, s32(fileSize), &width, &height, &channels, allowComponentPadding ? s32(n) : 0);
+        }
         ScopeGuard memGuard{[data]() { STBI_FREE(data); }};
 
         FAIL_IF(!data);
@@ -158,6 +929,16 @@ namespace qci
         return Image<T, n>{uivec2{u32(width), u32(height)}, std::bit_cast<Pixel<T, n> *>(data)};
     }
 
+    template <Numeric T, u32 n>
+    Result<Image<T, n>> read(const std::filesystem::path & file, const bool allowComponentPadding)
+    {
+        const Result<List<u8>> fileData{utils::readFile(file)};
+
+        FAIL_IF(!fileData);
+
+        return decode<T, n>(fileData->data(), fileData->size(), allowComponentPadding);
+    }
+
     Result<GrayImage> readGray(const std::filesystem::path & file)
     {
         return read<u8, 1u>(file, false);
@@ -179,25 +960,107 @@ namespace qci
     }
 
     template <Numeric T, u32 n>
-    bool write(const Image<T, n> & image, const std::filesystem::path & file)
+    Result<List<u8>> encode(const Image<T, n> & image, const std::filesystem::path & extension)
     {
-        const std::filesystem::path extension{file.extension()};
-        if (extension == ".png")
+        static_assert(std::is_same_v<T, u8> || std::is_same_v<T, u16> || std::is_same_v<T, f32>);
+
+        FAIL_IF(!image.width() || !image.height());
+
+        if (extension == ".qci")
         {
-            s32 dataLength{};
-            u8 * const data{stbi_write_png_to_mem(std::bit_cast<const u8 *>(image.pixels()), s32(image.width() * sizeof(Pixel<T, n>)), s32(image.width()), s32(image.height()), s32(n), &dataLength)};
-            const qc::ScopeGuard dataGuard{[&]() { STBI_FREE(data); }};
+            const Result<RawHeader> header{_rawHeader(image)};
+            FAIL_IF(!header);
 
-            FAIL_IF(dataLength <= 0 || !data);
+            // Sizes are worked out in 64 bits, and images too large for a list, which is limited to 4 GB, are refused
+            const u64 pixelsSize{u64(header->pitch) * image.height()};
+            FAIL_IF(header->dataOffset + pixelsSize > std::numeric_limits<u32>::max());
 
-            FAIL_IF(!utils::writeFile(file, data, u64(dataLength)));
+            List<u8> data{};
+            data.resize(u32(header->dataOffset + pixelsSize));
+            std::memcpy(data.data(), &*header, sizeof(RawHeader));
+            std::memcpy(data.data() + header->dataOffset, image.pixels(), size_t(pixelsSize));
 
-            return true;
+            return data;
+        }
+
+        if constexpr (std::is_same_v<T, u8>)
+        {
+            if (extension == ".png")
+            {
+                s32 dataLength{};
+                u8 * const data{stbi_write_png_to_mem(std::bit_cast<const u8 *>(image.pixels()), s32(image.width() * sizeof(Pixel<T, n>)), s32(image.width()), s32(image.height()), s32(n), &dataLength)};
+                const qc::ScopeGuard dataGuard{[&]() { STBI_FREE(data); }};
+
+                FAIL_IF(dataLength <= 0 || !data);
+
+                List<u8> png{};
+                png.resize(u32(dataLength));
+                std::memcpy(png.data(), data, u32(dataLength));
+
+                return png;
+            }
+        }
+        else if constexpr (std::is_same_v<T, u16>)
+        {
+            if (extension == ".png")
+            {
+                List<u8> data{_encodePng16<n>(image)};
+
+                FAIL_IF(!data);
+
+                return data;
+            }
         }
         else
         {
-            return false; // Currently unsupported
+            if (extension == ".hdr")
+            {
+                List<u8> data{};
+                const auto append{[](void * const context, void * const chunk, const int size)
+                {
+                    List<u8> & dst{*static_cast<List<u8> *>(context)};
+                    const u32 offset{dst.size()};
+                    dst.resize(offset + u32(size));
+                    std::copy_n(static_cast<const u8 *>(chunk), size, dst.data() + offset);
+                }};
+
+                FAIL_IF(!stbi_write_hdr_to_func(append, &data, s32(image.width()), s32(image.height()), s32(n), std::bit_cast<const f32 *>(image.pixels())));
+
+                return data;
+            }
+        }
+
+        return {}; // Currently unsupported
+    }
+
+    template <Numeric T, u32 n>
+    bool write(const Image<T, n> & image, const std::filesystem::path & file)
+    {
+        // Raw files are the header then the pixels as they are, so are written straight from the image without an encoded copy, and have no 4 GB limit
+        if (file.extension() == ".qci")
+        {
+            FAIL_IF(!image.width() || !image.height());
+
+            const Result<RawHeader> header{_rawHeader(image)};
+            FAIL_IF(!header);
+
+            std::ofstream stream{file, std::ios::binary | std::ios::trunc};
+            FAIL_IF(!stream);
+            stream.write(std::bit_cast<const char *>(&*header), sizeof(RawHeader));
+            stream.write(std::bit_cast<const char *>(image.pixels()), std::streamsize(u64(header->pitch) * image.height()));
+            stream.close();
+            FAIL_IF(!stream);
+
+            return true;
         }
+
+        const Result<List<u8>> data{encode(image, file.extension())};
+
+        FAIL_IF(!data);
+
+        FAIL_IF(!utils::writeFile(file, data->data(), data->size()));
+
+        return true;
     }
 
     // Explicit template specialization
@@ -206,6 +1069,14 @@ namespace qci
     template class Image<u8, 2u>;
     template class Image<u8, 3u>;
     template class Image<u8, 4u>;
+    template class Image<u16, 1u>;
+    template class Image<u16, 2u>;
+    template class Image<u16, 3u>;
+    template class Image<u16, 4u>;
+    template class Image<f32, 1u>;
+    template class Image<f32, 2u>;
+    template class Image<f32, 3u>;
+    template class Image<f32, 4u>;
 
     template class ImageView<u8, 1u, false>;
     template class ImageView<u8, 1u, true>;
@@ -215,14 +1086,72 @@ namespace qci
     template class ImageView<u8, 3u, true>;
     template class ImageView<u8, 4u, false>;
     template class ImageView<u8, 4u, true>;
+    template class ImageView<u16, 1u, false>;
+    template class ImageView<u16, 1u, true>;
+    template class ImageView<u16, 2u, false>;
+    template class ImageView<u16, 2u, true>;
+    template class ImageView<u16, 3u, false>;
+    template class ImageView<u16, 3u, true>;
+    template class ImageView<u16, 4u, false>;
+    template class ImageView<u16, 4u, true>;
+    template class ImageView<f32, 1u, false>;
+    template class ImageView<f32, 1u, true>;
+    template class ImageView<f32, 2u, false>;
+    template class ImageView<f32, 2u, true>;
+    template class ImageView<f32, 3u, false>;
+    template class ImageView<f32, 3u, true>;
+    template class ImageView<f32, 4u, false>;
+    template class ImageView<f32, 4u, true>;
+
+    template Result<Image<u8, 1u>> decode<u8, 1u>(const u8 *, u64, bool);
+    template Result<Image<u8, 2u>> decode<u8, 2u>(const u8 *, u64, bool);
+    template Result<Image<u8, 3u>> decode<u8, 3u>(const u8 *, u64, bool);
+    template Result<Image<u8, 4u>> decode<u8, 4u>(const u8 *, u64, bool);
+    template Result<Image<u16, 1u>> decode<u16, 1u>(const u8 *, u64, bool);
+    template Result<Image<u16, 2u>> decode<u16, 2u>(const u8 *, u64, bool);
+    template Result<Image<u16, 3u>> decode<u16, 3u>(const u8 *, u64, bool);
+    template Result<Image<u16, 4u>> decode<u16, 4u>(const u8 *, u64, bool);
+    template Result<Image<f32, 1u>> decode<f32, 1u>(const u8 *, u64, bool);
+    template Result<Image<f32, 2u>> decode<f32, 2u>(const u8 *, u64, bool);
+    template Result<Image<f32, 3u>> decode<f32, 3u>(const u8 *, u64, bool);
+    template Result<Image<f32, 4u>> decode<f32, 4u>(const u8 *, u64, bool);
 
     template Result<GrayImage> read<u8, 1u>(const std::filesystem::path &, bool);
     template Result<GrayAlphaImage> read<u8, 2u>(const std::filesystem::path &, bool);
     template Result<RgbImage> read<u8, 3u>(const std::filesystem::path &, bool);
     template Result<RgbaImage> read<u8, 4u>(const std::filesystem::path &, bool);
+    template Result<Image<u16, 1u>> read<u16, 1u>(const std::filesystem::path &, bool);
+    template Result<Image<u16, 2u>> read<u16, 2u>(const std::filesystem::path &, bool);
+    template Result<Image<u16, 3u>> read<u16, 3u>(const std::filesystem::path &, bool);
+    template Result<Image<u16, 4u>> read<u16, 4u>(const std::filesystem::path &, bool);
+    template Result<Image<f32, 1u>> read<f32, 1u>(const std::filesystem::path &, bool);
+    template Result<Image<f32, 2u>> read<f32, 2u>(const std::filesystem::path &, bool);
+    template Result<Image<f32, 3u>> read<f32, 3u>(const std::filesystem::path &, bool);
+    template Result<Image<f32, 4u>> read<f32, 4u>(const std::filesystem::path &, bool);
+
+    template Result<List<u8>> encode(const Image<u8, 1u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u8, 2u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u8, 3u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u8, 4u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u16, 1u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u16, 2u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u16, 3u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<u16, 4u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<f32, 1u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<f32, 2u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<f32, 3u> &, const std::filesystem::path &);
+    template Result<List<u8>> encode(const Image<f32, 4u> &, const std::filesystem::path &);
 
     template bool write(const GrayImage &, const std::filesystem::path &);
     template bool write(const GrayAlphaImage &, const std::filesystem::path &);
     template bool write(const RgbImage &, const std::filesystem::path &);
     template bool write(const RgbaImage &, const std::filesystem::path &);
+    template bool write(const Image<u16, 1u> &, const std::filesystem::path &);
+    template bool write(const Image<u16, 2u> &, const std::filesystem::path &);
+    template bool write(const Image<u16, 3u> &, const std::filesystem::path &);
+    template bool write(const Image<u16, 4u> &, const std::filesystem::path &);
+    template bool write(const Image<f32, 1u> &, const std::filesystem::path &);
+    template bool write(const Image<f32, 2u> &, const std::filesystem::path &);
+    template bool write(const Image<f32, 3u> &, const std::filesystem::path &);
+    template bool write(const Image<f32, 4u> &, const std::filesystem::path &);
 }
@@ -0,0 +1,160 @@
+#include <qc-image/mapped.hpp>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace qci
+{
+    namespace
+    {
+        struct _Mapping
+        {
+            void * data{};
+            u64 size{};
+            void * handle{};
+        };
+
+        // Maps the whole file read only and shared
+        Result<_Mapping> _mapFile(const std::filesystem::path & file)
+        {
+            #ifdef _WIN32
+            {
+                const HANDLE fileHandle{CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+                FAIL_IF(fileHandle == INVALID_HANDLE_VALUE);
+                const ScopeGuard fileGuard{[fileHandle]() { CloseHandle(fileHandle); }};
+
+                LARGE_INTEGER fileSize{};
+                FAIL_IF(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0);
+
+                // The mapping object keeps the file open after its handle is closed
+                const HANDLE mappingHandle{CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0u, 0u, nullptr)};
+                FAIL_IF(!mappingHandle);
+                ScopeGuard mappingGuard{[mappingHandle]() { CloseHandle(mappingHandle); }};
+
+                void * const data{MapViewOfFile(mappingHandle, FILE_MAP_READ, 0u, 0u, 0u)};
+                FAIL_IF(!data);
+
+                mappingGuard.release();
+                return _Mapping{.data = data, .size = u64(fileSize.QuadPart), .handle = mappingHandle};
+            }
+            #else
+            {
+                const int fd{::open(file.c_str(), O_RDONLY | O_CLOEXEC)};
+                FAIL_IF(fd < 0);
+                // The mapping keeps its own reference to the file
+                const ScopeGuard fdGuard{[fd]() { ::close(fd); }};
+
+                struct stat fileStat{};
+                FAIL_IF(::fstat(fd, &fileStat) || fileStat.st_size <= 0);
+
+                void * const data{::mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0)};
+                FAIL_IF(data == MAP_FAILED);
+
+                return _Mapping{.data = data, .size = u64(fileStat.st_size)};
+            }
+            #endif
+        }
+
+        void _unmapFile(const _Mapping & mapping)
+        {
+            #ifdef _WIN32
+            {
+                UnmapViewOfFile(mapping.data);
+                CloseHandle(mapping.handle);
+            }
+            #else
+            {
+                ::munmap(mapping.data, size_t(mapping.size));
+            }
+            #endif
+        }
+    }
+
+    template <Numeric T, u32 n>
+    void MappedImage<T, n>::_unmap()
+    {
+        if (_mapping)
+        {
+            // The pixels belong to the mapping, so must not be freed by the image
+            _image.release();
+            _unmapFile(_Mapping{.data = _mapping, .size = _mappingSize, .handle = _mappingHandle});
+            _mapping = nullptr;
+            _mappingSize = 0u;
+            _mappingHandle = nullptr;
+        }
+    }
+
+    template <Numeric T, u32 n>
+    Result<MappedImage<T, n>> map(const std::filesystem::path & file)
+    {
+        Result<_Mapping> mapping{_mapFile(file)};
+
+        FAIL_IF(!mapping);
+
+        MappedImage<T, n> image{};
+        image._mapping = mapping->data;
+        image._mappingSize = mapping->size;
+        image._mappingHandle = mapping->handle;
+
+        // From here the mapped image owns the mapping and releases it on failure
+
+        FAIL_IF(mapping->size < sizeof(RawHeader));
+
+        RawHeader header;
+        std::memcpy(&header, mapping->data, sizeof(RawHeader));
+
+        FAIL_IF(std::memcmp(header.fileMagic, RawHeader::magic, sizeof(RawHeader::magic)));
+        FAIL_IF(header.version != RawHeader::currentVersion);
+        FAIL_IF(header.componentN != n || header.componentType != rawComponentType<T>);
+        FAIL_IF(!header.width || !header.height);
+        // `Image` has no pitch of its own, so rows must be tightly packed to be used in place
+        FAIL_IF(header.pitch != header.width * sizeof(Pixel<T, n>));
+        FAIL_IF(header.dataOffset < sizeof(RawHeader) || header.dataOffset % alignof(Pixel<T, n>));
+        FAIL_IF(mapping->size < u64(header.dataOffset) + u64(header.pitch) * header.height);
+
+        Pixel<T, n> * const pixels{std::bit_cast<Pixel<T, n> *>(static_cast<u8 *>(mapping->data) + header.dataOffset)};
+        image._image = Image<T, n>{uivec2{header.width, header.height}, pixels};
+
+        return image;
+    }
+
+    // Explicit template specialization
+
+    template class MappedImage<u8, 1u>;
+    template class MappedImage<u8, 2u>;
+    template class MappedImage<u8, 3u>;
+    template class MappedImage<u8, 4u>;
+    template class MappedImage<u16, 1u>;
+    template class MappedImage<u16, 2u>;
+    template class MappedImage<u16, 3u>;
+    template class MappedImage<u16, 4u>;
+    template class MappedImage<f32, 1u>;
+    template class MappedImage<f32, 2u>;
+    template class MappedImage<f32, 3u>;
+    template class MappedImage<f32, 4u>;
+
+    template Result<MappedImage<u8, 1u>> map<u8, 1u>(const std::filesystem::path &);
+    template Result<MappedImage<u8, 2u>> map<u8, 2u>(const std::filesystem::path &);
+    template Result<MappedImage<u8, 3u>> map<u8, 3u>(const std::filesystem::path &);
+    template Result<MappedImage<u8, 4u>> map<u8, 4u>(const std::filesystem::path &);
+    template Result<MappedImage<u16, 1u>> map<u16, 1u>(const std::filesystem::path &);
+    template Result<MappedImage<u16, 2u>> map<u16, 2u>(const std::filesystem::path &);
+    template Result<MappedImage<u16, 3u>> map<u16, 3u>(const std::filesystem::path &);
+    template Result<MappedImage<u16, 4u>> map<u16, 4u>(const std::filesystem::path &);
+    template Result<MappedImage<f32, 1u>> map<f32, 1u>(const std::filesystem::path &);
+    template Result<MappedImage<f32, 2u>> map<f32, 2u>(const std::filesystem::path &);
+    template Result<MappedImage<f32, 3u>> map<f32, 3u>(const std::filesystem::path &);
+    template Result<MappedImage<f32, 4u>> map<f32, 4u>(const std::filesystem::path &);
+}
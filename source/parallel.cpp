@@ -0,0 +1,336 @@
+#include <qc-image/parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <qc-core/list.hpp>
+
+namespace qci
+{
+    namespace
+    {
+        // A worker's remaining blocks as `begin | end << 32`, so the owner taking from the front and thieves taking from the back are each one exchange
+        struct alignas(64) _BlockRange
+        {
+            std::atomic<u64> blocks{};
+        };
+
+        finline u64 _packRange(const u32 begin, const u32 end)
+        {
+            return u64(begin) | (u64(end) << 32);
+        }
+
+        // Takes the next block from the front of the range
+        bool _takeFront(_BlockRange & range, u32 & block)
+        {
+            u64 packed{range.blocks.load(std::memory_order::relaxed)};
+            while (true)
+            {
+                const u32 begin{u32(packed)};
+                const u32 end{u32(packed >> 32)};
+                if (begin >= end)
+                {
+                    return false;
+                }
+
+                if (range.blocks.compare_exchange_weak(packed, _packRange(begin + 1u, end), std::memory_order::relaxed))
+                {
+                    block = begin;
+                    return true;
+                }
+            }
+        }
+
+        // Takes the back half of the range, rounded up
+        bool _stealBack(_BlockRange & range, u32 & stolenBegin, u32 & stolenEnd)
+        {
+            u64 packed{range.blocks.load(std::memory_order::relaxed)};
+            while (true)
+            {
+                const u32 begin{u32(packed)};
+                const u32 end{u32(packed >> 32)};
+                if (begin >= end)
+                {
+                    return false;
+                }
+
+                const u32 mid{begin + (end - begin) / 2u};
+                if (range.blocks.compare_exchange_weak(packed, _packRange(begin, mid), std::memory_order::relaxed))
+                {
+                    stolenBegin = mid;
+                    stolenEnd = end;
+                    return true;
+                }
+            }
+        }
+
+        void _work(_BlockRange * const ranges, const u32 workerN, const u32 self, const u32 count, const u32 grain, const std::function<void(u32, u32)> & func)
+        {
+            _BlockRange & own{ranges[self]};
+
+            while (true)
+            {
+                u32 block;
+                while (_takeFront(own, block))
+                {
+                    func(block * grain, std::min(block * grain + grain, count));
+                }
+
+                // Own range is empty, and only ever refilled by this thread, so it can be stored to directly
+                // Steal from whichever other worker has the most left, as that halves the largest imbalance
+                u32 victim{self};
+                u32 mostLeft{0u};
+                for (u32 i{1u}; i < workerN; ++i)
+                {
+                    const u32 other{(self + i) % workerN};
+                    const u64 packed{ranges[other].blocks.load(std::memory_order::relaxed)};
+                    const u32 left{u32(packed >> 32) > u32(packed) ? u32(packed >> 32) - u32(packed) : 0u};
+                    if (left > mostLeft)
+                    {
+                        mostLeft = left;
+                        victim = other;
+                    }
+                }
+
+                u32 stolenBegin, stolenEnd;
+                if (victim == self || !_stealBack(ranges[victim], stolenBegin, stolenEnd))
+                {
+                    // Nothing left to steal, or it went in the meantime, in which case look again
+                    if (victim == self)
+                    {
+                        return;
+                    }
+
+                    continue;
+                }
+
+                own.blocks.store(_packRange(stolenBegin, stolenEnd), std::memory_order::relaxed);
+            }
+        }
+
+        // Shared with the helper tasks, which may only start once the call has returned
+        struct _ParallelFor
+        {
+            std::unique_ptr<_BlockRange[]> ranges{};
+            u32 workerN{};
+            u32 count{};
+            u32 blockSize{};
+            const std::function<void(u32, u32)> * func{};
+            // Set once the caller runs out of work, after which helpers that have yet to start do nothing
+            std::atomic<bool> closed{};
+            // Helpers that started before closing, which the caller waits on
+            std::atomic<u32> activeN{};
+        };
+
+        struct alignas(64) _TaskQueue
+        {
+            std::mutex mutex{};
+            std::deque<std::function<void()>> tasks{};
+        };
+
+        std::atomic<Executor *> _customExecutor{};
+
+        ThreadPool & _builtinPool()
+        {
+            static ThreadPool pool{};
+            return pool;
+        }
+    }
+
+    void Executor::parallelFor(const u32 count, const u32 grain, const std::function<void(u32, u32)> & func)
+    {
+        if (!count)
+        {
+            return;
+        }
+
+        const u32 blockSize{std::max(grain, 1u)};
+        const u32 blockN{(count + blockSize - 1u) / blockSize};
+        const u32 workerN{std::min(blockN, std::max(concurrency(), 1u))};
+
+        if (workerN <= 1u)
+        {
+            func(0u, count);
+            return;
+        }
+
+        const std::shared_ptr<_ParallelFor> state{std::make_shared<_ParallelFor>()};
+        state->ranges.reset(new _BlockRange[workerN]);
+        state->workerN = workerN;
+        state->count = count;
+        state->blockSize = blockSize;
+        state->func = &func;
+        for (u32 i{0u}; i < workerN; ++i)
+        {
+            state->ranges[i].blocks.store(_packRange(u32(u64(blockN) * i / workerN), u32(u64(blockN) * (i + 1u) / workerN)), std::memory_order::relaxed);
+        }
+
+        for (u32 i{1u}; i < workerN; ++i)
+        {
+            submit([state, i]()
+            {
+                // Both sides are sequentially consistent, so either the caller sees this helper as active or the helper sees it closed
+                state->activeN.fetch_add(1u);
+                if (!state->closed.load())
+                {
+                    _work(state->ranges.get(), state->workerN, i, state->count, state->blockSize, *state->func);
+                }
+                state->activeN.fetch_sub(1u);
+                state->activeN.notify_all();
+            });
+        }
+
+        // Worker 0 is the calling thread, which also takes the blocks of any helper that has yet to start
+        _work(state->ranges.get(), workerN, 0u, count, blockSize, func);
+
+        // Every block has been taken, but helpers may still be running theirs
+        state->closed.store(true);
+        for (u32 activeN{state->activeN.load()}; activeN; activeN = state->activeN.load())
+        {
+            state->activeN.wait(activeN);
+        }
+    }
+
+    struct ThreadPool::_State
+    {
+        // Which pool and queue the current thread works for, if any
+        static thread_local const _State * current;
+        static thread_local u32 currentQueue;
+
+        u32 threadN{};
+        std::unique_ptr<_TaskQueue[]> queues{};
+        // Next queue for tasks submitted from outside the pool
+        std::atomic<u32> nextQueue{};
+        // Tasks queued but not yet taken, only changed while holding the queue's lock
+        std::atomic<u64> pendingN{};
+        std::mutex sleepMutex{};
+        std::condition_variable sleepCondition{};
+        bool stopping{};
+        // Declared last so the threads are joined before the rest is destroyed
+        List<std::jthread> threads{};
+
+        bool take(const u32 self, std::function<void()> & task)
+        {
+            // Own queue newest first, as its tasks are likely the most related to what just ran
+            {
+                _TaskQueue & queue{queues[self]};
+                const std::scoped_lock lock{queue.mutex};
+                if (!queue.tasks.empty())
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    pendingN.fetch_sub(1u);
+                    return true;
+                }
+            }
+
+            // Then steal the oldest task of another
+            for (u32 i{1u}; i < threadN; ++i)
+            {
+                _TaskQueue & queue{queues[(self + i) % threadN]};
+                const std::scoped_lock lock{queue.mutex};
+                if (!queue.tasks.empty())
+                {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    pendingN.fetch_sub(1u);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void work(const u32 self)
+        {
+            current = this;
+            currentQueue = self;
+
+            while (true)
+            {
+                std::function<void()> task{};
+                if (take(self, task))
+                {
+                    task();
+                    continue;
+                }
+
+                std::unique_lock lock{sleepMutex};
+                sleepCondition.wait(lock, [this]() { return pendingN.load() || stopping; });
+
+                // Remaining tasks are still run once stopping
+                if (stopping && !pendingN.load())
+                {
+                    return;
+                }
+            }
+        }
+    };
+
+    thread_local const ThreadPool::_State * ThreadPool::_State::current{};
+    thread_local u32 ThreadPool::_State::currentQueue{};
+
+    ThreadPool::ThreadPool(const u32 threadN) :
+        _state{std::make_unique<_State>()}
+    {
+        _state->threadN = threadN ? threadN : std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+        _state->queues.reset(new _TaskQueue[_state->threadN]);
+        _state->threads.resize(_state->threadN);
+        for (u32 i{0u}; i < _state->threadN; ++i)
+        {
+            _state->threads[i] = std::jthread{[state = _state.get(), i]() { state->work(i); }};
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            const std::scoped_lock lock{_state->sleepMutex};
+            _state->stopping = true;
+        }
+        _state->sleepCondition.notify_all();
+    }
+
+    void ThreadPool::submit(std::function<void()> task)
+    {
+        const u32 queueI{_State::current == _state.get() ? _State::currentQueue : _state->nextQueue.fetch_add(1u, std::memory_order::relaxed) % _state->threadN};
+
+        {
+            _TaskQueue & queue{_state->queues[queueI]};
+            const std::scoped_lock lock{queue.mutex};
+            queue.tasks.push_back(std::move(task));
+            _state->pendingN.fetch_add(1u);
+        }
+
+        // Taking the lock orders this against a worker checking for tasks just before it sleeps
+        {
+            const std::scoped_lock lock{_state->sleepMutex};
+        }
+        _state->sleepCondition.notify_one();
+    }
+
+    u32 ThreadPool::concurrency() const
+    {
+        return _state->threadN + 1u;
+    }
+
+    u32 ThreadPool::threadN() const
+    {
+        return _state->threadN;
+    }
+
+    Executor & defaultExecutor()
+    {
+        Executor * const executor{_customExecutor.load(std::memory_order::acquire)};
+        return executor ? *executor : _builtinPool();
+    }
+
+    void setDefaultExecutor(Executor * const executor)
+    {
+        _customExecutor.store(executor, std::memory_order::release);
+    }
+}
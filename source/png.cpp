@@ -0,0 +1,1433 @@
+#include <qc-image/png.hpp>
+
+#include <bit>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define _QCI_PNG_SSE2
+    #include <emmintrin.h>
+#endif
+
+#include <qc-core/list.hpp>
+
+namespace qci
+{
+    namespace
+    {
+        constexpr u8 _pngSignature[8]{0x89u, 'P', 'N', 'G', '\r', '\n', 0x1Au, '\n'};
+
+        // Larger dimensions are refused, as by stb_image, as are images with more pixels than an `Image` can index
+        constexpr u32 _maxDimension{1u << 24};
+
+        // Compressed data is read from disk in blocks of this size
+        constexpr u32 _inputBlockSize{1u << 16};
+
+        // Deflate back references reach at most this far
+        constexpr u32 _windowSize{1u << 15};
+
+        constexpr u32 _maxCodeLength{15u};
+        constexpr u32 _maxLiteralSymbolN{288u};
+        constexpr u32 _maxDistanceSymbolN{32u};
+
+        constexpr u16 _lengthBases[29]{3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u, 11u, 13u, 15u, 17u, 19u, 23u, 27u, 31u, 35u, 43u, 51u, 59u, 67u, 83u, 99u, 115u, 131u, 163u, 195u, 227u, 258u};
+        constexpr u8 _lengthExtraBits[29]{0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u, 1u, 1u, 1u, 2u, 2u, 2u, 2u, 3u, 3u, 3u, 3u, 4u, 4u, 4u, 4u, 5u, 5u, 5u, 5u, 0u};
+        constexpr u16 _distanceBases[30]{1u, 2u, 3u, 4u, 5u, 7u, 9u, 13u, 17u, 25u, 33u, 49u, 65u, 97u, 129u, 193u, 257u, 385u, 513u, 769u, 1025u, 1537u, 2049u, 3073u, 4097u, 6145u, 8193u, 12289u, 16385u, 24577u};
+        constexpr u8 _distanceExtraBits[30]{0u, 0u, 0u, 0u, 1u, 1u, 2u, 2u, 3u, 3u, 4u, 4u, 5u, 5u, 6u, 6u, 7u, 7u, 8u, 8u, 9u, 9u, 10u, 10u, 11u, 11u, 12u, 12u, 13u, 13u};
+        constexpr u8 _codeLengthOrder[19]{16u, 17u, 18u, 0u, 8u, 7u, 9u, 6u, 10u, 5u, 11u, 4u, 12u, 3u, 13u, 2u, 14u, 1u, 15u};
+
+        // Fast huffman lookups index this many bits at a time. Longer codes take the slow path
+        constexpr u32 _literalTableBits{11u};
+        constexpr u32 _distanceTableBits{9u};
+
+        // Lookup table entry layout:
+        //   bits 0-3: total code bits consumed
+        //   bits 4-5: number of literals decoded, or 0 for any other symbol
+        //   bit 6: set if the code is longer than the table, and must be decoded bit by bit
+        //   bits 8-16: first symbol
+        //   bits 17-24: second literal
+        // Zero entries match no code
+        constexpr u32 _entryLengthMask{0xFu};
+        constexpr u32 _entryLiteralShift{4u};
+        constexpr u32 _entrySlowFlag{1u << 6};
+        constexpr u32 _entrySymbolShift{8u};
+        constexpr u32 _entrySecondShift{17u};
+
+        // Decoded bytes are kept in a linear buffer with at least a window's worth of history before the batch being decoded
+        // A batch may overrun by one max length match, plus slack for copying eight bytes at a time
+        constexpr u32 _batchSize{1u << 16};
+        constexpr u32 _historyBufferSize{_windowSize + _batchSize + 258u + 8u};
+
+        u32 _readU32BigEndian(const u8 * const src)
+        {
+            return (u32(src[0]) << 24) | (u32(src[1]) << 16) | (u32(src[2]) << 8) | u32(src[3]);
+        }
+
+        // Sequential access to a file on disk, read a block at a time, or to a file already in memory
+        class _Input
+        {
+          public:
+
+            bool openFile(const std::filesystem::path & file)
+            {
+                _stream.open(file, std::ios::binary);
+                FAIL_IF(!_stream);
+                _buffer.resize(_inputBlockSize);
+                return true;
+            }
+
+            void openMemory(const u8 * const data, const u64 size)
+            {
+                _memory = data;
+                _memoryEnd = data + size;
+            }
+
+            nodisc bool read(u8 * const dst, const u32 size)
+            {
+                if (_memory)
+                {
+                    FAIL_IF(u64(_memoryEnd - _memory) < size);
+                    std::memcpy(dst, _memory, size);
+                    _memory += size;
+                    return true;
+                }
+
+                return bool(_stream.read(reinterpret_cast<char *>(dst), size));
+            }
+
+            nodisc bool skip(const u32 size)
+            {
+                if (_memory)
+                {
+                    FAIL_IF(u64(_memoryEnd - _memory) < size);
+                    _memory += size;
+                    return true;
+                }
+
+                return bool(_stream.seekg(std::streamoff(size), std::ios::cur));
+            }
+
+            // Points `data` at up to `maxSize` of the next bytes, in place if in memory
+            // @return number of bytes, or 0 at the end or on failure
+            nodisc u32 next(const u8 * & data, const u32 maxSize)
+            {
+                if (_memory)
+                {
+                    const u32 size{u32(min(u64(_memoryEnd - _memory), u64(maxSize)))};
+                    data = _memory;
+                    _memory += size;
+                    return size;
+                }
+
+                const u32 size{min(maxSize, _buffer.size())};
+                FAIL_IF(!_stream.read(reinterpret_cast<char *>(_buffer.data()), size));
+                data = _buffer.data();
+                return size;
+            }
+
+          private:
+
+            std::ifstream _stream{};
+            List<u8> _buffer{};
+            const u8 * _memory{};
+            const u8 * _memoryEnd{};
+        };
+
+        // Feeds the concatenated contents of consecutive IDAT chunks
+        class _IdatSource
+        {
+          public:
+
+            explicit _IdatSource(_Input & input) :
+                _input{input}
+            {}
+
+            // Remaining data bytes in the current IDAT chunk
+            u32 chunkRemaining{};
+
+            // Points `data` at the next run of image data
+            // @return number of bytes, or 0 once the image data is exhausted
+            nodisc u32 next(const u8 * & data)
+            {
+                while (!chunkRemaining)
+                {
+                    if (_ended)
+                    {
+                        return 0u;
+                    }
+
+                    // Skip the CRC of the current chunk, then read the next chunk's header
+                    u8 header[12];
+                    if (!_input.read(header, 12u) || std::memcmp(header + 8, "IDAT", 4))
+                    {
+                        _ended = true;
+                        return 0u;
+                    }
+                    chunkRemaining = _readU32BigEndian(header + 4);
+                }
+
+                const u32 size{_input.next(data, chunkRemaining)};
+                if (!size)
+                {
+                    _ended = true;
+                    return 0u;
+                }
+
+                chunkRemaining -= size;
+                return size;
+            }
+
+          private:
+
+            _Input & _input;
+            bool _ended{};
+        };
+
+        u32 _reverseBits(u32 v, const u32 n)
+        {
+            u32 r{0u};
+            for (u32 i{0u}; i < n; ++i, v >>= 1)
+            {
+                r = (r << 1) | (v & 1u);
+            }
+            return r;
+        }
+
+        // Canonical huffman code, with a lookup table for codes up to `tableBits` long
+        template <u32 tableBits>
+        struct _Huffman
+        {
+            u16 counts[_maxCodeLength + 1u];
+            u16 symbols[_maxLiteralSymbolN];
+            u32 table[1u << tableBits];
+
+            // `pairLiterals` allows two literals to be decoded by one lookup when their codes fit together
+            // @return false if the code lengths are over subscribed
+            bool build(const u8 * const lengths, const u32 symbolN, const bool pairLiterals)
+            {
+                std::fill_n(counts, _maxCodeLength + 1u, u16(0u));
+                for (u32 i{0u}; i < symbolN; ++i)
+                {
+                    ++counts[lengths[i]];
+                }
+                counts[0] = 0u;
+
+                s32 left{1};
+                for (u32 length{1u}; length <= _maxCodeLength; ++length)
+                {
+                    left = (left << 1) - s32(counts[length]);
+                    FAIL_IF(left < 0);
+                }
+
+                // Symbols sorted by code, for the slow path
+
+                u16 offsets[_maxCodeLength + 1u];
+                offsets[1] = 0u;
+                for (u32 length{1u}; length < _maxCodeLength; ++length)
+                {
+                    offsets[length + 1u] = u16(offsets[length] + counts[length]);
+                }
+
+                for (u32 i{0u}; i < symbolN; ++i)
+                {
+                    if (lengths[i])
+                    {
+                        symbols[offsets[lengths[i]]++] = u16(i);
+                    }
+                }
+
+                // Lookup table, indexed by the next bits of the stream, which hold codes bit reversed
+
+                std::fill_n(table, 1u << tableBits, 0u);
+
+                u32 nextCodes[_maxCodeLength + 1u];
+                u32 code{0u};
+                nextCodes[0] = 0u;
+                for (u32 length{1u}; length <= _maxCodeLength; ++length)
+                {
+                    code = (code + counts[length - 1u]) << 1;
+                    nextCodes[length] = code;
+                }
+
+                for (u32 symbol{0u}; symbol < symbolN; ++symbol)
+                {
+                    const u32 length{lengths[symbol]};
+                    if (!length)
+                    {
+                        continue;
+                    }
+
+                    const u32 reversed{_reverseBits(nextCodes[length]++, length)};
+                    if (length <= tableBits)
+                    {
+                        const u32 entry{length | (symbol < 256u ? 1u << _entryLiteralShift : 0u) | (symbol << _entrySymbolShift)};
+                        for (u32 i{reversed}; i < (1u << tableBits); i += 1u << length)
+                        {
+                            table[i] = entry;
+                        }
+                    }
+                    else
+                    {
+                        table[reversed & ((1u << tableBits) - 1u)] = _entrySlowFlag;
+                    }
+                }
+
+                if (pairLiterals)
+                {
+                    u32 singles[1u << tableBits];
+                    std::copy_n(table, 1u << tableBits, singles);
+
+                    for (u32 i{0u}; i < (1u << tableBits); ++i)
+                    {
+                        const u32 first{singles[i]};
+                        const u32 firstLength{first & _entryLengthMask};
+                        if (!(first & (1u << _entryLiteralShift)) || firstLength >= tableBits)
+                        {
+                            continue;
+                        }
+
+                        // Only valid if the second code fits in the bits remaining
+                        const u32 second{singles[i >> firstLength]};
+                        const u32 secondLength{second & _entryLengthMask};
+                        if (!(second & (1u << _entryLiteralShift)) || firstLength + secondLength > tableBits)
+                        {
+                            continue;
+                        }
+
+                        table[i] = (firstLength + secondLength) | (2u << _entryLiteralShift) | (first & (0x1FFu << _entrySymbolShift)) | ((second >> _entrySymbolShift) << _entrySecondShift);
+                    }
+                }
+
+                return true;
+            }
+        };
+
+        // Resumable zlib decoder, which produces as many bytes as are asked for at a time
+        // Symbols are decoded in batches into a history buffer using lookup tables, and then copied out
+        class _Inflater
+        {
+          public:
+
+            explicit _Inflater(_IdatSource & source) :
+                _source{source}
+            {}
+
+            // Reads and validates the two byte zlib header
+            nodisc bool begin()
+            {
+                _refill();
+                const u32 cmf{_bits(8u)};
+                const u32 flg{_bits(8u)};
+                FAIL_IF(_corrupt);
+                FAIL_IF((cmf & 15u) != 8u || (cmf >> 4) > 7u);
+                FAIL_IF((cmf * 256u + flg) % 31u);
+                // Preset dictionaries are not allowed in PNG
+                FAIL_IF(flg & 32u);
+                return true;
+            }
+
+            // Fills `dst` with the next `size` decompressed bytes
+            // @return false if the stream ended early or is corrupt
+            nodisc bool inflate(u8 * dst, u32 size)
+            {
+                while (size)
+                {
+                    if (_delivered == _decoded)
+                    {
+                        FAIL_IF(!_decodeBatch());
+                        // The stream ended
+                        FAIL_IF(_delivered == _decoded);
+                    }
+
+                    const u32 copyN{min(size, _decoded - _delivered)};
+                    std::memcpy(dst, _history + _delivered, copyN);
+                    _delivered += copyN;
+                    dst += copyN;
+                    size -= copyN;
+                }
+
+                return true;
+            }
+
+          private:
+
+            enum class _Mode : u8
+            {
+                header,
+                stored,
+                huffman,
+                done
+            };
+
+            _IdatSource & _source;
+            const u8 * _in{};
+            const u8 * _inEnd{};
+
+            u64 _bitBuffer{};
+            u32 _bitCount{};
+            bool _corrupt{};
+
+            _Mode _mode{_Mode::header};
+            bool _isFinal{};
+            u32 _storedRemaining{};
+            _Huffman<_literalTableBits> _literalCode{};
+            _Huffman<_distanceTableBits> _distanceCode{};
+
+            // Total bytes decoded, to validate distances near the start
+            u64 _totalDecoded{};
+            u32 _decoded{};
+            u32 _delivered{};
+            u8 _history[_historyBufferSize];
+
+            // Tops the bit buffer up to at least 56 bits, unless the input is exhausted
+            // The fast path loads eight bytes at once, leaving any bits beyond the count as copies of the bytes not yet consumed
+            finline void _refill()
+            {
+                if constexpr (std::endian::native == std::endian::little)
+                {
+                    if (_inEnd - _in >= 8)
+                    {
+                        u64 v;
+                        std::memcpy(&v, _in, 8u);
+                        _bitBuffer |= v << _bitCount;
+                        _in += (63u - _bitCount) >> 3;
+                        _bitCount |= 56u;
+                        return;
+                    }
+                }
+
+                while (_bitCount < 56u)
+                {
+                    if (_in == _inEnd)
+                    {
+                        const u32 size{_source.next(_in)};
+                        if (!size)
+                        {
+                            return;
+                        }
+                        _inEnd = _in + size;
+                    }
+
+                    _bitBuffer |= u64(*_in++) << _bitCount;
+                    _bitCount += 8u;
+                }
+            }
+
+            finline void _consume(const u32 n)
+            {
+                if (n > _bitCount)
+                {
+                    // Ran past the end of the data
+                    _corrupt = true;
+                    _bitBuffer = 0u;
+                    _bitCount = 0u;
+                    return;
+                }
+
+                _bitBuffer >>= n;
+                _bitCount -= n;
+            }
+
+            // Takes `n` bits from the buffer, which must have been refilled enough beforehand
+            finline u32 _bits(const u32 n)
+            {
+                const u32 v{u32(_bitBuffer & ((u64(1u) << n) - 1u))};
+                _consume(n);
+                return v;
+            }
+
+            template <u32 tableBits>
+            finline s32 _decode(const _Huffman<tableBits> & huffman)
+            {
+                const u32 entry{huffman.table[_bitBuffer & ((1u << tableBits) - 1u)]};
+                if (!(entry & _entrySlowFlag)) [[likely]]
+                {
+                    if (!entry)
+                    {
+                        return -1;
+                    }
+                    _consume(entry & _entryLengthMask);
+                    return s32(entry >> _entrySymbolShift);
+                }
+
+                return _decodeSlow(huffman);
+            }
+
+            template <u32 tableBits>
+            s32 _decodeSlow(const _Huffman<tableBits> & huffman)
+            {
+                s32 code{0}, first{0}, index{0};
+                for (u32 length{1u}; length <= _maxCodeLength; ++length)
+                {
+                    code |= s32(_bits(1u));
+                    const s32 count{huffman.counts[length]};
+                    if (code - count < first)
+                    {
+                        return huffman.symbols[index + (code - first)];
+                    }
+                    index += count;
+                    first += count;
+                    first <<= 1;
+                    code <<= 1;
+                }
+
+                return -1;
+            }
+
+            // @return the end of the copied match
+            static finline u8 * _copyMatch(u8 * out, const u32 distance, const u32 length)
+            {
+                const u8 * src{out - distance};
+                u8 * const end{out + length};
+                if (distance >= 8u)
+                {
+                    // May write up to seven bytes past the end, into the buffer's slack
+                    for (; out < end; out += 8, src += 8)
+                    {
+                        std::memcpy(out, src, 8u);
+                    }
+                }
+                else if (distance == 1u)
+                {
+                    std::memset(out, *src, length);
+                }
+                else
+                {
+                    for (; out < end; ++out, ++src)
+                    {
+                        *out = *src;
+                    }
+                }
+                return end;
+            }
+
+            // Decodes symbols while at least eight input bytes remain, so every refill is a single load and no bounds checks are needed
+            // The bit reader is kept in locals, as otherwise every byte written through `out` would force it back to memory
+            // Stops before anything unusual, which is left for the general path: long codes, invalid codes, and the end of the block
+            // @return the new output position, or null if the data is corrupt
+            u8 * _decodeHuffmanFast(u8 * out, u8 * const outLimit)
+            {
+                const u8 * const outBegin{_history + _decoded};
+                const u32 * const literalTable{_literalCode.table};
+                const u32 * const distanceTable{_distanceCode.table};
+                const u8 * in{_in};
+                const u8 * const inLimit{_inEnd - 8};
+                u64 bitBuffer{_bitBuffer};
+                u32 bitCount{_bitCount};
+
+                while (out < outLimit && in <= inLimit)
+                {
+                    u64 v;
+                    std::memcpy(&v, in, 8u);
+                    bitBuffer |= v << bitCount;
+                    in += (63u - bitCount) >> 3;
+                    bitCount |= 56u;
+
+                    // At least 56 bits are now available, enough for the longest length and distance pair
+                    const u32 entry{literalTable[bitBuffer & ((1u << _literalTableBits) - 1u)]};
+                    const u32 literalN{(entry >> _entryLiteralShift) & 3u};
+
+                    if (literalN) [[likely]]
+                    {
+                        const u32 codeLength{entry & _entryLengthMask};
+                        bitBuffer >>= codeLength;
+                        bitCount -= codeLength;
+                        out[0] = u8(entry >> _entrySymbolShift);
+                        out[1] = u8(entry >> _entrySecondShift);
+                        out += literalN;
+                        continue;
+                    }
+
+                    const u32 symbol{entry >> _entrySymbolShift};
+                    if ((entry & _entrySlowFlag) || !entry || symbol < 257u || symbol >= 257u + 29u)
+                    {
+                        break;
+                    }
+
+                    // Look everything up before consuming, so the general path can resume from this symbol
+                    const u32 lengthIndex{symbol - 257u};
+                    const u32 lengthExtraBits{_lengthExtraBits[lengthIndex]};
+                    u32 bits{entry & _entryLengthMask};
+                    const u32 length{_lengthBases[lengthIndex] + u32((bitBuffer >> bits) & ((u64(1u) << lengthExtraBits) - 1u))};
+                    bits += lengthExtraBits;
+
+                    const u32 distanceEntry{distanceTable[(bitBuffer >> bits) & ((1u << _distanceTableBits) - 1u)]};
+                    const u32 distanceSymbol{distanceEntry >> _entrySymbolShift};
+                    if ((distanceEntry & _entrySlowFlag) || !distanceEntry || distanceSymbol >= 30u)
+                    {
+                        break;
+                    }
+
+                    bits += distanceEntry & _entryLengthMask;
+                    const u32 distanceExtraBits{_distanceExtraBits[distanceSymbol]};
+                    const u32 distance{_distanceBases[distanceSymbol] + u32((bitBuffer >> bits) & ((u64(1u) << distanceExtraBits) - 1u))};
+                    bits += distanceExtraBits;
+
+                    if (distance > _totalDecoded + u64(out - outBegin))
+                    {
+                        return nullptr;
+                    }
+
+                    bitBuffer >>= bits;
+                    bitCount -= bits;
+
+                    out = _copyMatch(out, distance, length);
+                }
+
+                _in = in;
+                _bitBuffer = bitBuffer;
+                _bitCount = bitCount;
+
+                return out;
+            }
+
+            bool _beginBlock()
+            {
+                if (_isFinal)
+                {
+                    _mode = _Mode::done;
+                    return true;
+                }
+
+                _refill();
+                _isFinal = _bits(1u);
+                switch (_bits(2u))
+                {
+                    case 0u: return _beginStored();
+                    case 1u: _beginFixed(); return !_corrupt;
+                    case 2u: return _beginDynamic();
+                    default: return false;
+                }
+            }
+
+            bool _beginStored()
+            {
+                // Discard the rest of the current byte
+                _consume(_bitCount % 8u);
+
+                _refill();
+                const u32 length{_bits(16u)};
+                const u32 lengthComplement{_bits(16u)};
+                FAIL_IF(_corrupt || length != (~lengthComplement & 0xFFFFu));
+
+                _storedRemaining = length;
+                _mode = length ? _Mode::stored : _Mode::header;
+                return true;
+            }
+
+            void _beginFixed()
+            {
+                u8 lengths[_maxLiteralSymbolN];
+                std::fill_n(lengths, 144u, u8(8u));
+                std::fill_n(lengths + 144, 112u, u8(9u));
+                std::fill_n(lengths + 256, 24u, u8(7u));
+                std::fill_n(lengths + 280, 8u, u8(8u));
+                _literalCode.build(lengths, _maxLiteralSymbolN, true);
+
+                std::fill_n(lengths, _maxDistanceSymbolN, u8(5u));
+                _distanceCode.build(lengths, _maxDistanceSymbolN, false);
+
+                _mode = _Mode::huffman;
+            }
+
+            bool _beginDynamic()
+            {
+                _refill();
+                const u32 literalN{_bits(5u) + 257u};
+                const u32 distanceN{_bits(5u) + 1u};
+                const u32 codeLengthN{_bits(4u) + 4u};
+                FAIL_IF(_corrupt || literalN > 286u || distanceN > 30u);
+
+                u8 lengths[_maxLiteralSymbolN + _maxDistanceSymbolN]{};
+
+                // Up to 57 bits, more than one refill guarantees
+                for (u32 i{0u}; i < codeLengthN; ++i)
+                {
+                    _refill();
+                    lengths[_codeLengthOrder[i]] = u8(_bits(3u));
+                }
+
+                _Huffman<7u> codeLengthCode;
+                FAIL_IF(!codeLengthCode.build(lengths, 19u, false));
+
+                std::fill_n(lengths, 19u, u8(0u));
+
+                for (u32 i{0u}; i < literalN + distanceN;)
+                {
+                    _refill();
+                    const s32 symbol{_decode(codeLengthCode)};
+                    FAIL_IF(symbol < 0 || _corrupt);
+
+                    if (symbol < 16)
+                    {
+                        lengths[i++] = u8(symbol);
+                        continue;
+                    }
+
+                    u8 repeated{0u};
+                    u32 repeatN;
+                    if (symbol == 16)
+                    {
+                        FAIL_IF(!i);
+                        repeated = lengths[i - 1u];
+                        repeatN = 3u + _bits(2u);
+                    }
+                    else if (symbol == 17)
+                    {
+                        repeatN = 3u + _bits(3u);
+                    }
+                    else
+                    {
+                        repeatN = 11u + _bits(7u);
+                    }
+                    FAIL_IF(i + repeatN > literalN + distanceN);
+
+                    std::fill_n(lengths + i, repeatN, repeated);
+                    i += repeatN;
+                }
+
+                // Must have an end of block code
+                FAIL_IF(!lengths[256]);
+
+                FAIL_IF(!_literalCode.build(lengths, literalN, true));
+                FAIL_IF(!_distanceCode.build(lengths + literalN, distanceN, false));
+
+                _mode = _Mode::huffman;
+                return true;
+            }
+
+            // Decodes roughly a batch worth of bytes, stopping early only at the end of the stream
+            // @return false if the data is corrupt
+            bool _decodeBatch()
+            {
+                // Everything has been delivered, so only the window before it needs keeping
+                if (_decoded > _windowSize)
+                {
+                    std::memmove(_history, _history + _decoded - _windowSize, _windowSize);
+                    _decoded = _delivered = _windowSize;
+                }
+
+                u8 * out{_history + _decoded};
+                u8 * const outLimit{_history + _windowSize + _batchSize};
+
+                while (out < outLimit && _mode != _Mode::done)
+                {
+                    switch (_mode)
+                    {
+                        case _Mode::header:
+                        {
+                            FAIL_IF(!_beginBlock());
+                            break;
+                        }
+                        case _Mode::stored:
+                        {
+                            // Whole bytes left in the bit buffer come first
+                            while (_storedRemaining && _bitCount && out < outLimit)
+                            {
+                                *out++ = u8(_bits(8u));
+                                --_storedRemaining;
+                            }
+
+                            if (!_bitCount)
+                            {
+                                // Bits beyond the count may hold read ahead bytes, which go stale once input is taken directly
+                                _bitBuffer = 0u;
+
+                                while (_storedRemaining && out < outLimit)
+                                {
+                                    if (_in == _inEnd)
+                                    {
+                                        const u32 size{_source.next(_in)};
+                                        FAIL_IF(!size);
+                                        _inEnd = _in + size;
+                                    }
+
+                                    const u32 copyN{u32(min(u64(_storedRemaining), min(u64(_inEnd - _in), u64(outLimit - out))))};
+                                    std::memcpy(out, _in, copyN);
+                                    _in += copyN;
+                                    out += copyN;
+                                    _storedRemaining -= copyN;
+                                }
+                            }
+
+                            if (!_storedRemaining)
+                            {
+                                _mode = _Mode::header;
+                            }
+                            break;
+                        }
+                        case _Mode::huffman:
+                        {
+                            while (out < outLimit)
+                            {
+                                out = _decodeHuffmanFast(out, outLimit);
+                                FAIL_IF(!out);
+
+                                if (out >= outLimit)
+                                {
+                                    break;
+                                }
+
+                                // One symbol through the general path, for whatever the fast path stopped at, or the last bytes of input
+                                _refill();
+
+                                // Literal entries may hold a pair, which `_decode` would not unpack
+                                const u32 entry{_literalCode.table[_bitBuffer & ((1u << _literalTableBits) - 1u)]};
+                                const u32 literalN{(entry >> _entryLiteralShift) & 3u};
+                                if (literalN)
+                                {
+                                    _consume(entry & _entryLengthMask);
+                                    FAIL_IF(_corrupt);
+                                    out[0] = u8(entry >> _entrySymbolShift);
+                                    out[1] = u8(entry >> _entrySecondShift);
+                                    out += literalN;
+                                    continue;
+                                }
+
+                                const s32 symbol{_decode(_literalCode)};
+                                FAIL_IF(symbol < 0);
+
+                                if (symbol < 256)
+                                {
+                                    *out++ = u8(symbol);
+                                    continue;
+                                }
+
+                                if (symbol == 256)
+                                {
+                                    _mode = _Mode::header;
+                                    break;
+                                }
+
+                                const u32 lengthIndex{u32(symbol) - 257u};
+                                FAIL_IF(lengthIndex >= 29u);
+                                const u32 length{_lengthBases[lengthIndex] + _bits(_lengthExtraBits[lengthIndex])};
+
+                                const s32 distanceSymbol{_decode(_distanceCode)};
+                                FAIL_IF(distanceSymbol < 0 || distanceSymbol >= 30);
+                                const u32 distance{_distanceBases[distanceSymbol] + _bits(_distanceExtraBits[distanceSymbol])};
+                                FAIL_IF(_corrupt || distance > _totalDecoded + u64(out - (_history + _decoded)));
+
+                                out = _copyMatch(out, distance, length);
+                            }
+                            break;
+                        }
+                        case _Mode::done:
+                        {
+                            break;
+                        }
+                    }
+
+                    FAIL_IF(_corrupt);
+                }
+
+                const u32 decodedN{u32(out - (_history + _decoded))};
+                _totalDecoded += decodedN;
+                _decoded += decodedN;
+
+                return true;
+            }
+        };
+
+        u8 _paeth(const s32 a, const s32 b, const s32 c)
+        {
+            const s32 p{a + b - c};
+            const s32 pa{abs(p - a)};
+            const s32 pb{abs(p - b)};
+            const s32 pc{abs(p - c)};
+            return u8(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+        }
+
+        #ifdef _QCI_PNG_SSE2
+
+        // Loads a pixel of three or four bytes into the low lanes
+        // Three byte pixels are assembled from parts, as a partial copy through memory stalls store forwarding
+        template <u32 pixelSize>
+        finline __m128i _loadPixel(const u8 * const src)
+        {
+            if constexpr (pixelSize == 3u)
+            {
+                u16 low;
+                std::memcpy(&low, src, 2u);
+                return _mm_cvtsi32_si128(s32(u32(low) | (u32(src[2]) << 16)));
+            }
+            else
+            {
+                s32 v;
+                std::memcpy(&v, src, 4u);
+                return _mm_cvtsi32_si128(v);
+            }
+        }
+
+        template <u32 pixelSize>
+        finline void _storePixel(u8 * const dst, const __m128i v)
+        {
+            const u32 w{u32(_mm_cvtsi128_si32(v))};
+            if constexpr (pixelSize == 3u)
+            {
+                const u16 low{u16(w)};
+                std::memcpy(dst, &low, 2u);
+                dst[2] = u8(w >> 16);
+            }
+            else
+            {
+                std::memcpy(dst, &w, 4u);
+            }
+        }
+
+        // Each pixel depends on the one before, so the parallelism is across the components of a pixel
+        template <u32 pixelSize>
+        void _unfilterSubSimd(u8 * const row, const u32 size)
+        {
+            __m128i a{_mm_setzero_si128()};
+            for (u32 i{0u}; i < size; i += pixelSize)
+            {
+                a = _mm_add_epi8(a, _loadPixel<pixelSize>(row + i));
+                _storePixel<pixelSize>(row + i, a);
+            }
+        }
+
+        template <u32 pixelSize>
+        void _unfilterAverageSimd(u8 * const row, const u8 * const prev, const u32 size)
+        {
+            const __m128i one{_mm_set1_epi8(1)};
+            __m128i a{_mm_setzero_si128()};
+            for (u32 i{0u}; i < size; i += pixelSize)
+            {
+                const __m128i b{_loadPixel<pixelSize>(prev + i)};
+                // `_mm_avg_epu8` rounds up, so take off the carry of odd sums
+                const __m128i average{_mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one))};
+                a = _mm_add_epi8(_loadPixel<pixelSize>(row + i), average);
+                _storePixel<pixelSize>(row + i, a);
+            }
+        }
+
+        finline __m128i _select(const __m128i mask, const __m128i a, const __m128i b)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+
+        finline __m128i _abs16(const __m128i v)
+        {
+            return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+        }
+
+        // Predictor arithmetic is done in 16 bit lanes, as the differences need nine bits
+        template <u32 pixelSize>
+        void _unfilterPaethSimd(u8 * const row, const u8 * const prev, const u32 size)
+        {
+            const __m128i zero{_mm_setzero_si128()};
+            const __m128i byteMask{_mm_set1_epi16(0xFF)};
+            __m128i a{zero};
+            __m128i c{zero};
+            for (u32 i{0u}; i < size; i += pixelSize)
+            {
+                const __m128i b{_mm_unpacklo_epi8(_loadPixel<pixelSize>(prev + i), zero)};
+                const __m128i d{_mm_unpacklo_epi8(_loadPixel<pixelSize>(row + i), zero)};
+
+                // With p = a + b - c, |p - a| = |b - c|, |p - b| = |a - c|, and |p - c| = |b - c + a - c|
+                const __m128i pa{_mm_sub_epi16(b, c)};
+                const __m128i pb{_mm_sub_epi16(a, c)};
+                const __m128i pc{_abs16(_mm_add_epi16(pa, pb))};
+                const __m128i absPa{_abs16(pa)};
+                const __m128i absPb{_abs16(pb)};
+                const __m128i smallest{_mm_min_epi16(pc, _mm_min_epi16(absPa, absPb))};
+
+                const __m128i predictor{_select(_mm_cmpeq_epi16(absPa, smallest), a, _select(_mm_cmpeq_epi16(absPb, smallest), b, c))};
+
+                a = _mm_and_si128(_mm_add_epi16(d, predictor), byteMask);
+                _storePixel<pixelSize>(row + i, _mm_packus_epi16(a, a));
+                c = b;
+            }
+        }
+
+        #endif
+
+        // Reverses the row's filter in place, given the unfiltered previous row
+        bool _unfilter(const u8 filter, u8 * const row, const u8 * const prev, const u32 size, const u32 pixelSize)
+        {
+            #ifdef _QCI_PNG_SSE2
+            // Three and four byte pixels are the common 8 bit RGB and RGBA cases
+            if (pixelSize == 3u || pixelSize == 4u)
+            {
+                switch (filter)
+                {
+                    case 1u: pixelSize == 3u ? _unfilterSubSimd<3u>(row, size) : _unfilterSubSimd<4u>(row, size); return true;
+                    case 3u: pixelSize == 3u ? _unfilterAverageSimd<3u>(row, prev, size) : _unfilterAverageSimd<4u>(row, prev, size); return true;
+                    case 4u: pixelSize == 3u ? _unfilterPaethSimd<3u>(row, prev, size) : _unfilterPaethSimd<4u>(row, prev, size); return true;
+                    default: break;
+                }
+            }
+            #endif
+
+            switch (filter)
+            {
+                case 0u:
+                    break;
+                case 1u:
+                    for (u32 i{pixelSize}; i < size; ++i) row[i] = u8(row[i] + row[i - pixelSize]);
+                    break;
+                case 2u:
+                    // Independent per byte, so left for the compiler to vectorize
+                    for (u32 i{0u}; i < size; ++i) row[i] = u8(row[i] + prev[i]);
+                    break;
+                case 3u:
+                    for (u32 i{0u}; i < pixelSize; ++i) row[i] = u8(row[i] + (prev[i] >> 1));
+                    for (u32 i{pixelSize}; i < size; ++i) row[i] = u8(row[i] + ((u32(row[i - pixelSize]) + u32(prev[i])) >> 1));
+                    break;
+                case 4u:
+                    for (u32 i{0u}; i < pixelSize; ++i) row[i] = u8(row[i] + prev[i]);
+                    for (u32 i{pixelSize}; i < size; ++i) row[i] = u8(row[i] + _paeth(row[i - pixelSize], prev[i], prev[i - pixelSize]));
+                    break;
+                default:
+                    return false;
+            }
+
+            return true;
+        }
+
+        // Whether the file starts with a PNG header that asks for interlacing, which `PngReader` does not support
+        bool _isInterlaced(const std::filesystem::path & file)
+        {
+            // Signature, IHDR length and type, and the header data up to and including its interlace method
+            u8 start[29];
+            std::ifstream stream{file, std::ios::binary};
+            FAIL_IF(!stream.read(std::bit_cast<char *>(&start[0]), sizeof(start)));
+            FAIL_IF(std::memcmp(start, _pngSignature, 8) || _readU32BigEndian(start + 8) != 13u || std::memcmp(start + 12, "IHDR", 4));
+
+            return start[28] == 1u;
+        }
+    }
+
+    struct PngReader::_State
+    {
+        uivec2 size{};
+        u32 bitDepth{};
+        u32 colorType{};
+        // Components stored in the file, before palette expansion
+        u32 sampleN{};
+        // Components produced, after palette and transparency expansion
+        u32 componentN{};
+        u32 pixelSize{};
+        u32 rowSize{};
+
+        u8 palette[256][4]{};
+        bool hasTransparency{};
+        // Color key for gray and RGB images, in file bit depth
+        u16 transparentKey[3]{};
+
+        _Input input{};
+        _IdatSource source{input};
+        _Inflater inflater{source};
+
+        List<u8> row{};
+        List<u8> prevRow{};
+        u32 rowsRead{};
+
+        // Reads everything up to the first IDAT chunk's data from the already opened input
+        bool readHeader()
+        {
+            u8 signature[8];
+            FAIL_IF(!input.read(signature, 8u) || std::memcmp(signature, _pngSignature, 8));
+
+            bool hasHeader{false};
+            bool hasPalette{false};
+
+            while (true)
+            {
+                u8 chunkHeader[8];
+                FAIL_IF(!input.read(chunkHeader, 8u));
+                const u32 length{_readU32BigEndian(chunkHeader)};
+                const char * const type{std::bit_cast<const char *>(chunkHeader + 4)};
+
+                if (!std::memcmp(type, "IDAT", 4))
+                {
+                    FAIL_IF(!hasHeader);
+                    FAIL_IF(colorType == 3u && !hasPalette);
+                    source.chunkRemaining = length;
+                    break;
+                }
+
+                FAIL_IF(!std::memcmp(type, "IEND", 4));
+
+                const bool isHeader{!std::memcmp(type, "IHDR", 4)};
+                const bool isPalette{!std::memcmp(type, "PLTE", 4)};
+                const bool isTransparency{!std::memcmp(type, "tRNS", 4)};
+
+                if (!isHeader && !isPalette && !isTransparency)
+                {
+                    // Skip the data and CRC
+                    FAIL_IF(!input.skip(length) || !input.skip(4u));
+                    continue;
+                }
+
+                FAIL_IF(length > 256u * 3u);
+                u8 data[256u * 3u];
+                FAIL_IF(!input.read(data, length) || !input.skip(4u));
+
+                if (isHeader)
+                {
+                    FAIL_IF(hasHeader || length != 13u);
+                    hasHeader = true;
+
+                    size = uivec2{_readU32BigEndian(data), _readU32BigEndian(data + 4)};
+                    bitDepth = data[8];
+                    colorType = data[9];
+                    FAIL_IF(!size.x || !size.y);
+                    FAIL_IF(size.x > _maxDimension || size.y > _maxDimension);
+                    FAIL_IF(u64(size.x) * size.y > std::numeric_limits<u32>::max());
+                    // Compression and filter method must be 0, and interlacing is not supported
+                    FAIL_IF(data[10] || data[11] || data[12]);
+
+                    switch (colorType)
+                    {
+                        case 0u: sampleN = 1u; FAIL_IF(bitDepth != 1u && bitDepth != 2u && bitDepth != 4u && bitDepth != 8u && bitDepth != 16u); break;
+                        case 2u: sampleN = 3u; FAIL_IF(bitDepth != 8u && bitDepth != 16u); break;
+                        case 3u: sampleN = 1u; FAIL_IF(bitDepth != 1u && bitDepth != 2u && bitDepth != 4u && bitDepth != 8u); break;
+                        case 4u: sampleN = 2u; FAIL_IF(bitDepth != 8u && bitDepth != 16u); break;
+                        case 6u: sampleN = 4u; FAIL_IF(bitDepth != 8u && bitDepth != 16u); break;
+                        default: return false;
+                    }
+
+                    componentN = colorType == 3u ? 3u : sampleN;
+                }
+                else if (isPalette)
+                {
+                    FAIL_IF(!hasHeader || length % 3u || !length);
+                    hasPalette = true;
+
+                    for (u32 i{0u}; i < length / 3u; ++i)
+                    {
+                        palette[i][0] = data[i * 3u];
+                        palette[i][1] = data[i * 3u + 1u];
+                        palette[i][2] = data[i * 3u + 2u];
+                        palette[i][3] = 255u;
+                    }
+                }
+                else
+                {
+                    FAIL_IF(!hasHeader || colorType == 4u || colorType == 6u);
+                    // A second one would count the alpha component twice
+                    FAIL_IF(hasTransparency);
+                    hasTransparency = true;
+                    ++componentN;
+
+                    if (colorType == 3u)
+                    {
+                        FAIL_IF(!hasPalette || length > 256u);
+                        for (u32 i{0u}; i < length; ++i)
+                        {
+                            palette[i][3] = data[i];
+                        }
+                    }
+                    else
+                    {
+                        FAIL_IF(length != sampleN * 2u);
+                        for (u32 i{0u}; i < sampleN; ++i)
+                        {
+                            transparentKey[i] = u16((u32(data[i * 2u]) << 8) | data[i * 2u + 1u]);
+                        }
+                    }
+                }
+            }
+
+            pixelSize = max((sampleN * bitDepth) / 8u, 1u);
+            const u64 rowBytes{(u64(size.x) * sampleN * bitDepth + 7u) / 8u};
+            FAIL_IF(rowBytes > std::numeric_limits<u32>::max());
+            rowSize = u32(rowBytes);
+
+            row.resize(rowSize);
+            prevRow.resize(rowSize);
+            std::fill_n(prevRow.data(), rowSize, u8(0u));
+
+            FAIL_IF(!inflater.begin());
+
+            return true;
+        }
+
+        bool decodeRow()
+        {
+            FAIL_IF(rowsRead >= size.y);
+
+            std::swap(row, prevRow);
+
+            u8 filter;
+            FAIL_IF(!inflater.inflate(&filter, 1u));
+            FAIL_IF(!inflater.inflate(row.data(), rowSize));
+            FAIL_IF(!_unfilter(filter, row.data(), prevRow.data(), rowSize, pixelSize));
+
+            ++rowsRead;
+            return true;
+        }
+
+        // Sample `i` of the current row, at file bit depth
+        finline u32 sample(const u32 i) const
+        {
+            switch (bitDepth)
+            {
+                case 16u: return (u32(row[i * 2u]) << 8) | row[i * 2u + 1u];
+                case 8u: return row[i];
+                default:
+                {
+                    const u32 bit{i * bitDepth};
+                    return (row[bit / 8u] >> (8u - bitDepth - bit % 8u)) & ((1u << bitDepth) - 1u);
+                }
+            }
+        }
+
+        // Converts the current row's pixels in `[beginX, endX)` to `T` with `n` components, expanding as stb_image does
+        template <Numeric T, u32 n>
+        void convertRow(Pixel<T, n> * const dst, const u32 beginX, const u32 endX) const
+        {
+            constexpr u32 maxValue{std::numeric_limits<T>::max()};
+
+            // Scales a sample of the file bit depth to `T`
+            const auto scale{[this](const u32 v) -> T
+            {
+                if constexpr (sizeof(T) == 1u)
+                {
+                    return bitDepth == 16u ? T(v >> 8) : bitDepth == 8u ? T(v) : T(v * (255u / ((1u << bitDepth) - 1u)));
+                }
+                else
+                {
+                    return bitDepth == 16u ? T(v) : bitDepth == 8u ? T(v * 257u) : T(v * (65535u / ((1u << bitDepth) - 1u)));
+                }
+            }};
+
+            const auto scale8{[](const u32 v) -> T
+            {
+                if constexpr (sizeof(T) == 1u) return T(v);
+                else return T(v * 257u);
+            }};
+
+            // Plain 8 bit samples already are the pixels
+            if constexpr (sizeof(T) == 1u)
+            {
+                if (bitDepth == 8u && colorType != 3u && !hasTransparency && componentN == n)
+                {
+                    std::memcpy(dst, row.data() + beginX * n, (endX - beginX) * n);
+                    return;
+                }
+            }
+
+            T * out{std::bit_cast<T *>(dst)};
+            for (u32 x{beginX}; x < endX; ++x, out += n)
+            {
+                T components[4];
+
+                if (colorType == 3u)
+                {
+                    const u8 * const entry{palette[sample(x)]};
+                    for (u32 c{0u}; c < 4u; ++c) components[c] = scale8(entry[c]);
+                }
+                else
+                {
+                    bool isTransparent{hasTransparency};
+                    for (u32 c{0u}; c < sampleN; ++c)
+                    {
+                        const u32 v{sample(x * sampleN + c)};
+                        isTransparent = isTransparent && v == transparentKey[c];
+                        components[c] = scale(v);
+                    }
+                    if (hasTransparency)
+                    {
+                        components[sampleN] = isTransparent ? T(0u) : T(maxValue);
+                    }
+                }
+
+                // Expand the `componentN` file components to `n`
+                if (componentN == n)
+                {
+                    std::copy_n(components, n, out);
+                }
+                else if (componentN == 1u)
+                {
+                    for (u32 c{0u}; c < n; ++c) out[c] = components[0];
+                    if constexpr (n == 2u || n == 4u) out[n - 1u] = T(maxValue);
+                }
+                else if (componentN == 2u)
+                {
+                    // Gray alpha to RGB drops the alpha, as stb_image does
+                    for (u32 c{0u}; c < 3u && c < n; ++c) out[c] = components[0];
+                    if constexpr (n == 4u) out[3] = components[1];
+                }
+                else
+                {
+                    // RGB to RGBA
+                    std::copy_n(components, 3u, out);
+                    if constexpr (n == 4u) out[3] = T(maxValue);
+                }
+            }
+        }
+    };
+
+    PngReader::PngReader() = default;
+
+    PngReader::PngReader(PngReader && other) = default;
+
+    PngReader & PngReader::operator=(PngReader && other) = default;
+
+    PngReader::~PngReader() = default;
+
+    bool PngReader::open(const std::filesystem::path & file)
+    {
+        _state = std::make_unique<_State>();
+
+        if (!_state->input.openFile(file) || !_state->readHeader())
+        {
+            _state.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PngReader::open(const u8 * const data, const u64 size)
+    {
+        _state = std::make_unique<_State>();
+        _state->input.openMemory(data, size);
+
+        if (!_state->readHeader())
+        {
+            _state.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    uivec2 PngReader::size() const
+    {
+        return _state ? _state->size : uivec2{};
+    }
+
+    u32 PngReader::bitDepth() const
+    {
+        return _state ? _state->bitDepth : 0u;
+    }
+
+    u32 PngReader::componentN() const
+    {
+        return _state ? _state->componentN : 0u;
+    }
+
+    u32 PngReader::rowsRead() const
+    {
+        return _state ? _state->rowsRead : 0u;
+    }
+
+    template <Numeric T, u32 n>
+    bool PngReader::readRow(Pixel<T, n> * const dst, const u32 beginX, const u32 endX)
+    {
+        static_assert(std::is_same_v<T, u8> || std::is_same_v<T, u16>);
+
+        FAIL_IF(!_state || _state->componentN > n);
+        FAIL_IF(beginX > endX || endX > _state->size.x);
+        FAIL_IF(!_state->decodeRow());
+
+        _state->convertRow<T, n>(dst, beginX, endX);
+
+        return true;
+    }
+
+    bool PngReader::skipRow()
+    {
+        FAIL_IF(!_state);
+
+        return _state->decodeRow();
+    }
+
+    template <Numeric T, u32 n>
+    Result<Image<T, n>> readRegion(const std::filesystem::path & file, const ispan2 & region, const bool allowComponentPadding)
+    {
+        PngReader reader{};
+
+        if (!reader.open(file))
+        {
+            // Interlaced rows cannot be streamed, so such files are decoded whole, but anything else is a bad file
+            FAIL_IF(!_isInterlaced(file));
+
+            const Result<Image<T, n>> image{read<T, n>(file, allowComponentPadding)};
+            FAIL_IF(!image);
+
+            const ispan2 clipped{region & ispan2{ivec2{}, ivec2(image->size())}};
+            FAIL_IF(clipped.min.x >= clipped.max.x || clipped.min.y >= clipped.max.y);
+
+            Image<T, n> cropped{uivec2(clipped.size())};
+            cropped.view().copy(image->view(clipped.min, uivec2(clipped.size())));
+            return cropped;
+        }
+
+        const uivec2 size{reader.size()};
+        const u32 componentN{reader.componentN()};
+        FAIL_IF(componentN > n || (!allowComponentPadding && componentN < n));
+
+        const ispan2 clipped{region & ispan2{ivec2{}, ivec2(size)}};
+        FAIL_IF(clipped.min.x >= clipped.max.x || clipped.min.y >= clipped.max.y);
+
+        Image<T, n> image{uivec2(clipped.size())};
+
+        // Rows come from the top, so the region's top row is reached first
+        const u32 beginRow{size.y - u32(clipped.max.y)};
+        const u32 endRow{size.y - u32(clipped.min.y)};
+
+        for (u32 i{0u}; i < beginRow; ++i)
+        {
+            FAIL_IF(!reader.skipRow());
+        }
+
+        for (u32 i{beginRow}; i < endRow; ++i)
+        {
+            const s32 y{s32(size.y - 1u - i) - clipped.min.y};
+            FAIL_IF(!(reader.readRow<T, n>(image.row(y), u32(clipped.min.x), u32(clipped.max.x))));
+        }
+
+        return image;
+    }
+
+    template <Numeric T, u32 n>
+    Result<Image<T, n>> decodePng(const u8 * const data, const u64 size, const bool allowComponentPadding)
+    {
+        PngReader reader{};
+        FAIL_IF(!reader.open(data, size));
+        FAIL_IF(reader.bitDepth() != 8u);
+
+        const uivec2 imageSize{reader.size()};
+        const u32 componentN{reader.componentN()};
+        FAIL_IF(componentN > n || (!allowComponentPadding && componentN < n));
+
+        Image<T, n> image{imageSize};
+
+        // Memory rows run from the top, as the file's do
+        for (u32 i{0u}; i < imageSize.y; ++i)
+        {
+            FAIL_IF(!(reader.readRow<T, n>(image.pixels() + u64(i) * imageSize.x, 0u, imageSize.x)));
+        }
+
+        return image;
+    }
+
+    // Explicit template specialization
+
+    template bool PngReader::readRow<u8, 1u>(Pixel<u8, 1u> *, u32, u32);
+    template bool PngReader::readRow<u8, 2u>(Pixel<u8, 2u> *, u32, u32);
+    template bool PngReader::readRow<u8, 3u>(Pixel<u8, 3u> *, u32, u32);
+    template bool PngReader::readRow<u8, 4u>(Pixel<u8, 4u> *, u32, u32);
+    template bool PngReader::readRow<u16, 1u>(Pixel<u16, 1u> *, u32, u32);
+    template bool PngReader::readRow<u16, 2u>(Pixel<u16, 2u> *, u32, u32);
+    template bool PngReader::readRow<u16, 3u>(Pixel<u16, 3u> *, u32, u32);
+    template bool PngReader::readRow<u16, 4u>(Pixel<u16, 4u> *, u32, u32);
+
+    template Result<Image<u8, 1u>> readRegion<u8, 1u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u8, 2u>> readRegion<u8, 2u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u8, 3u>> readRegion<u8, 3u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u8, 4u>> readRegion<u8, 4u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u16, 1u>> readRegion<u16, 1u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u16, 2u>> readRegion<u16, 2u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u16, 3u>> readRegion<u16, 3u>(const std::filesystem::path &, const ispan2 &, bool);
+    template Result<Image<u16, 4u>> readRegion<u16, 4u>(const std::filesystem::path &, const ispan2 &, bool);
+
+    template Result<Image<u8, 1u>> decodePng<u8, 1u>(const u8 *, u64, bool);
+    template Result<Image<u8, 2u>> decodePng<u8, 2u>(const u8 *, u64, bool);
+    template Result<Image<u8, 3u>> decodePng<u8, 3u>(const u8 *, u64, bool);
+    template Result<Image<u8, 4u>> decodePng<u8, 4u>(const u8 *, u64, bool);
+}
@@ -1,60 +1,110 @@
 #include <qc-image/sdf.hpp>
 
+#include <chrono>
+
 #include <qc-core/math.hpp>
 
+#include <qc-image/parallel.hpp>
+
 namespace qci::sdf
 {
     namespace
     {
-        struct _LineExt
-        {
-            fvec2 a;
-            f32 invLength2;
-        };
-
-        struct _CurveExt
-        {
-            fvec2 a;
-            fvec2 b;
-            fvec2 c;
-            f32 maxHalfSubLineLength;
-        };
-
-        union _SegmentExt
+        // Where a contour crosses a row's center, and whether it was heading up, 1, or down, -1, or was level, 0
+        struct _Intercept
         {
-            _LineExt line;
-            _CurveExt curve;
+            f32 x;
+            s32 winding;
         };
 
         struct _Row
         {
             f32 * distances;
             u32 interceptN;
-            f32 * intercepts;
+            _Intercept * intercepts;
         };
 
+        using _Clock = std::chrono::steady_clock;
+
+        // Stats for the current `generate` call on this thread. Only touched if `statsEnabled`
+        thread_local GenerateStats _stats{};
+
+        // Adds the time since `start` to `seconds` and returns the current time
+        _Clock::time_point _lap(const _Clock::time_point start, f64 & seconds)
+        {
+            const _Clock::time_point now{_Clock::now()};
+            seconds += std::chrono::duration<f64>(now - start).count();
+            return now;
+        }
+
         bool _isPointValid(const fvec2 p)
         {
             // Must not be NaN or too big
             return abs(p.x) <= 1.0e9f && abs(p.y) <= 1.0e9f;
         }
 
-        fvec2 _evaluateBezier(const _CurveExt & curve, const f32 t)
+        fvec2 _evaluateBezier(const detail::CurveExt & curve, const f32 t)
         {
             return curve.a * t * t + curve.b * t + curve.c;
         }
 
-        fvec2 _evaluateBezier(const _CurveExt & curve, const fvec2 t)
+        fvec2 _evaluateBezier(const detail::CurveExt & curve, const fvec2 t)
         {
             return curve.a * t * t + curve.b * t + curve.c;
         }
 
+        fvec2 _evaluateBezier(const detail::CubicExt & cubic, const f32 t)
+        {
+            return ((cubic.a * t + cubic.b) * t + cubic.c) * t + cubic.d;
+        }
+
+        // Real roots of `a*t^3 + b*t^2 + c*t + d`, written to `roots`. Falls back to quadratic if `a` is negligible
+        u32 _cubicRoots(const f32 a, const f32 b, const f32 c, const f32 d, f32 * const roots)
+        {
+            if (abs(a) <= 1.0e-6f * (abs(b) + abs(c) + abs(d)))
+            {
+                u32 rootN{0u};
+                for (const f32 t : quadraticRoots(b, c, d))
+                {
+                    if (t == t) roots[rootN++] = t;
+                }
+                return rootN;
+            }
+
+            // Trigonometric or Cardano solution of the normalized cubic, in double for stability
+            const f64 nb{f64(b) / f64(a)};
+            const f64 nc{f64(c) / f64(a)};
+            const f64 nd{f64(d) / f64(a)};
+            const f64 q{(nb * nb - 3.0 * nc) / 9.0};
+            const f64 r{(2.0 * nb * nb * nb - 9.0 * nb * nc + 27.0 * nd) / 54.0};
+            const f64 q3{q * q * q};
+            const f64 offset{nb / 3.0};
+
+            if (r * r < q3)
+            {
+                const f64 theta{std::acos(std::clamp(r / std::sqrt(q3), -1.0, 1.0))};
+                const f64 scale{-2.0 * std::sqrt(q)};
+                constexpr f64 twoPi{6.283185307179586};
+                roots[0] = f32(scale * std::cos(theta / 3.0) - offset);
+                roots[1] = f32(scale * std::cos((theta + twoPi) / 3.0) - offset);
+                roots[2] = f32(scale * std::cos((theta - twoPi) / 3.0) - offset);
+                return 3u;
+            }
+            else
+            {
+                const f64 u{-std::copysign(std::cbrt(std::abs(r) + std::sqrt(r * r - q3)), r)};
+                const f64 v{u == 0.0 ? 0.0 : q / u};
+                roots[0] = f32(u + v - offset);
+                return 1u;
+            }
+        }
+
         fspan2 _detSpan(const Line & line)
         {
             return {min(line.p1, line.p2), max(line.p1, line.p2)};
         }
 
-        fspan2 _detSpan(const Curve & curve, const _CurveExt & curveExt)
+        fspan2 _detSpan(const Curve & curve, const detail::CurveExt & curveExt)
         {
             fspan2 span{min(curve.p1, curve.p3), max(curve.p1, curve.p3)};
 
@@ -69,12 +119,25 @@ namespace qci::sdf
             return span;
         }
 
-        fspan2 _detSpan(const Segment & segment, const _SegmentExt & segmentExt)
+        fspan2 _detSpan(const Cubic & cubic, const detail::CubicExt & cubicExt)
         {
-            return segment.isCurve ? _detSpan(segment.curve, segmentExt.curve) : _detSpan(segment.line);
+            fspan2 span{min(cubic.p1, cubic.p4), max(cubic.p1, cubic.p4)};
+
+            if (!span.contains(cubic.p2) || !span.contains(cubic.p3))
+            {
+                // The piece bounds include all extrema
+                for (u32 i{1u}; i < cubicExt.pieceN; ++i)
+                {
+                    const fvec2 p{_evaluateBezier(cubicExt, cubicExt.pieceTs[i])};
+                    minify(span.min, p);
+                    maxify(span.max, p);
+                }
+            }
+
+            return span;
         }
 
-        f32 _distance2To(const Line & line, const _LineExt & lineExt, const fvec2 p)
+        f32 _distance2To(const Line & line, const detail::LineExt & lineExt, const fvec2 p)
         {
             const fvec2 b{p - line.p1};
             const f32 t{clamp(dot(lineExt.a, b) * lineExt.invLength2, 0.0f, 1.0f)};
@@ -82,7 +145,15 @@ namespace qci::sdf
             return distance2(b, c);
         }
 
-        f32 _findClosestPoint(const _CurveExt & curve, const fvec2 p, f32 lowT, f32 highT)
+        // Short chord of the curve around the point closest to `p`
+        struct _ClosestSpan
+        {
+            f32 lowT, highT;
+            fvec2 lowB, highB;
+        };
+
+        template <typename CurveExt>
+        _ClosestSpan _findClosestSpan(const CurveExt & curve, const fvec2 p, f32 lowT, f32 highT)
         {
             f32 midT{(lowT + highT) * 0.5f};
             fvec2 lowB{_evaluateBezier(curve, lowT)};
@@ -94,8 +165,12 @@ namespace qci::sdf
             f32 minDist2{min(min(lowDist2, midDist2), highDist2)};
             f32 halfLength{(highT - lowT) * 0.5f};
 
+            if constexpr (statsEnabled) ++_stats.closestPointSearchN;
+
             while (halfLength > curve.maxHalfSubLineLength)
             {
+                if constexpr (statsEnabled) ++_stats.closestPointIterationN;
+
                 halfLength *= 0.5f;
 
                 const f32 t1{midT - halfLength};
@@ -136,10 +211,17 @@ namespace qci::sdf
                 }
             }
 
-            return distance2ToLine(lowB, highB, p);
+            return _ClosestSpan{.lowT = lowT, .highT = highT, .lowB = lowB, .highB = highB};
+        }
+
+        template <typename CurveExt>
+        f32 _findClosestPoint(const CurveExt & curve, const fvec2 p, const f32 lowT, const f32 highT)
+        {
+            const _ClosestSpan span{_findClosestSpan(curve, p, lowT, highT)};
+            return distance2ToLine(span.lowB, span.highB, p);
         }
 
-        f32 _distance2To(const Curve &, const _CurveExt & curveExt, const fvec2 p)
+        f32 _distance2To(const Curve &, const detail::CurveExt & curveExt, const fvec2 p)
         {
             // Point of maximum curvature
             const f32 d{-2.0f * magnitude2(curveExt.a)};
@@ -160,15 +242,33 @@ namespace qci::sdf
             return dist2;
         }
 
-        f32 _distance2To(const Segment & segment, const _SegmentExt & segmentExt, const fvec2 p)
+        f32 _distance2To(const Cubic &, const detail::CubicExt & cubicExt, const fvec2 p)
         {
-            return segment.isCurve ? _distance2To(segment.curve, segmentExt.curve, p) : _distance2To(segment.line, segmentExt.line, p);
+            // Each piece is free of extrema and inflections, so has a single closest point
+            f32 dist2{number::inf<f32>};
+
+            for (u32 i{0u}; i < cubicExt.pieceN; ++i)
+            {
+                minify(dist2, _findClosestPoint(cubicExt, p, cubicExt.pieceTs[i], cubicExt.pieceTs[i + 1u]));
+            }
+
+            return dist2;
         }
 
-        void _updateDistances(const Segment & segment, const _SegmentExt & segmentExt, const u32 size, const f32 halfRange, _Row * const rows, const fspan2 bounds)
+        template <typename S, typename Ext>
+        void _updateDistances(const S & segment, const Ext & segmentExt, const u32 size, const f32 halfRange, _Row * const rows, const fspan2 bounds)
         {
             const ispan2 pixelBounds{max(floor<s32>(bounds.min - halfRange), 0), min(ceil<s32>(bounds.max + halfRange), s32(size))};
 
+            if constexpr (statsEnabled)
+            {
+                const ivec2 extent{max(pixelBounds.size(), 0)};
+                const u64 pixelN{u64(extent.x) * u64(extent.y)};
+                if constexpr (std::is_same_v<S, Line>) _stats.linePixelN += pixelN;
+                else if constexpr (std::is_same_v<S, Curve>) _stats.curvePixelN += pixelN;
+                else _stats.cubicPixelN += pixelN;
+            }
+
             for (ivec2 p{pixelBounds.min}; p.y < pixelBounds.max.y; ++p.y)
             {
                 _Row & row{rows[p.y]};
@@ -180,7 +280,7 @@ namespace qci::sdf
             }
         }
 
-        void _updateIntercepts(const Line & line, const _LineExt &, _Row * const rows, const ispan1 & interceptRows)
+        void _updateIntercepts(const Line & line, const detail::LineExt &, _Row * const rows, const ispan1 & interceptRows)
         {
             // Perfectly horizontal line has no intercepts
             if (line.p1.y == line.p2.y)
@@ -191,6 +291,7 @@ namespace qci::sdf
             const fvec2 delta{line.p2 - line.p1};
             const f32 slope{delta.x / delta.y};
             const f32 offset{line.p1.x - slope * line.p1.y};
+            const s32 winding{delta.y > 0.0f ? 1 : -1};
 
             for (s32 yPx{interceptRows.min}; yPx <= interceptRows.max; ++yPx)
             {
@@ -203,12 +304,12 @@ namespace qci::sdf
                 // Explicitly disallow endpoint intercepts
                 if (intercept != line.p1 && intercept != line.p2)
                 {
-                    row.intercepts[row.interceptN++] = intercept.x;
+                    row.intercepts[row.interceptN++] = _Intercept{.x = intercept.x, .winding = winding};
                 }
             }
         }
 
-        void _updateIntercepts(const Curve & curve, const _CurveExt & curveExt, _Row * const rows, const ispan1 & interceptRows)
+        void _updateIntercepts(const Curve & curve, const detail::CurveExt & curveExt, _Row * const rows, const ispan1 & interceptRows)
         {
             for (s32 yPx{interceptRows.min}; yPx <= interceptRows.max; ++yPx)
             {
@@ -227,376 +328,2259 @@ namespace qci::sdf
                         // Explicitly disallow endpoint intercepts
                         if (intercept != curve.p1 && intercept != curve.p2)
                         {
-                            row.intercepts[row.interceptN++] = intercept.x;
+                            const f32 dy{2.0f * curveExt.a.y * t + curveExt.b.y};
+                            row.intercepts[row.interceptN++] = _Intercept{.x = intercept.x, .winding = (dy > 0.0f) - (dy < 0.0f)};
                         }
                     }
                 }
             }
         }
 
-        void _updateIntercepts(const Segment & segment, const _SegmentExt & segmentExt, _Row * const rows, const ispan1 & interceptRows)
+        void _updateIntercepts(const Cubic & cubic, const detail::CubicExt & cubicExt, _Row * const rows, const ispan1 & interceptRows)
         {
-            return segment.isCurve ?
-                _updateIntercepts(segment.curve, segmentExt.curve, rows, interceptRows) :
-                _updateIntercepts(segment.line, segmentExt.line, rows, interceptRows);
+            for (s32 yPx{interceptRows.min}; yPx <= interceptRows.max; ++yPx)
+            {
+                _Row & row{rows[yPx]};
+
+                const f32 y{f32(yPx) + 0.5f};
+
+                f32 roots[3];
+                const u32 rootN{_cubicRoots(cubicExt.a.y, cubicExt.b.y, cubicExt.c.y, cubicExt.d.y - y, roots)};
+
+                for (u32 i{0u}; i < rootN; ++i)
+                {
+                    const f32 t{roots[i]};
+                    if (t > 0.0f && t < 1.0f)
+                    {
+                        const fvec2 intercept{_evaluateBezier(cubicExt, t)};
+
+                        // Explicitly disallow endpoint intercepts
+                        if (intercept != cubic.p1 && intercept != cubic.p4)
+                        {
+                            const f32 dy{(3.0f * cubicExt.a.y * t + 2.0f * cubicExt.b.y) * t + cubicExt.c.y};
+                            row.intercepts[row.interceptN++] = _Intercept{.x = intercept.x, .winding = (dy > 0.0f) - (dy < 0.0f)};
+                        }
+                    }
+                }
+            }
         }
 
-        _LineExt _calcExtra(const Line & line)
+        detail::LineExt _calcExtra(const Line & line)
         {
-            return _LineExt{
+            return detail::LineExt{
                 .a = line.p2 - line.p1,
                 .invLength2 = 1.0f / distance2(line.p1, line.p2)};
         }
 
-        _CurveExt _calcExtra(const Curve & curve)
+        detail::CurveExt _calcExtra(const Curve & curve)
         {
-            return _CurveExt{
+            return detail::CurveExt{
                 .a = curve.p1 - 2.0f * curve.p2 + curve.p3,
                 .b = 2.0f * (curve.p2 - curve.p1),
                 .c = curve.p1,
                 .maxHalfSubLineLength = 1.0f / (distance(curve.p1, curve.p2) + distance(curve.p2, curve.p3))};
         }
 
-        _SegmentExt _calcExtra(const Segment & segment)
+        detail::CubicExt _calcExtra(const Cubic & cubic)
         {
-            if (segment.isCurve)
-            {
-                return {.curve = _calcExtra(segment.curve)};
-            }
-            else
+            detail::CubicExt ext{
+                .a = 3.0f * (cubic.p2 - cubic.p3) + cubic.p4 - cubic.p1,
+                .b = 3.0f * (cubic.p1 - 2.0f * cubic.p2 + cubic.p3),
+                .c = 3.0f * (cubic.p2 - cubic.p1),
+                .d = cubic.p1,
+                .maxHalfSubLineLength = 1.0f / (distance(cubic.p1, cubic.p2) + distance(cubic.p2, cubic.p3) + distance(cubic.p3, cubic.p4)),
+                .pieceN = 0u,
+                .pieceTs = {}};
+
+            u32 tN{0u};
+            ext.pieceTs[tN++] = 0.0f;
+
+            const auto addTs{[&](const Duo<f32> ts)
             {
-                return {.line = _calcExtra(segment.line)};
-            }
-        }
+                for (const f32 t : ts)
+                {
+                    if (t > 0.0f && t < 1.0f) ext.pieceTs[tN++] = t;
+                }
+            }};
 
-        void _process(const Segment & segment, const u32 size, const f32 halfRange, _Row * const rows)
-        {
-            const _SegmentExt segmentExt{_calcExtra(segment)};
+            // Extrema, where the derivative is zero in x or y
+            addTs(quadraticRoots(3.0f * ext.a.x, 2.0f * ext.b.x, ext.c.x));
+            addTs(quadraticRoots(3.0f * ext.a.y, 2.0f * ext.b.y, ext.c.y));
 
-            const fspan2 bounds{_detSpan(segment, segmentExt)};
+            // Inflections, where the first and second derivatives are parallel
+            addTs(quadraticRoots(-3.0f * cross(ext.a, ext.b), 3.0f * cross(ext.c, ext.a), cross(ext.c, ext.b)));
 
-            _updateDistances(segment, segmentExt, size, halfRange, rows, bounds);
+            std::sort(ext.pieceTs + 1, ext.pieceTs + tN);
+            ext.pieceTs[tN++] = 1.0f;
+            ext.pieceN = tN - 1u;
 
+            return ext;
+        }
+
+        // Adds intercepts for the rows within `rowLimits`, inclusive, whose centers the segment may cross, excluding those it only touches at its bounds
+        template <typename S, typename Ext>
+        void _addIntercepts(const S & segment, const Ext & segmentExt, const fspan2 & bounds, const ispan1 & rowLimits, _Row * const rows)
+        {
             ispan1 interceptRows{ceil<s32>(bounds.min.y - 0.5f), floor<s32>(bounds.max.y - 0.5f)};
             if (f32(interceptRows.min) + 0.5f == bounds.min.y) ++interceptRows.min;
             if (f32(interceptRows.max) + 0.5f == bounds.max.y) --interceptRows.max;
-            clampify(interceptRows, 0, s32(size) - 1);
+            // Intersected rather than clamped, as a segment entirely outside the limits must not be extrapolated onto the nearest row
+            interceptRows.min = max(interceptRows.min, rowLimits.min);
+            interceptRows.max = min(interceptRows.max, rowLimits.max);
             if (interceptRows.max >= interceptRows.min)
             {
                 _updateIntercepts(segment, segmentExt, rows, interceptRows);
             }
         }
 
-        void _updatePointIntercepts(const Contour & contour, _Row * const rows, const u32 size)
+        template <typename S, typename Ext>
+        void _addIntercepts(const S & segment, const Ext & segmentExt, const fspan2 & bounds, const u32 size, _Row * const rows)
         {
-            struct Point { fvec2 p; f32 prevY, nextY; };
-            static thread_local List<Point> points;
-
-            points.resize(contour.segments.size());
+            _addIntercepts(segment, segmentExt, bounds, ispan1{0, s32(size) - 1}, rows);
+        }
 
-            for (u32 i{0u}, endI{contour.segments.size()}; i < endI; ++i)
-            {
-                u32 nextI{i + 1u};
-                if (nextI == endI) nextI = 0u;
+        // Sorts the row's intercepts and calls `func` with each inside span of pixels, inclusive
+        template <typename F>
+        void _forInsideSpans(_Row & row, const u32 size, const FillRule fillRule, F && func)
+        {
+            std::sort(row.intercepts, row.intercepts + row.interceptN, [](const _Intercept & a, const _Intercept & b) { return a.x < b.x; });
 
-                const Segment & segment{contour.segments[i]};
-                Point & point{points[i]};
-                Point & nextPoint{points[nextI]};
+            if constexpr (statsEnabled) _stats.interceptN += row.interceptN;
 
-                if (segment.isCurve)
-                {
-                    point.p = segment.curve.p1;
-                    point.nextY = segment.curve.p2.y == segment.curve.p1.y ? segment.curve.p3.y : segment.curve.p2.y;
-                    nextPoint.prevY = segment.curve.p2.y == segment.curve.p3.y ? segment.curve.p1.y : segment.curve.p2.y;
-                }
-                else
+            const auto span{[size, &func](const f32 beginX, const f32 endX)
+            {
+                ispan1 xSpanPx{ceil<s32>(beginX - 0.5f), floor<s32>(endX - 0.5f)};
+                clampify(xSpanPx, 0, s32(size) - 1);
+                if (xSpanPx.max >= xSpanPx.min)
                 {
-                    point.p = segment.line.p1;
-                    point.nextY = segment.line.p2.y;
-                    nextPoint.prevY = segment.line.p1.y;
+                    func(xSpanPx.min, xSpanPx.max);
                 }
-            }
+            }};
 
-            // Remove consecutive points on same y value
-            for (u32 i{0u}; i < points.size(); ++i)
+            // Crossings should always pair up, leaving the row outside past the last
+            bool isClosed;
+
+            if (fillRule == FillRule::evenOdd)
             {
-                Point & point{points[i]};
-                if (point.p.y == point.prevY)
+                isClosed = !(row.interceptN % 2u);
+                const u32 interceptN{row.interceptN - !isClosed};
+
+                for (u32 i{1u}; i < interceptN; i += 2u)
                 {
-                    Point & prevPoint{points[(i + points.size() - 1u) % points.size()]};
-                    Point & nextPoint{points[(i + 1u) % points.size()]};
-                    prevPoint.nextY = point.nextY;
-                    nextPoint.prevY = point.prevY;
-                    points.erase(points.begin() + i);
-                    --i;
+                    span(row.intercepts[i - 1u].x, row.intercepts[i].x);
                 }
             }
-
-            for (const Point & point : points)
+            else
             {
-                if (point.p.y > 0.0f)
+                // Inside wherever the windings so far sum to anything but zero
+                s32 winding{0};
+                f32 beginX{};
+                for (u32 i{0u}; i < row.interceptN; ++i)
                 {
-                    const auto [f, i]{fract_i<s32>(point.p.y)};
-                    if (f == 0.5f && i < s32(size))
+                    const _Intercept & intercept{row.intercepts[i]};
+                    const s32 prevWinding{winding};
+                    winding += intercept.winding;
+                    if (!prevWinding && winding)
                     {
-                        // Only an intersection if the adjacent points are on opposite sides of the scanline
-                        if ((point.prevY < point.p.y && point.nextY > point.p.y) || (point.prevY > point.p.y && point.nextY < point.p.y))
-                        {
-                            _Row & row{rows[i]};
-                            row.intercepts[row.interceptN++] = point.p.x;
-                        }
+                        beginX = intercept.x;
+                    }
+                    else if (prevWinding && !winding)
+                    {
+                        span(beginX, intercept.x);
                     }
                 }
+
+                isClosed = !winding;
+            }
+
+            if (!isClosed)
+            {
+                if constexpr (statsEnabled) ++_stats.oddInterceptRowN;
+
+                if constexpr (debug) ABORT();
             }
         }
-    }
 
-    bool Line::isValid() const
-    {
-        return _isPointValid(p1) && _isPointValid(p2) && p1 != p2;
-    }
+        template <typename S, typename Ext>
+        void _process(const S & segment, const Ext & segmentExt, const fspan2 & bounds, const u32 size, const f32 halfRange, _Row * const rows)
+        {
+            _Clock::time_point time;
+            if constexpr (statsEnabled) time = _Clock::now();
 
-    bool Curve::isValid() const
-    {
-        return _isPointValid(p1) && _isPointValid(p2) && _isPointValid(p3) && p1 != p2 && p2 != p3 && p3 != p1;
-    }
+            _updateDistances(segment, segmentExt, size, halfRange, rows, bounds);
 
-    bool Segment::isValid() const
-    {
-        return isCurve ? curve.isValid() : line.isValid();
-    }
+            if constexpr (statsEnabled) time = _lap(time, _stats.distanceSeconds);
 
-    bool Contour::isValid() const
-    {
-        if (segments.size() < 2u)
-        {
-            return false;
+            _addIntercepts(segment, segmentExt, bounds, size, rows);
+
+            if constexpr (statsEnabled) _lap(time, _stats.interceptSeconds);
         }
 
-        // All segments must be themselves valid
-        for (const Segment & segment : segments)
+        // Scratch for one band of sparse tiles
+        struct _SparseBand
         {
-            if (!segment.isValid())
+            // Per tile in the band, index of its distances in units of `SparseSdf::tilePixelN`, or `_noSlot` if no segment is near
+            List<u32> slots;
+            List<f32> distances;
+            List<_Intercept> intercepts;
+        };
+
+        constexpr u32 _noSlot{~0u};
+
+        // Gets the tile's distances, creating them if this is the first segment near the tile
+        f32 * _bandSlot(_SparseBand & band, const u32 tileX)
+        {
+            u32 & slot{band.slots[tileX]};
+            if (slot == _noSlot)
             {
-                return false;
+                slot = band.distances.size() / SparseSdf::tilePixelN;
+                band.distances.resize(band.distances.size() + SparseSdf::tilePixelN);
+                std::fill_n(band.distances.end() - SparseSdf::tilePixelN, SparseSdf::tilePixelN, number::inf<f32>);
             }
+
+            return band.distances.data() + u64(slot) * SparseSdf::tilePixelN;
         }
 
-        // Each segment must connect to the next
-        for (u32 i{1u}; i < segments.size(); ++i)
+        // Same as `_updateDistances`, but limited to the band starting at row `bandY`, and into per tile distances
+        template <typename S, typename Ext>
+        void _updateBandDistances(const S & segment, const Ext & segmentExt, const fspan2 & bounds, const u32 size, const f32 halfRange, const s32 bandY, _SparseBand & band)
         {
-            const Segment & segment1{segments[i - 1u]};
-            const Segment & segment2{segments[i]};
-            const fvec2 p1{segment1.isCurve ? segment1.curve.p3 : segment1.line.p2};
-            const fvec2 p2{segment2.isCurve ? segment2.curve.p1 : segment2.line.p1};
-            if (p1 != p2)
+            constexpr s32 tileSize{s32(SparseSdf::tileSize)};
+
+            ispan2 pixelBounds{max(floor<s32>(bounds.min - halfRange), 0), min(ceil<s32>(bounds.max + halfRange), s32(size))};
+            maxify(pixelBounds.min.y, bandY);
+            minify(pixelBounds.max.y, bandY + tileSize);
+
+            if (pixelBounds.min.x >= pixelBounds.max.x || pixelBounds.min.y >= pixelBounds.max.y)
             {
-                return false;
+                return;
+            }
+
+            // A tile whose center is further than this from the segment has no pixel within half the range, and is not crossed by it
+            // The margin over half the tile's diagonal covers the closest point search's error
+            const f32 cullDistance{halfRange + f32(tileSize) * 0.75f};
+            const f32 cullDistance2{cullDistance * cullDistance};
+
+            for (s32 tileX{pixelBounds.min.x / tileSize}; tileX <= (pixelBounds.max.x - 1) / tileSize; ++tileX)
+            {
+                const s32 tileBeginX{tileX * tileSize};
+
+                if (_distance2To(segment, segmentExt, fvec2{f32(tileBeginX), f32(bandY)} + f32(tileSize) * 0.5f) >= cullDistance2)
+                {
+                    continue;
+                }
+
+                f32 * const tileDistances{_bandSlot(band, u32(tileX))};
+                const s32 beginX{max(pixelBounds.min.x, tileBeginX)};
+                const s32 endX{min(pixelBounds.max.x, tileBeginX + tileSize)};
+
+                for (ivec2 p{beginX, pixelBounds.min.y}; p.y < pixelBounds.max.y; ++p.y)
+                {
+                    f32 * const rowDistances{tileDistances + (p.y - bandY) * tileSize};
+
+                    for (p.x = beginX; p.x < endX; ++p.x)
+                    {
+                        minify(rowDistances[p.x - tileBeginX], _distance2To(segment, segmentExt, fvec2(p) + 0.5f));
+                    }
+                }
             }
         }
 
-        // Last segment must connect to the first
+        template <typename S, typename Ext>
+        void _processBand(const S & segment, const Ext & segmentExt, const fspan2 & bounds, const u32 size, const f32 halfRange, const s32 bandY, _SparseBand & band, _Row * const rows)
         {
-            const Segment & segment1{segments.back()};
-            const Segment & segment2{segments.front()};
-            const fvec2 p1{segment1.isCurve ? segment1.curve.p3 : segment1.line.p2};
-            const fvec2 p2{segment2.isCurve ? segment2.curve.p1 : segment2.line.p1};
-            if (p1 != p2)
+            _updateBandDistances(segment, segmentExt, bounds, size, halfRange, bandY, band);
+            _addIntercepts(segment, segmentExt, bounds, ispan1{bandY, min(bandY + s32(SparseSdf::tileSize), s32(size)) - 1}, rows);
+        }
+
+        // Band rows are those within half the range of the bounds, which includes every row the segment can have intercepts in
+        ispan1 _bandSpan(const fspan2 & bounds, const u32 size, const f32 halfRange)
+        {
+            const s32 beginY{max(floor<s32>(bounds.min.y - halfRange), 0)};
+            const s32 endY{min(ceil<s32>(bounds.max.y + halfRange), s32(size))};
+            return endY > beginY ? ispan1{beginY / s32(SparseSdf::tileSize), (endY - 1) / s32(SparseSdf::tileSize)} : ispan1{0, -1};
+        }
+
+        // Squared distance stand-in for "no feature". Finite so the transform arithmetic never produces NaN
+        constexpr f32 _edtInf{1.0e20f};
+
+        // Max columns processed at a time by the column pass of the distance transform
+        constexpr u32 _edtStripWidth{16u};
+
+        // Max bytes of distance buffers kept between calls. Larger ones are freed once done
+        constexpr u64 _edtRetainedByteN{u64(1u) << 22};
+
+        // One dimensional squared euclidean distance transform of `f` into `d`, from Felzenszwalb & Huttenlocher
+        // `v` must hold `n` elements and `z` must hold `n + 1`
+        // Parabola intersections are in f64, as they subtract squares of positions, which f32 stops holding exactly past 4096
+        void _edt(const f32 * const f, f32 * const d, const u32 n, u32 * const v, f64 * const z)
+        {
+            u32 k{0u};
+            v[0] = 0u;
+            z[0] = -number::inf<f64>;
+            z[1] = number::inf<f64>;
+
+            for (u32 q{1u}; q < n; ++q)
             {
-                return false;
+                const f64 fq{f64(f[q]) + f64(q) * f64(q)};
+                f64 s;
+                while (true)
+                {
+                    const f64 vk{f64(v[k])};
+                    s = (fq - (f64(f[v[k]]) + vk * vk)) / (2.0 * (f64(q) - vk));
+                    if (s > z[k]) break;
+                    --k;
+                }
+                ++k;
+                v[k] = q;
+                z[k] = s;
+                z[k + 1u] = number::inf<f64>;
+            }
+
+            k = 0u;
+            for (u32 q{0u}; q < n; ++q)
+            {
+                while (z[k + 1u] < f64(q)) ++k;
+                const f64 delta{f64(q) - f64(v[k])};
+                d[q] = f32(delta * delta + f64(f[v[k]]));
             }
         }
 
-        return true;
-    }
+        // Accumulates the signed area of a line into a row-major buffer, after the algorithm from font-rs
+        // X coordinates must be within `[0, width]`, and rows must have room for two extra accumulators
+        void _accumulateLine(f32 * const acc, const u32 pitch, const u32 width, const u32 height, fvec2 p1, fvec2 p2)
+        {
+            if (p1.y == p2.y)
+            {
+                return;
+            }
 
-    void Contour::normalize()
-    {
-        segments.eraseIf(
-            [](Segment & segment)
+            f32 dir{1.0f};
+            if (p1.y > p2.y)
+            {
+                std::swap(p1, p2);
+                dir = -1.0f;
+            }
+
+            const f32 maxX{f32(width)};
+            const f32 dxdy{(p2.x - p1.x) / (p2.y - p1.y)};
+            f32 x{p1.x};
+            if (p1.y < 0.0f) x -= p1.y * dxdy;
+
+            const s32 yEnd{min(ceil<s32>(p2.y), s32(height))};
+            for (s32 y{max(floor<s32>(p1.y), 0)}; y < yEnd; ++y)
             {
-                if (segment.isCurve)
+                f32 * const row{acc + u32(y) * pitch};
+                const f32 dy{min(f32(y + 1), p2.y) - max(f32(y), p1.y)};
+                const f32 nextX{x + dxdy * dy};
+                const f32 d{dy * dir};
+
+                // Clamp to guard against accumulated error straying outside the buffer
+                const f32 x1{clamp(min(x, nextX), 0.0f, maxX)};
+                const f32 x2{clamp(max(x, nextX), 0.0f, maxX)};
+                const f32 x1Floor{std::floor(x1)};
+                const f32 x2Ceil{std::ceil(x2)};
+                const s32 x1i{s32(x1Floor)};
+                const s32 x2i{s32(x2Ceil)};
+
+                if (x2i <= x1i + 1)
                 {
-                    if (zeroish(cross(segment.curve.p1 - segment.curve.p2, segment.curve.p3 - segment.curve.p2)))
+                    // Within one pixel
+                    const f32 midFract{0.5f * (x1 + x2) - x1Floor};
+                    row[x1i] += d - d * midFract;
+                    row[x1i + 1] += d * midFract;
+                }
+                else
+                {
+                    const f32 invSpan{1.0f / (x2 - x1)};
+                    const f32 x1Fract{x1 - x1Floor};
+                    const f32 a1{0.5f * invSpan * (1.0f - x1Fract) * (1.0f - x1Fract)};
+                    const f32 x2Fract{x2 - x2Ceil + 1.0f};
+                    const f32 aEnd{0.5f * invSpan * x2Fract * x2Fract};
+
+                    row[x1i] += d * a1;
+
+                    if (x2i == x1i + 2)
                     {
-                        // Convert curve to line
-                        segment.isCurve = false;
-                        segment.line = Line{.p1 = segment.curve.p1, .p2 = segment.curve.p3};
+                        row[x1i + 1] += d * (1.0f - a1 - aEnd);
                     }
                     else
                     {
-                        return false;
+                        const f32 a2{invSpan * (1.5f - x1Fract)};
+                        row[x1i + 1] += d * (a2 - a1);
+                        for (s32 xi{x1i + 2}; xi < x2i - 1; ++xi)
+                        {
+                            row[xi] += d * invSpan;
+                        }
+                        const f32 a3{a2 + f32(x2i - x1i - 3) * invSpan};
+                        row[x2i - 1] += d * (1.0f - a3 - aEnd);
                     }
+
+                    row[x2i] += d * aEnd;
                 }
 
-                return segment.line.p1 == segment.line.p2;
-            });
-    }
+                x = nextX;
+            }
+        }
 
-    void Contour::transform(const fvec2 scale, const fvec2 translate)
-    {
-        for (Segment & segment : segments)
+        // Splits the line where it crosses the left and right edges and collapses the parts outside onto the edges
+        // Area left of the image still counts towards the winding of the pixels to its right
+        void _rasterize(const Line & line, f32 * const acc, const u32 pitch, const u32 width, const u32 height)
         {
-            if (segment.isCurve)
+            const f32 maxX{f32(width)};
+
+            f32 ts[4]{0.0f};
+            u32 tN{1u};
+            for (const f32 edgeX : {0.0f, maxX})
             {
-                segment.curve.p1 *= scale;
-                segment.curve.p1 += translate;
-                segment.curve.p2 *= scale;
-                segment.curve.p2 += translate;
-                segment.curve.p3 *= scale;
-                segment.curve.p3 += translate;
+                if ((line.p1.x < edgeX) != (line.p2.x < edgeX) && line.p1.x != edgeX && line.p2.x != edgeX)
+                {
+                    ts[tN++] = (edgeX - line.p1.x) / (line.p2.x - line.p1.x);
+                }
             }
-            else
+            std::sort(ts + 1, ts + tN);
+            ts[tN++] = 1.0f;
+
+            const fvec2 delta{line.p2 - line.p1};
+            fvec2 p1{line.p1};
+            p1.x = clamp(p1.x, 0.0f, maxX);
+            for (u32 i{1u}; i < tN; ++i)
             {
-                segment.line.p1 *= scale;
-                segment.line.p1 += translate;
-                segment.line.p2 *= scale;
-                segment.line.p2 += translate;
+                fvec2 p2{i + 1u == tN ? line.p2 : line.p1 + delta * ts[i]};
+                p2.x = clamp(p2.x, 0.0f, maxX);
+                _accumulateLine(acc, pitch, width, height, p1, p2);
+                p1 = p2;
             }
         }
-    }
 
-    void Outline::normalize()
-    {
-        contours.eraseIf(
-            [](Contour & contour)
+        void _rasterize(const Curve & curve, f32 * const acc, const u32 pitch, const u32 width, const u32 height)
+        {
+            // Flatten into enough lines that the error is well under a pixel
+            const f32 deviation2{magnitude2(curve.p1 - 2.0f * curve.p2 + curve.p3)};
+            if (deviation2 < 0.333f)
             {
-                contour.normalize();
-                return !contour.segments;
-            });
-    }
+                _rasterize(Line{curve.p1, curve.p3}, acc, pitch, width, height);
+                return;
+            }
 
-    void Outline::transform(const fvec2 scale, const fvec2 translate)
-    {
-        for (Contour & contour : contours)
-        {
-            contour.transform(scale, translate);
+            const detail::CurveExt curveExt{_calcExtra(curve)};
+            const u32 lineN{1u + u32(std::sqrt(std::sqrt(3.0f * deviation2)))};
+            const f32 invLineN{1.0f / f32(lineN)};
+
+            fvec2 p1{curve.p1};
+            for (u32 i{1u}; i <= lineN; ++i)
+            {
+                const fvec2 p2{i == lineN ? curve.p3 : _evaluateBezier(curveExt, f32(i) * invLineN)};
+                _rasterize(Line{p1, p2}, acc, pitch, width, height);
+                p1 = p2;
+            }
         }
-    }
 
-    bool Outline::isValid() const
-    {
-        if (!contours)
+        void _rasterize(const Cubic & cubic, f32 * const acc, const u32 pitch, const u32 width, const u32 height)
+        {
+            // Same error bound as for quadratic curves, using the larger of the two second differences
+            const f32 deviation2{max(magnitude2(cubic.p1 - 2.0f * cubic.p2 + cubic.p3), magnitude2(cubic.p2 - 2.0f * cubic.p3 + cubic.p4))};
+
+            const detail::CubicExt cubicExt{_calcExtra(cubic)};
+            const u32 lineN{1u + u32(std::sqrt(std::sqrt(27.0f * deviation2)))};
+            const f32 invLineN{1.0f / f32(lineN)};
+
+            fvec2 p1{cubic.p1};
+            for (u32 i{1u}; i <= lineN; ++i)
+            {
+                const fvec2 p2{i == lineN ? cubic.p4 : _evaluateBezier(cubicExt, f32(i) * invLineN)};
+                _rasterize(Line{p1, p2}, acc, pitch, width, height);
+                p1 = p2;
+            }
+        }
+
+        // Collects the endpoints the contour passes through vertically, as they may need to be counted as intercepts
+        void _packVertices(const Contour & contour, List<PackedOutline::VertexEntry> & vertices)
+        {
+            struct Point { fvec2 p; f32 prevY, nextY; };
+            static thread_local List<Point> points;
+
+            points.resize(contour.segments.size());
+
+            for (u32 i{0u}, endI{contour.segments.size()}; i < endI; ++i)
+            {
+                u32 nextI{i + 1u};
+                if (nextI == endI) nextI = 0u;
+
+                const Segment & segment{contour.segments[i]};
+                Point & point{points[i]};
+                Point & nextPoint{points[nextI]};
+
+                point.p = segment.start();
+
+                switch (segment.type)
+                {
+                    case SegmentType::line:
+                    {
+                        point.nextY = segment.line.p2.y;
+                        nextPoint.prevY = segment.line.p1.y;
+                        break;
+                    }
+                    case SegmentType::curve:
+                    {
+                        point.nextY = segment.curve.p2.y == segment.curve.p1.y ? segment.curve.p3.y : segment.curve.p2.y;
+                        nextPoint.prevY = segment.curve.p2.y == segment.curve.p3.y ? segment.curve.p1.y : segment.curve.p2.y;
+                        break;
+                    }
+                    case SegmentType::cubic:
+                    {
+                        const Cubic & cubic{segment.cubic};
+                        point.nextY = cubic.p2.y != cubic.p1.y ? cubic.p2.y : cubic.p3.y != cubic.p1.y ? cubic.p3.y : cubic.p4.y;
+                        nextPoint.prevY = cubic.p3.y != cubic.p4.y ? cubic.p3.y : cubic.p2.y != cubic.p4.y ? cubic.p2.y : cubic.p1.y;
+                        break;
+                    }
+                }
+            }
+
+            // Remove consecutive points on same y value
+            for (u32 i{0u}; i < points.size(); ++i)
+            {
+                Point & point{points[i]};
+                if (point.p.y == point.prevY)
+                {
+                    Point & prevPoint{points[(i + points.size() - 1u) % points.size()]};
+                    Point & nextPoint{points[(i + 1u) % points.size()]};
+                    prevPoint.nextY = point.nextY;
+                    nextPoint.prevY = point.prevY;
+                    points.erase(points.begin() + i);
+                    --i;
+                }
+            }
+
+            for (const Point & point : points)
+            {
+                // Only an intersection if the adjacent points are on opposite sides of the scanline
+                if (point.prevY < point.p.y && point.nextY > point.p.y)
+                {
+                    vertices.push_back(PackedOutline::VertexEntry{.p = point.p, .winding = 1});
+                }
+                else if (point.prevY > point.p.y && point.nextY < point.p.y)
+                {
+                    vertices.push_back(PackedOutline::VertexEntry{.p = point.p, .winding = -1});
+                }
+            }
+        }
+
+        void _updateVertexIntercepts(const PackedOutline::VertexEntry & vertex, _Row * const rows, const u32 size)
+        {
+            if (vertex.p.y > 0.0f)
+            {
+                const auto [f, i]{fract_i<s32>(vertex.p.y)};
+                if (f == 0.5f && i < s32(size))
+                {
+                    _Row & row{rows[i]};
+                    row.intercepts[row.interceptN++] = _Intercept{.x = vertex.p.x, .winding = vertex.winding};
+                }
+            }
+        }
+
+        f32 _distance(const fvec2 p, const Line & line)
+        {
+            const fvec2 d{line.p2 - line.p1};
+            const f32 length2{magnitude2(d)};
+            const f32 t{length2 > 0.0f ? clamp(dot(p - line.p1, d) / length2, 0.0f, 1.0f) : 0.0f};
+            return distance(p, line.p1 + t * d);
+        }
+
+        // Upper bound on how far the segment strays from the line between its ends, compared at the same parameter, so running back and forth along the line counts too
+        // This is a fraction of how far the control points are from the line's own control points
+        f32 _flatness(const Segment & segment)
+        {
+            switch (segment.type)
+            {
+                case SegmentType::line: return 0.0f;
+                case SegmentType::curve:
+                {
+                    const Curve & curve{segment.curve};
+                    return 0.5f * distance(curve.p2, (curve.p1 + curve.p3) * 0.5f);
+                }
+                case SegmentType::cubic:
+                {
+                    const Cubic & cubic{segment.cubic};
+                    const f32 offset{max(distance(cubic.p2, (cubic.p1 * 2.0f + cubic.p4) * (1.0f / 3.0f)), distance(cubic.p3, (cubic.p1 + cubic.p4 * 2.0f) * (1.0f / 3.0f)))};
+                    return 0.75f * offset;
+                }
+            }
+
+            return 0.0f;
+        }
+
+        // Douglas-Peucker over the polyline `points[begin..end]`, appending the kept lines to `dst`
+        void _simplifyRun(const fvec2 * const points, const u32 begin, const u32 end, const f32 tolerance, List<Segment> & dst)
+        {
+            const Line chord{points[begin], points[end]};
+
+            f32 maxDistance{0.0f};
+            u32 maxI{begin};
+            for (u32 i{begin + 1u}; i < end; ++i)
+            {
+                const f32 d{_distance(points[i], chord)};
+                if (d > maxDistance)
+                {
+                    maxDistance = d;
+                    maxI = i;
+                }
+            }
+
+            if (maxDistance > tolerance)
+            {
+                _simplifyRun(points, begin, maxI, tolerance, dst);
+                _simplifyRun(points, maxI, end, tolerance, dst);
+            }
+            else if (chord.p1 != chord.p2)
+            {
+                dst.push_back(Segment{chord.p1, chord.p2});
+            }
+        }
+
+        Segment _transformed(const Segment & segment, const Transform & transform)
+        {
+            switch (segment.type)
+            {
+                case SegmentType::line: return Segment{transform.apply(segment.line.p1), transform.apply(segment.line.p2)};
+                case SegmentType::curve: return Segment{transform.apply(segment.curve.p1), transform.apply(segment.curve.p2), transform.apply(segment.curve.p3)};
+                case SegmentType::cubic: return Segment{transform.apply(segment.cubic.p1), transform.apply(segment.cubic.p2), transform.apply(segment.cubic.p3), transform.apply(segment.cubic.p4)};
+            }
+
+            return segment;
+        }
+
+        // Moves the start of a curve or cubic, if it stays valid
+        bool _moveStart(Segment & segment, const fvec2 p)
+        {
+            Segment moved{segment};
+            if (moved.type == SegmentType::curve)
+            {
+                moved.curve.p1 = p;
+            }
+            else
+            {
+                moved.cubic.p1 = p;
+            }
+
+            if (!moved.isValid())
+            {
+                return false;
+            }
+
+            segment = moved;
+            return true;
+        }
+
+        // Edge colors for MSDF, as a mask of the channels the edge contributes to
+        // Edges meeting at a corner share exactly one channel, which is what lets the median keep the corner sharp
+        constexpr u8 _red{0b001u};
+        constexpr u8 _green{0b010u};
+        constexpr u8 _blue{0b100u};
+        constexpr u8 _cyan{_green | _blue};
+        constexpr u8 _magenta{_red | _blue};
+        constexpr u8 _yellow{_red | _green};
+        constexpr u8 _white{_red | _green | _blue};
+
+        // Sine of the smallest direction change, about 8 degrees, that counts as a corner
+        constexpr f32 _cornerThreshold{0.1411f};
+
+        fvec2 _startDirection(const Segment & segment)
+        {
+            switch (segment.type)
+            {
+                case SegmentType::line: return segment.line.p2 - segment.line.p1;
+                case SegmentType::curve: return segment.curve.p2 - segment.curve.p1;
+                case SegmentType::cubic:
+                {
+                    const Cubic & cubic{segment.cubic};
+                    return cubic.p2 != cubic.p1 ? cubic.p2 - cubic.p1 : cubic.p3 != cubic.p1 ? cubic.p3 - cubic.p1 : cubic.p4 - cubic.p1;
+                }
+            }
+
+            return {};
+        }
+
+        fvec2 _endDirection(const Segment & segment)
+        {
+            switch (segment.type)
+            {
+                case SegmentType::line: return segment.line.p2 - segment.line.p1;
+                case SegmentType::curve: return segment.curve.p3 - segment.curve.p2;
+                case SegmentType::cubic:
+                {
+                    const Cubic & cubic{segment.cubic};
+                    return cubic.p4 != cubic.p3 ? cubic.p4 - cubic.p3 : cubic.p4 != cubic.p2 ? cubic.p4 - cubic.p2 : cubic.p4 - cubic.p1;
+                }
+            }
+
+            return {};
+        }
+
+        bool _isCorner(const Segment & from, const Segment & to)
+        {
+            const fvec2 a{normalize(_endDirection(from))};
+            const fvec2 b{normalize(_startDirection(to))};
+            return dot(a, b) <= 0.0f || abs(cross(a, b)) > _cornerThreshold;
+        }
+
+        // Cycles cyan, magenta, yellow. If `banned` shares just one channel with the current color, goes to the third color instead
+        u8 _switchColor(const u8 color, const u8 banned)
+        {
+            const u8 combined{u8(color & banned)};
+            if (combined == _red || combined == _green || combined == _blue)
+            {
+                return combined ^ _white;
+            }
+
+            if (color == _white)
+            {
+                return _cyan;
+            }
+
+            const u32 shifted{u32(color) << 1u};
+            return u8((shifted | (shifted >> 3u)) & _white);
+        }
+
+        // Assigns a color to each segment of the contour, changing color at each corner
+        void _colorEdges(const Contour & contour, List<u8> & colors)
+        {
+            static thread_local List<u32> corners{};
+
+            const u32 segmentN{contour.segments.size()};
+
+            corners.clear();
+            for (u32 i{0u}; i < segmentN; ++i)
+            {
+                if (_isCorner(contour.segments[i == 0u ? segmentN - 1u : i - 1u], contour.segments[i]))
+                {
+                    corners.push_back(i);
+                }
+            }
+
+            colors.resize(segmentN);
+
+            // Smooth contour, every channel is the same
+            if (!corners)
+            {
+                std::fill_n(colors.data(), segmentN, _white);
+                return;
+            }
+
+            // Teardrop, split into three runs so the one corner is still between two colors
+            if (corners.size() == 1u)
+            {
+                const u8 runColors[3]{_magenta, _white, _yellow};
+                for (u32 i{0u}; i < segmentN; ++i)
+                {
+                    const u32 run{segmentN >= 3u ? min(i * 3u / segmentN, 2u) : i * 2u};
+                    colors[(corners.front() + i) % segmentN] = runColors[run];
+                }
+                return;
+            }
+
+            // Change color at each corner, making sure the last run does not match the first
+            const u8 initialColor{_switchColor(_white, 0u)};
+            u8 color{initialColor};
+            u32 corner{0u};
+            for (u32 i{0u}; i < segmentN; ++i)
+            {
+                const u32 index{(corners.front() + i) % segmentN};
+                if (corner + 1u < corners.size() && corners[corner + 1u] == index)
+                {
+                    ++corner;
+                    color = _switchColor(color, corner + 1u == corners.size() ? initialColor : 0u);
+                }
+
+                colors[index] = color;
+            }
+        }
+
+        // Distance from a point to an edge, as needed for MSDF
+        struct _EdgeDistance
+        {
+            f32 distance2;
+            // Signed distance, positive to the right. Past an endpoint the point is behind, it is to the extended tangent instead
+            f32 pseudoDistance;
+        };
+
+        // Closest channel edge so far for one pixel
+        struct _MsdfChannel
+        {
+            f32 distance2;
+            f32 pseudoDistance;
+            u32 contourI;
+        };
+
+        f32 _signedDistanceToLine(const fvec2 origin, const fvec2 direction, const fvec2 p)
+        {
+            return cross(p - origin, direction) / magnitude(direction);
+        }
+
+        template <typename CurveExt>
+        void _updateClosestSpan(const CurveExt & curve, const fvec2 p, const f32 lowT, const f32 highT, _ClosestSpan & closest, f32 & closestDist2)
+        {
+            const _ClosestSpan span{_findClosestSpan(curve, p, lowT, highT)};
+            const f32 dist2{distance2ToLine(span.lowB, span.highB, p)};
+            if (dist2 < closestDist2)
+            {
+                closest = span;
+                closestDist2 = dist2;
+            }
+        }
+
+        _EdgeDistance _spanEdgeDistance(const _ClosestSpan & span, const f32 dist2, const Segment & segment, const fvec2 p)
+        {
+            if (span.lowT == 0.0f)
+            {
+                const fvec2 direction{_startDirection(segment)};
+                if (dot(p - segment.start(), direction) < 0.0f)
+                {
+                    return _EdgeDistance{.distance2 = dist2, .pseudoDistance = _signedDistanceToLine(segment.start(), direction, p)};
+                }
+            }
+
+            if (span.highT == 1.0f)
+            {
+                const fvec2 direction{_endDirection(segment)};
+                if (dot(p - segment.end(), direction) > 0.0f)
+                {
+                    return _EdgeDistance{.distance2 = dist2, .pseudoDistance = _signedDistanceToLine(segment.end(), direction, p)};
+                }
+            }
+
+            const f32 distance{std::sqrt(dist2)};
+            return _EdgeDistance{.distance2 = dist2, .pseudoDistance = cross(p - span.lowB, span.highB - span.lowB) < 0.0f ? -distance : distance};
+        }
+
+        _EdgeDistance _edgeDistance(const Line & line, const detail::LineExt & lineExt, const fvec2 p)
+        {
+            // Pseudo distance of a line is to the line through it everywhere
+            const fvec2 b{p - line.p1};
+            const f32 t{clamp(dot(lineExt.a, b) * lineExt.invLength2, 0.0f, 1.0f)};
+            return _EdgeDistance{.distance2 = distance2(b, t * lineExt.a), .pseudoDistance = cross(b, lineExt.a) * std::sqrt(lineExt.invLength2)};
+        }
+
+        _EdgeDistance _edgeDistance(const Curve & curve, const detail::CurveExt & curveExt, const fvec2 p)
+        {
+            // Same split at the point of maximum curvature as `_distance2To`
+            const f32 d{-2.0f * magnitude2(curveExt.a)};
+            const f32 u{d == 0.0f ? 0.0f : clamp(dot(curveExt.a, curveExt.b) / d, 0.0f, 1.0f)};
+
+            _ClosestSpan closest{};
+            f32 closestDist2{number::inf<f32>};
+
+            if (u > 0.0f)
+            {
+                _updateClosestSpan(curveExt, p, 0.0f, u, closest, closestDist2);
+            }
+
+            if (u < 1.0f)
+            {
+                _updateClosestSpan(curveExt, p, u, 1.0f, closest, closestDist2);
+            }
+
+            return _spanEdgeDistance(closest, closestDist2, Segment{curve.p1, curve.p2, curve.p3}, p);
+        }
+
+        _EdgeDistance _edgeDistance(const Cubic & cubic, const detail::CubicExt & cubicExt, const fvec2 p)
+        {
+            _ClosestSpan closest{};
+            f32 closestDist2{number::inf<f32>};
+
+            for (u32 i{0u}; i < cubicExt.pieceN; ++i)
+            {
+                _updateClosestSpan(cubicExt, p, cubicExt.pieceTs[i], cubicExt.pieceTs[i + 1u], closest, closestDist2);
+            }
+
+            return _spanEdgeDistance(closest, closestDist2, Segment{cubic.p1, cubic.p2, cubic.p3, cubic.p4}, p);
+        }
+
+        // Near equal distances happen around shared endpoints, where the edge the point is more square to wins
+        bool _isCloser(const _EdgeDistance & edge, const _MsdfChannel & channel)
+        {
+            const f32 tolerance{edge.distance2 * 1.0e-5f};
+
+            if (edge.distance2 + tolerance < channel.distance2)
+            {
+                return true;
+            }
+
+            if (edge.distance2 - tolerance > channel.distance2)
+            {
+                return false;
+            }
+
+            return edge.pseudoDistance * edge.pseudoDistance * channel.distance2 > channel.pseudoDistance * channel.pseudoDistance * edge.distance2;
+        }
+
+        template <typename S, typename Ext>
+        void _updateMsdf(const S & segment, const Ext & segmentExt, const fspan2 & bounds, const u8 color, const u32 contourI, const u32 size, const f32 halfRange, _MsdfChannel * const channels)
+        {
+            const ispan2 pixelBounds{max(floor<s32>(bounds.min - halfRange), 0), min(ceil<s32>(bounds.max + halfRange), s32(size))};
+
+            for (ivec2 p{pixelBounds.min}; p.y < pixelBounds.max.y; ++p.y)
+            {
+                _MsdfChannel * const row{channels + u64(p.y) * size * 3u};
+
+                for (p.x = pixelBounds.min.x; p.x < pixelBounds.max.x; ++p.x)
+                {
+                    const _EdgeDistance edge{_edgeDistance(segment, segmentExt, fvec2(p) + 0.5f)};
+                    _MsdfChannel * const pixel{row + p.x * 3};
+
+                    for (u32 c{0u}; c < 3u; ++c)
+                    {
+                        if ((color >> c) & 1u && _isCloser(edge, pixel[c]))
+                        {
+                            pixel[c] = _MsdfChannel{.distance2 = edge.distance2, .pseudoDistance = edge.pseudoDistance, .contourI = contourI};
+                        }
+                    }
+                }
+            }
+        }
+
+        f32 _median(const f32 a, const f32 b, const f32 c)
+        {
+            return max(min(a, b), min(max(a, b), c));
+        }
+    }
+
+    bool Line::isValid() const
+    {
+        return _isPointValid(p1) && _isPointValid(p2) && p1 != p2;
+    }
+
+    bool Curve::isValid() const
+    {
+        return _isPointValid(p1) && _isPointValid(p2) && _isPointValid(p3) && p1 != p2 && p2 != p3 && p3 != p1;
+    }
+
+    bool Cubic::isValid() const
+    {
+        // Control points may coincide with the endpoints
+        return _isPointValid(p1) && _isPointValid(p2) && _isPointValid(p3) && _isPointValid(p4) && p1 != p4;
+    }
+
+    bool Segment::isValid() const
+    {
+        switch (type)
+        {
+            case SegmentType::line: return line.isValid();
+            case SegmentType::curve: return curve.isValid();
+            case SegmentType::cubic: return cubic.isValid();
+        }
+
+        return false;
+    }
+
+    bool Contour::isValid() const
+    {
+        if (segments.size() < 2u)
+        {
+            return false;
+        }
+
+        // All segments must be themselves valid
+        for (const Segment & segment : segments)
+        {
+            if (!segment.isValid())
+            {
+                return false;
+            }
+        }
+
+        // Each segment must connect to the next
+        for (u32 i{1u}; i < segments.size(); ++i)
+        {
+            if (segments[i - 1u].end() != segments[i].start())
+            {
+                return false;
+            }
+        }
+
+        // Last segment must connect to the first
+        if (segments.back().end() != segments.front().start())
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    void Contour::normalize()
+    {
+        segments.eraseIf(
+            [](Segment & segment)
+            {
+                if (segment.type == SegmentType::cubic)
+                {
+                    const Cubic & cubic{segment.cubic};
+                    if (zeroish(cross(cubic.p2 - cubic.p1, cubic.p4 - cubic.p1)) && zeroish(cross(cubic.p3 - cubic.p1, cubic.p4 - cubic.p1)))
+                    {
+                        // Convert cubic to line
+                        segment.type = SegmentType::line;
+                        segment.line = Line{.p1 = cubic.p1, .p2 = cubic.p4};
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+                else if (segment.type == SegmentType::curve)
+                {
+                    if (zeroish(cross(segment.curve.p1 - segment.curve.p2, segment.curve.p3 - segment.curve.p2)))
+                    {
+                        // Convert curve to line
+                        segment.type = SegmentType::line;
+                        segment.line = Line{.p1 = segment.curve.p1, .p2 = segment.curve.p3};
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+
+                return segment.line.p1 == segment.line.p2;
+            });
+    }
+
+    void Contour::simplify(const f32 tolerance)
+    {
+        normalize();
+
+        const u32 segmentN{segments.size()};
+        if (!segmentN)
+        {
+            return;
+        }
+
+        // Demoting and merging each get half the tolerance, so their combined error stays within it
+        const f32 halfTolerance{tolerance * 0.5f};
+
+        for (Segment & segment : segments)
+        {
+            if (segment.type != SegmentType::line && _flatness(segment) <= halfTolerance)
+            {
+                segment = Segment{segment.start(), segment.end()};
+            }
+        }
+
+        // Start at a curve, so no run of lines wraps around the end. If there are only lines, start at the sharpest corner
+        u32 first{0u};
+        f32 maxDeviation{-1.0f};
+        for (u32 i{0u}; i < segmentN; ++i)
+        {
+            if (segments[i].type != SegmentType::line)
+            {
+                first = i;
+                break;
+            }
+
+            const Segment & prev{segments[i == 0u ? segmentN - 1u : i - 1u]};
+            const f32 deviation{_distance(segments[i].line.p1, Line{prev.start(), segments[i].line.p2})};
+            if (deviation > maxDeviation)
+            {
+                maxDeviation = deviation;
+                first = i;
+            }
+        }
+
+        static thread_local List<Segment> simplified{};
+        static thread_local List<fvec2> points{};
+
+        simplified.clear();
+
+        for (u32 k{0u}; k < segmentN;)
+        {
+            const Segment & segment{segments[(first + k) % segmentN]};
+
+            if (segment.type != SegmentType::line)
+            {
+                simplified.push_back(segment);
+                ++k;
+                continue;
+            }
+
+            points.clear();
+            points.push_back(segment.line.p1);
+            for (; k < segmentN && segments[(first + k) % segmentN].type == SegmentType::line; ++k)
+            {
+                points.push_back(segments[(first + k) % segmentN].line.p2);
+            }
+
+            _simplifyRun(points.data(), 0u, points.size() - 1u, halfTolerance, simplified);
+        }
+
+        // Any line still shorter than the tolerance sits against a curve, so fold it into the curve's start
+        // Only original curves are moved, and each only at its start, so this doesn't compound with the other error
+        for (u32 i{0u}, n{simplified.size()}; i < n && n > 2u; ++i)
+        {
+            Segment & segment{simplified[i]};
+            Segment & next{simplified[i + 1u == n ? 0u : i + 1u]};
+            if (segment.type == SegmentType::line && next.type != SegmentType::line && distance(segment.line.p1, segment.line.p2) <= halfTolerance)
+            {
+                if (_moveStart(next, segment.line.p1))
+                {
+                    segment.line.p2 = segment.line.p1;
+                }
+            }
+        }
+
+        simplified.eraseIf([](const Segment & segment) { return segment.type == SegmentType::line && segment.line.p1 == segment.line.p2; });
+
+        segments.resize(simplified.size());
+        std::copy_n(simplified.data(), simplified.size(), segments.data());
+    }
+
+    void Contour::transform(const fvec2 scale, const fvec2 translate)
+    {
+        for (Segment & segment : segments)
+        {
+            switch (segment.type)
+            {
+                case SegmentType::line:
+                {
+                    segment.line.p1 *= scale;
+                    segment.line.p1 += translate;
+                    segment.line.p2 *= scale;
+                    segment.line.p2 += translate;
+                    break;
+                }
+                case SegmentType::curve:
+                {
+                    segment.curve.p1 *= scale;
+                    segment.curve.p1 += translate;
+                    segment.curve.p2 *= scale;
+                    segment.curve.p2 += translate;
+                    segment.curve.p3 *= scale;
+                    segment.curve.p3 += translate;
+                    break;
+                }
+                case SegmentType::cubic:
+                {
+                    segment.cubic.p1 *= scale;
+                    segment.cubic.p1 += translate;
+                    segment.cubic.p2 *= scale;
+                    segment.cubic.p2 += translate;
+                    segment.cubic.p3 *= scale;
+                    segment.cubic.p3 += translate;
+                    segment.cubic.p4 *= scale;
+                    segment.cubic.p4 += translate;
+                    break;
+                }
+            }
+        }
+    }
+
+    void Outline::normalize()
+    {
+        contours.eraseIf(
+            [](Contour & contour)
+            {
+                contour.normalize();
+                return !contour.segments;
+            });
+    }
+
+    void Outline::simplify(const f32 tolerance)
+    {
+        contours.eraseIf(
+            [tolerance](Contour & contour)
+            {
+                contour.simplify(tolerance);
+                return contour.segments.size() < 2u;
+            });
+    }
+
+    void Outline::transform(const fvec2 scale, const fvec2 translate)
+    {
+        for (Contour & contour : contours)
+        {
+            contour.transform(scale, translate);
+        }
+    }
+
+    bool Outline::isValid() const
+    {
+        if (!contours)
+        {
+            return false;
+        }
+
+        for (const Contour & contour : contours)
+        {
+            if (!contour.isValid())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Transform::isValid() const
+    {
+        const f32 determinant{cross(xAxis, yAxis)};
+        return _isPointValid(xAxis) && _isPointValid(yAxis) && _isPointValid(translate) && std::isfinite(determinant) && determinant != 0.0f;
+    }
+
+    void PackedOutline::pack(const Outline & outline, const Transform & transform)
+    {
+        lines.clear();
+        curves.clear();
+        cubics.clear();
+        vertices.clear();
+        contours.clear();
+        maxRowInterceptN = 0u;
+        fillRule = outline.fillRule;
+
+        if (!outline.isValid() || !transform.isValid())
+        {
+            return;
+        }
+
+        const bool identity{transform.isIdentity()};
+        static thread_local Contour transformed{};
+
+        for (const Contour & original : outline.contours)
+        {
+            const Contour * contourPtr{&original};
+
+            if (!identity)
+            {
+                transformed.segments.resize(original.segments.size());
+                for (u32 i{0u}; i < original.segments.size(); ++i)
+                {
+                    transformed.segments[i] = _transformed(original.segments[i], transform);
+                }
+
+                // A valid transform may still collapse points that are very close, given float precision
+                if (!transformed.isValid())
+                {
+                    lines.clear();
+                    curves.clear();
+                    cubics.clear();
+                    vertices.clear();
+                    contours.clear();
+                    return;
+                }
+
+                contourPtr = &transformed;
+            }
+
+            const Contour & contour{*contourPtr};
+
+            for (const Segment & segment : contour.segments)
+            {
+                switch (segment.type)
+                {
+                    case SegmentType::line:
+                    {
+                        const detail::LineExt ext{_calcExtra(segment.line)};
+                        lines.push_back(LineEntry{.line = segment.line, .ext = ext, .bounds = _detSpan(segment.line)});
+                        break;
+                    }
+                    case SegmentType::curve:
+                    {
+                        const detail::CurveExt ext{_calcExtra(segment.curve)};
+                        curves.push_back(CurveEntry{.curve = segment.curve, .ext = ext, .bounds = _detSpan(segment.curve, ext)});
+                        break;
+                    }
+                    case SegmentType::cubic:
+                    {
+                        const detail::CubicExt ext{_calcExtra(segment.cubic)};
+                        cubics.push_back(CubicEntry{.cubic = segment.cubic, .ext = ext, .bounds = _detSpan(segment.cubic, ext)});
+                        break;
+                    }
+                }
+            }
+
+            _packVertices(contour, vertices);
+
+            contours.push_back(ContourEnd{.lineEnd = lines.size(), .curveEnd = curves.size(), .cubicEnd = cubics.size(), .vertexEnd = vertices.size()});
+        }
+
+        // Each line can cross a scanline once, each curve twice, and each cubic three times
+        maxRowInterceptN = lines.size() + 2u * curves.size() + 3u * cubics.size() + vertices.size();
+    }
+
+    void PackedOutline::scale(const f32 factor)
+    {
+        ASSERT(factor > 0.0f);
+
+        const f32 invFactor{1.0f / factor};
+        const f32 invFactor2{invFactor * invFactor};
+
+        for (LineEntry & entry : lines)
+        {
+            entry.line.p1 *= factor;
+            entry.line.p2 *= factor;
+            entry.ext.a *= factor;
+            entry.ext.invLength2 *= invFactor2;
+            entry.bounds.min *= factor;
+            entry.bounds.max *= factor;
+        }
+
+        for (CurveEntry & entry : curves)
+        {
+            entry.curve.p1 *= factor;
+            entry.curve.p2 *= factor;
+            entry.curve.p3 *= factor;
+            entry.ext.a *= factor;
+            entry.ext.b *= factor;
+            entry.ext.c *= factor;
+            entry.ext.maxHalfSubLineLength *= invFactor;
+            entry.bounds.min *= factor;
+            entry.bounds.max *= factor;
+        }
+
+        // Extrema and inflections are at the same parameters, so the piece bounds stay
+        for (CubicEntry & entry : cubics)
+        {
+            entry.cubic.p1 *= factor;
+            entry.cubic.p2 *= factor;
+            entry.cubic.p3 *= factor;
+            entry.cubic.p4 *= factor;
+            entry.ext.a *= factor;
+            entry.ext.b *= factor;
+            entry.ext.c *= factor;
+            entry.ext.d *= factor;
+            entry.ext.maxHalfSubLineLength *= invFactor;
+            entry.bounds.min *= factor;
+            entry.bounds.max *= factor;
+        }
+
+        for (VertexEntry & vertex : vertices)
+        {
+            vertex.p *= factor;
+        }
+    }
+
+    GrayImage generate(const Outline & outline, const u32 size, const f32 range, GenerateStats * const stats)
+    {
+        return generate<u8>(outline, size, range, stats);
+    }
+
+    GrayImage generate(const PackedOutline & outline, const u32 size, const f32 range, GenerateStats * const stats)
+    {
+        return generate<u8>(outline, size, range, stats);
+    }
+
+    GrayImage generate(const Outline & outline, const Transform & transform, const u32 size, const f32 range, GenerateStats * const stats)
+    {
+        return generate<u8>(outline, transform, size, range, stats);
+    }
+
+    template <Numeric T>
+    Image<T, 1u> generate(const Outline & outline, const u32 size, const f32 range, GenerateStats * const stats)
+    {
+        static thread_local PackedOutline packedOutline{};
+
+        packedOutline.pack(outline);
+
+        return generate<T>(packedOutline, size, range, stats);
+    }
+
+    template <Numeric T>
+    Image<T, 1u> generate(const Outline & outline, const Transform & transform, const u32 size, const f32 range, GenerateStats * const stats)
+    {
+        static thread_local PackedOutline packedOutline{};
+
+        packedOutline.pack(outline, transform);
+
+        return generate<T>(packedOutline, size, range, stats);
+    }
+
+    template <Numeric T>
+    Image<T, 1u> generate(const PackedOutline & outline, const u32 size, const f32 range, GenerateStats * const stats)
+    {
+        // Cleared even on failure, so nothing of a previous call is left
+        if (stats)
+        {
+            *stats = {};
+        }
+
+        FAIL_IF(!outline.isValid());
+
+        Image<T, 1u> image{size, size};
+        FAIL_IF(!generate(outline, image.view(), range, stats));
+        return image;
+    }
+
+    template <Numeric T>
+    bool generate(const PackedOutline & outline, const ImageView<T, 1u, false> & dst, const f32 range, GenerateStats * const stats)
+    {
+        static thread_local List<f32> distances{};
+        static thread_local List<_Intercept> rowIntercepts{};
+        static thread_local List<_Row> rows{};
+
+        if (stats)
+        {
+            *stats = {};
+        }
+
+        if (!outline.isValid() || dst.width() != dst.height())
+        {
+            return false;
+        }
+
+        const u32 size{dst.width()};
+
+        if constexpr (statsEnabled)
+        {
+            _stats = {};
+            _stats.rowN = size;
+        }
+
+        // Reset buffers
+        {
+            distances.resize(size * size);
+            for (f32 & distance : distances) distance = number::inf<float>;
+
+            const u32 maxInterceptN{outline.maxRowInterceptN};
+            rowIntercepts.resize(size * maxInterceptN);
+
+            rows.resize(size);
+            f32 * firstDistance{distances.data() + size * size - size};
+            _Intercept * firstIntercept{rowIntercepts.data()};
+            for (_Row & row : rows)
+            {
+                row.distances = firstDistance;
+                row.interceptN = 0u;
+                row.intercepts = firstIntercept;
+
+                firstDistance -= size;
+                firstIntercept += maxInterceptN;
+            }
+        }
+
+        // Process segments to calculate distances and row intersections
+
+        const f32 halfRange{range * 0.5f};
+
+        for (const PackedOutline::LineEntry & entry : outline.lines)
+        {
+            _process(entry.line, entry.ext, entry.bounds, size, halfRange, rows.data());
+        }
+
+        for (const PackedOutline::CurveEntry & entry : outline.curves)
+        {
+            _process(entry.curve, entry.ext, entry.bounds, size, halfRange, rows.data());
+        }
+
+        for (const PackedOutline::CubicEntry & entry : outline.cubics)
+        {
+            _process(entry.cubic, entry.ext, entry.bounds, size, halfRange, rows.data());
+        }
+
+        _Clock::time_point time;
+        if constexpr (statsEnabled) time = _Clock::now();
+
+        // Explicitly and carefully add endpoints as intercepts if appropriate
+        for (const PackedOutline::VertexEntry & vertex : outline.vertices)
+        {
+            _updateVertexIntercepts(vertex, rows.data(), size);
+        }
+
+        if constexpr (statsEnabled) time = _lap(time, _stats.interceptSeconds);
+
+        // Sqrt distances
+
+        for (f32 & distance : distances)
+        {
+            distance = std::sqrt(distance);
+        }
+
+        if constexpr (statsEnabled) time = _lap(time, _stats.sqrtSeconds);
+
+        // Sort row intersections and invert internal distances
+
+        for (_Row & row : rows)
+        {
+            _forInsideSpans(row, size, outline.fillRule, [&row](const s32 beginX, const s32 endX)
+            {
+                for (s32 xPx{beginX}; xPx <= endX; ++xPx)
+                {
+                    f32 & distance{row.distances[xPx]};
+                    distance = -distance;
+                }
+            });
+        }
+
+        // Convert to grayscale image
+
+        const f32 invRange{1.0f / range};
+
+        if constexpr (statsEnabled) time = _lap(time, _stats.sortSeconds);
+
+        for (u32 y{0u}; y < size; ++y)
+        {
+            const f32 * const src{rows[y].distances};
+            T * const dstRow{dst.row(s32(y))};
+
+            for (u32 x{0u}; x < size; ++x)
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                    dstRow[x] = 0.5f - src[x] * invRange;
+                }
+                else
+                {
+                    dstRow[x] = transnorm<T>(0.5f - src[x] * invRange);
+                }
+            }
+        }
+
+        if constexpr (statsEnabled)
+        {
+            _lap(time, _stats.quantizeSeconds);
+
+            if (stats)
+            {
+                *stats = _stats;
+            }
+        }
+
+        return true;
+    }
+
+    template <Numeric T>
+    List<Image<T, 1u>> generateLevels(const Outline & outline, const f32 outlineSize, const u32 * const sizes, const u32 levelN, const f32 range)
+    {
+        FAIL_IF(!outline.isValid());
+        FAIL_IF(!(outlineSize > 0.0f));
+
+        List<Image<T, 1u>> images{};
+        static thread_local List<ImageView<T, 1u, false>> views{};
+        views.clear();
+
+        // Views refer to their image, so must wait until the list is done growing
+        for (u32 i{0u}; i < levelN; ++i)
+        {
+            FAIL_IF(!sizes[i]);
+            images.push_back(Image<T, 1u>{sizes[i], sizes[i]});
+        }
+        for (Image<T, 1u> & image : images)
+        {
+            views.push_back(image.view());
+        }
+
+        FAIL_IF(!generateLevels(outline, outlineSize, views.data(), levelN, range));
+
+        return images;
+    }
+
+    template <Numeric T>
+    bool generateLevels(const Outline & outline, const f32 outlineSize, const ImageView<T, 1u, false> * const levels, const u32 levelN, const f32 range)
+    {
+        static thread_local PackedOutline packedOutline{};
+
+        FAIL_IF(!(outlineSize > 0.0f));
+        for (u32 i{0u}; i < levelN; ++i)
+        {
+            FAIL_IF(!levels[i].width());
+        }
+
+        packedOutline.pack(outline);
+        if (!packedOutline.isValid())
         {
             return false;
         }
 
-        for (const Contour & contour : contours)
+        // The one packed outline is scaled in place from each level's size to the next
+        f32 packedSize{outlineSize};
+        for (u32 i{0u}; i < levelN; ++i)
+        {
+            const f32 levelSize{f32(levels[i].width())};
+            packedOutline.scale(levelSize / packedSize);
+            packedSize = levelSize;
+
+            if (!generate(packedOutline, levels[i], range))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    f32 SparseSdf::sample(const fvec2 p) const
+    {
+        ASSERT(_size);
+
+        const fvec2 q{p - 0.5f};
+        const ivec2 low{floor<s32>(q)};
+        const fvec2 f{q - fvec2(low)};
+
+        const s32 maxI{s32(_size) - 1};
+        const s32 x1{clamp(low.x, 0, maxI)};
+        const s32 x2{clamp(low.x + 1, 0, maxI)};
+        const s32 y1{clamp(low.y, 0, maxI)};
+        const s32 y2{clamp(low.y + 1, 0, maxI)};
+
+        const f32 bottom{f32(at(x1, y1)) * (1.0f - f.x) + f32(at(x2, y1)) * f.x};
+        const f32 top{f32(at(x1, y2)) * (1.0f - f.x) + f32(at(x2, y2)) * f.x};
+        return (bottom * (1.0f - f.y) + top * f.y) * (1.0f / 255.0f);
+    }
+
+    GrayImage SparseSdf::toImage(Executor & executor) const
+    {
+        GrayImage image{_size, _size};
+
+        executor.parallelFor(_tileCount, 1u, [&](const u32 beginTileY, const u32 endTileY)
+        {
+            for (u32 tileY{beginTileY}; tileY < endTileY; ++tileY)
+            {
+                const u32 beginY{tileY * tileSize};
+                const u32 endY{min(beginY + tileSize, _size)};
+
+                for (u32 tileX{0u}; tileX < _tileCount; ++tileX)
+                {
+                    const u32 beginX{tileX * tileSize};
+                    const u32 width{min(tileSize, _size - beginX)};
+                    const u32 tile{_tiles[tileY * _tileCount + tileX]};
+
+                    for (u32 y{beginY}; y < endY; ++y)
+                    {
+                        u8 * const dst{image.row(s32(y)) + beginX};
+
+                        if (tile >= _insideTile)
+                        {
+                            std::fill_n(dst, width, tile == _insideTile ? u8(255u) : u8(0u));
+                        }
+                        else
+                        {
+                            std::copy_n(_pixels.data() + u64(tile) * tilePixelN + (y - beginY) * tileSize, width, dst);
+                        }
+                    }
+                }
+            }
+        });
+
+        return image;
+    }
+
+    SparseSdf generateSparse(const Outline & outline, const u32 size, const f32 range, Executor & executor)
+    {
+        static thread_local PackedOutline packedOutline{};
+
+        packedOutline.pack(outline);
+
+        return generateSparse(packedOutline, size, range, executor);
+    }
+
+    SparseSdf generateSparse(const Outline & outline, const Transform & transform, const u32 size, const f32 range, Executor & executor)
+    {
+        static thread_local PackedOutline packedOutline{};
+
+        packedOutline.pack(outline, transform);
+
+        return generateSparse(packedOutline, size, range, executor);
+    }
+
+    SparseSdf generateSparse(const PackedOutline & outline, const u32 size, const f32 range, Executor & executor)
+    {
+        FAIL_IF(!outline.isValid() || !size);
+
+        constexpr u32 tileSize{SparseSdf::tileSize};
+        constexpr u32 tilePixelN{SparseSdf::tilePixelN};
+
+        const u32 tileCount{(size + tileSize - 1u) / tileSize};
+        const f32 halfRange{range * 0.5f};
+        const f32 invRange{1.0f / range};
+        const u32 lineN{outline.lines.size()};
+        const u32 curveN{outline.curves.size()};
+        const u32 cubicN{outline.cubics.size()};
+
+        // Bin segments and vertices by band, so each band only looks at what is near it
+        // Segments are numbered lines first, then curves, then cubics
+        List<u32> segmentStarts{};
+        List<u32> vertexStarts{};
+        List<u32> bandSegments{};
+        List<PackedOutline::VertexEntry> bandVertices{};
+        {
+            segmentStarts.resize(tileCount + 1u);
+            vertexStarts.resize(tileCount + 1u);
+            std::fill(segmentStarts.begin(), segmentStarts.end(), 0u);
+            std::fill(vertexStarts.begin(), vertexStarts.end(), 0u);
+
+            const auto segmentBounds{[&](const u32 segmentI) -> const fspan2 &
+            {
+                return segmentI < lineN ? outline.lines[segmentI].bounds : segmentI < lineN + curveN ? outline.curves[segmentI - lineN].bounds : outline.cubics[segmentI - lineN - curveN].bounds;
+            }};
+            // Vertices only matter in the row they are centered on, see `_updateVertexIntercepts`
+            const auto vertexBand{[&](const PackedOutline::VertexEntry & vertex) -> s32
+            {
+                return vertex.p.y > 0.0f && vertex.p.y < f32(size) ? s32(vertex.p.y) / s32(tileSize) : -1;
+            }};
+
+            for (u32 segmentI{0u}; segmentI < lineN + curveN + cubicN; ++segmentI)
+            {
+                const ispan1 bands{_bandSpan(segmentBounds(segmentI), size, halfRange)};
+                for (s32 bandI{bands.min}; bandI <= bands.max; ++bandI) ++segmentStarts[u32(bandI)];
+            }
+            for (const PackedOutline::VertexEntry & vertex : outline.vertices)
+            {
+                const s32 bandI{vertexBand(vertex)};
+                if (bandI >= 0) ++vertexStarts[u32(bandI)];
+            }
+
+            // Counts become ends, then filling back to front moves each to its band's start
+            for (u32 bandI{1u}; bandI <= tileCount; ++bandI)
+            {
+                segmentStarts[bandI] += segmentStarts[bandI - 1u];
+                vertexStarts[bandI] += vertexStarts[bandI - 1u];
+            }
+
+            bandSegments.resize(segmentStarts[tileCount]);
+            bandVertices.resize(vertexStarts[tileCount]);
+
+            for (u32 segmentI{lineN + curveN + cubicN}; segmentI-- > 0u;)
+            {
+                const ispan1 bands{_bandSpan(segmentBounds(segmentI), size, halfRange)};
+                for (s32 bandI{bands.min}; bandI <= bands.max; ++bandI) bandSegments[--segmentStarts[u32(bandI)]] = segmentI;
+            }
+            for (u32 i{outline.vertices.size()}; i-- > 0u;)
+            {
+                const s32 bandI{vertexBand(outline.vertices[i])};
+                if (bandI >= 0) bandVertices[--vertexStarts[u32(bandI)]] = outline.vertices[i];
+            }
+        }
+
+        SparseSdf sdf{};
+        sdf._size = size;
+        sdf._tileCount = tileCount;
+        sdf._tiles.resize(tileCount * tileCount);
+
+        // Stored pixels of each band, with the tile table holding indices within the band until they are combined
+        List<List<u8>> bandPixels{};
+        bandPixels.resize(tileCount);
+
+        executor.parallelFor(tileCount, 1u, [&](const u32 beginBand, const u32 endBand)
         {
-            if (!contour.isValid())
+            static thread_local _SparseBand band{};
+            static thread_local List<_Row> rows{};
+            static thread_local List<u8> uniformInside{};
+
+            const u32 maxInterceptN{outline.maxRowInterceptN};
+            band.slots.resize(tileCount);
+            band.intercepts.resize(tileSize * maxInterceptN);
+            rows.resize(size);
+            uniformInside.resize(tileCount);
+
+            for (u32 bandI{beginBand}; bandI < endBand; ++bandI)
             {
-                return false;
+                const s32 bandY{s32(bandI * tileSize)};
+                const u32 bandHeight{min(tileSize, size - u32(bandY))};
+
+                std::fill(band.slots.begin(), band.slots.end(), _noSlot);
+                band.distances.clear();
+                std::fill(uniformInside.begin(), uniformInside.end(), u8(0u));
+                for (u32 y{0u}; y < bandHeight; ++y)
+                {
+                    rows[u32(bandY) + y] = _Row{.distances = nullptr, .interceptN = 0u, .intercepts = band.intercepts.data() + y * maxInterceptN};
+                }
+
+                for (u32 i{segmentStarts[bandI]}; i < segmentStarts[bandI + 1u]; ++i)
+                {
+                    const u32 segmentI{bandSegments[i]};
+                    if (segmentI < lineN)
+                    {
+                        const PackedOutline::LineEntry & entry{outline.lines[segmentI]};
+                        _processBand(entry.line, entry.ext, entry.bounds, size, halfRange, bandY, band, rows.data());
+                    }
+                    else if (segmentI < lineN + curveN)
+                    {
+                        const PackedOutline::CurveEntry & entry{outline.curves[segmentI - lineN]};
+                        _processBand(entry.curve, entry.ext, entry.bounds, size, halfRange, bandY, band, rows.data());
+                    }
+                    else
+                    {
+                        const PackedOutline::CubicEntry & entry{outline.cubics[segmentI - lineN - curveN]};
+                        _processBand(entry.cubic, entry.ext, entry.bounds, size, halfRange, bandY, band, rows.data());
+                    }
+                }
+
+                for (u32 i{vertexStarts[bandI]}; i < vertexStarts[bandI + 1u]; ++i)
+                {
+                    _updateVertexIntercepts(bandVertices[i], rows.data(), size);
+                }
+
+                for (f32 & distance : band.distances)
+                {
+                    distance = std::sqrt(distance);
+                }
+
+                // Invert internal distances. Tiles with no segment near are uniform, so their first row decides them
+                for (u32 y{0u}; y < bandHeight; ++y)
+                {
+                    _forInsideSpans(rows[u32(bandY) + y], size, outline.fillRule, [&](const s32 beginX, const s32 endX)
+                    {
+                        for (s32 tileX{beginX / s32(tileSize)}; tileX <= endX / s32(tileSize); ++tileX)
+                        {
+                            const u32 slot{band.slots[u32(tileX)]};
+                            if (slot == _noSlot)
+                            {
+                                if (!y)
+                                {
+                                    uniformInside[u32(tileX)] = 1u;
+                                }
+                                continue;
+                            }
+
+                            const s32 tileBeginX{tileX * s32(tileSize)};
+                            f32 * const rowDistances{band.distances.data() + u64(slot) * tilePixelN + y * tileSize};
+                            for (s32 x{max(beginX, tileBeginX)}, spanEndX{min(endX, tileBeginX + s32(tileSize) - 1)}; x <= spanEndX; ++x)
+                            {
+                                f32 & distance{rowDistances[x - tileBeginX]};
+                                distance = -distance;
+                            }
+                        }
+                    });
+                }
+
+                // Quantize, keeping only the tiles that are not all saturated the same way
+                List<u8> & pixels{bandPixels[bandI]};
+                u32 * const tiles{sdf._tiles.data() + bandI * tileCount};
+                const u32 bandWidth{size};
+
+                for (u32 tileX{0u}; tileX < tileCount; ++tileX)
+                {
+                    const u32 slot{band.slots[tileX]};
+                    if (slot == _noSlot)
+                    {
+                        tiles[tileX] = uniformInside[tileX] ? SparseSdf::_insideTile : SparseSdf::_outsideTile;
+                        continue;
+                    }
+
+                    const u64 pixelStart{pixels.size()};
+                    pixels.resize(pixelStart + tilePixelN);
+                    u8 * const dst{pixels.data() + pixelStart};
+                    const f32 * const src{band.distances.data() + u64(slot) * tilePixelN};
+                    const u32 tileWidth{min(tileSize, bandWidth - tileX * tileSize)};
+
+                    bool allOutside{true};
+                    bool allInside{true};
+                    for (u32 y{0u}; y < tileSize; ++y)
+                    {
+                        for (u32 x{0u}; x < tileSize; ++x)
+                        {
+                            const u8 value{transnorm<u8>(0.5f - src[y * tileSize + x] * invRange)};
+                            dst[y * tileSize + x] = value;
+
+                            // Padding past the edge of the field does not count
+                            if (y < bandHeight && x < tileWidth)
+                            {
+                                allOutside &= value == 0u;
+                                allInside &= value == 255u;
+                            }
+                        }
+                    }
+
+                    if (allOutside || allInside)
+                    {
+                        pixels.resize(pixelStart);
+                        tiles[tileX] = allInside ? SparseSdf::_insideTile : SparseSdf::_outsideTile;
+                    }
+                    else
+                    {
+                        tiles[tileX] = u32(pixelStart / tilePixelN);
+                    }
+                }
             }
+        });
+
+        // Combine the bands' pixels and make the tile indices global
+        u64 totalPixelN{0u};
+        for (const List<u8> & pixels : bandPixels)
+        {
+            totalPixelN += pixels.size();
         }
+        sdf._pixels.resize(totalPixelN);
 
-        return true;
+        u64 pixelOffset{0u};
+        for (u32 bandI{0u}; bandI < tileCount; ++bandI)
+        {
+            const u32 firstTile{u32(pixelOffset / tilePixelN)};
+            for (u32 tileX{0u}; tileX < tileCount; ++tileX)
+            {
+                u32 & tile{sdf._tiles[bandI * tileCount + tileX]};
+                if (tile < SparseSdf::_insideTile)
+                {
+                    tile += firstTile;
+                }
+            }
+
+            std::copy_n(bandPixels[bandI].data(), bandPixels[bandI].size(), sdf._pixels.data() + pixelOffset);
+            pixelOffset += bandPixels[bandI].size();
+            bandPixels[bandI] = {};
+        }
+
+        return sdf;
     }
 
-    GrayImage generate(const Outline & outline, const u32 size, const f32 range)
+    RgbImage generateMsdf(const Outline & outline, const u32 size, const f32 range)
     {
-        static thread_local List<f32> distances{};
-        static thread_local List<f32> rowIntercepts{};
+        return generateMsdf(outline, Transform{}, size, range);
+    }
+
+    RgbImage generateMsdf(const Outline & outline, const Transform & transform, const u32 size, const f32 range)
+    {
+        static thread_local PackedOutline packedOutline{};
+        static thread_local List<u8> colors{};
+        static thread_local List<u8> lineColors{};
+        static thread_local List<u8> curveColors{};
+        static thread_local List<u8> cubicColors{};
+        static thread_local List<_MsdfChannel> channels{};
+        static thread_local List<u8> inside{};
+        static thread_local List<_Intercept> rowIntercepts{};
         static thread_local List<_Row> rows{};
+        static thread_local List<s32> votes{};
+        static thread_local Contour transformed{};
+
+        packedOutline.pack(outline, transform);
+        FAIL_IF(!packedOutline.isValid());
+
+        // Color each contour's segments, split by type in the same order they were packed
+        // Corners are found on the transformed segments, as a transform that is not a similarity changes the angles between them
+        const bool identity{transform.isIdentity()};
+        lineColors.clear();
+        curveColors.clear();
+        cubicColors.clear();
+        for (const Contour & original : outline.contours)
+        {
+            const Contour * contourPtr{&original};
+            if (!identity)
+            {
+                transformed.segments.resize(original.segments.size());
+                for (u32 i{0u}; i < original.segments.size(); ++i)
+                {
+                    transformed.segments[i] = _transformed(original.segments[i], transform);
+                }
+                contourPtr = &transformed;
+            }
+            const Contour & contour{*contourPtr};
 
-        FAIL_IF(!outline.isValid());
+            _colorEdges(contour, colors);
 
-        // Count total segments
-        u32 segmentN{0u};
-        for (const Contour & contour : outline.contours)
-        {
-            segmentN += contour.segments.size();
+            for (u32 i{0u}; i < contour.segments.size(); ++i)
+            {
+                switch (contour.segments[i].type)
+                {
+                    case SegmentType::line: lineColors.push_back(colors[i]); break;
+                    case SegmentType::curve: curveColors.push_back(colors[i]); break;
+                    case SegmentType::cubic: cubicColors.push_back(colors[i]); break;
+                }
+            }
         }
 
         // Reset buffers
         {
-            distances.resize(size * size);
-            for (f32 & distance : distances) distance = number::inf<float>;
+            channels.resize(size * size * 3u);
+            std::fill_n(channels.data(), channels.size(), _MsdfChannel{.distance2 = number::inf<f32>, .pseudoDistance = number::inf<f32>, .contourI = 0u});
+
+            inside.resize(size * size);
+            std::fill_n(inside.data(), inside.size(), u8(0u));
 
-            const u32 maxInterceptN{segmentN * 2u};
+            const u32 maxInterceptN{packedOutline.maxRowInterceptN};
             rowIntercepts.resize(size * maxInterceptN);
 
             rows.resize(size);
-            f32 * firstDistance{distances.data() + size * size - size};
-            f32 * firstIntercept{rowIntercepts.data()};
+            _Intercept * firstIntercept{rowIntercepts.data()};
             for (_Row & row : rows)
             {
-                row.distances = firstDistance;
+                row.distances = nullptr;
                 row.interceptN = 0u;
                 row.intercepts = firstIntercept;
 
-                firstDistance -= size;
                 firstIntercept += maxInterceptN;
             }
         }
 
-        // Process segments to calculate distances and row intersections
+        // Find each channel's closest edge, and collect row intercepts for the sign
 
         const f32 halfRange{range * 0.5f};
 
-        for (const Contour & contour : outline.contours)
+        for (u32 i{0u}, contourI{0u}; i < packedOutline.lines.size(); ++i)
         {
-            for (const Segment & segment : contour.segments)
-            {
-                _process(segment, size, halfRange, rows.data());
-            }
+            while (i >= packedOutline.contours[contourI].lineEnd) ++contourI;
 
-            // Explicitly and carefully add endpoints as intercepts if appropriate
-            _updatePointIntercepts(contour, rows.data(), size);
+            const PackedOutline::LineEntry & entry{packedOutline.lines[i]};
+            _updateMsdf(entry.line, entry.ext, entry.bounds, lineColors[i], contourI, size, halfRange, channels.data());
+            _addIntercepts(entry.line, entry.ext, entry.bounds, size, rows.data());
         }
 
-        // Sqrt distances
+        for (u32 i{0u}, contourI{0u}; i < packedOutline.curves.size(); ++i)
+        {
+            while (i >= packedOutline.contours[contourI].curveEnd) ++contourI;
 
-        for (f32 & distance : distances)
+            const PackedOutline::CurveEntry & entry{packedOutline.curves[i]};
+            _updateMsdf(entry.curve, entry.ext, entry.bounds, curveColors[i], contourI, size, halfRange, channels.data());
+            _addIntercepts(entry.curve, entry.ext, entry.bounds, size, rows.data());
+        }
+
+        for (u32 i{0u}, contourI{0u}; i < packedOutline.cubics.size(); ++i)
         {
-            distance = std::sqrt(distance);
+            while (i >= packedOutline.contours[contourI].cubicEnd) ++contourI;
+
+            const PackedOutline::CubicEntry & entry{packedOutline.cubics[i]};
+            _updateMsdf(entry.cubic, entry.ext, entry.bounds, cubicColors[i], contourI, size, halfRange, channels.data());
+            _addIntercepts(entry.cubic, entry.ext, entry.bounds, size, rows.data());
         }
 
-        // Sort row intersections and invert internal distances
+        for (const PackedOutline::VertexEntry & vertex : packedOutline.vertices)
+        {
+            _updateVertexIntercepts(vertex, rows.data(), size);
+        }
 
-        for (_Row & row : rows)
+        for (u32 y{0u}; y < size; ++y)
+        {
+            u8 * const insideRow{inside.data() + u64(y) * size};
+            _forInsideSpans(rows[y], size, packedOutline.fillRule, [insideRow](const s32 beginX, const s32 endX)
+            {
+                std::fill(insideRow + beginX, insideRow + endX + 1, u8(1u));
+            });
+        }
+
+        // Contours may wind either way, so each contour's orientation is voted on by the pixels whose closest point is squarely on one of its edges
+
+        votes.resize(packedOutline.contours.size());
+        std::fill_n(votes.data(), votes.size(), 0);
+
+        for (u64 i{0u}; i < u64(size) * size; ++i)
+        {
+            const _MsdfChannel * const pixel{channels.data() + i * 3u};
+            const _MsdfChannel & closest{*std::min_element(pixel, pixel + 3, [](const _MsdfChannel & a, const _MsdfChannel & b) { return a.distance2 < b.distance2; })};
+
+            if (closest.distance2 > 1.0e-6f && closest.distance2 < number::inf<f32> && closest.pseudoDistance * closest.pseudoDistance >= 0.99f * closest.distance2)
+            {
+                votes[closest.contourI] += (closest.pseudoDistance < 0.0f) == bool(inside[i]) ? 1 : -1;
+            }
+        }
+
+        // Convert to color image
+
+        RgbImage image{size, size};
+
+        const f32 invRange{1.0f / range};
+        const f32 halfRange2{halfRange * halfRange};
+
+        for (u32 y{0u}; y < size; ++y)
         {
-            std::sort(row.intercepts, row.intercepts + row.interceptN);
+            const _MsdfChannel * const srcRow{channels.data() + u64(y) * size * 3u};
+            const u8 * const insideRow{inside.data() + u64(y) * size};
+            ucvec3 * const dstRow{image.row(s32(y))};
 
-            // There should always be an even number of intercepts
-            if (row.interceptN % 2u)
+            for (u32 x{0u}; x < size; ++x)
             {
-                if constexpr (debug)
+                const bool isInside{bool(insideRow[x])};
+
+                // Channels with no edge in range are just inside or outside
+                fvec3 distances;
+                for (u32 c{0u}; c < 3u; ++c)
                 {
-                    ABORT();
+                    const _MsdfChannel & channel{srcRow[x * 3u + c]};
+                    if (channel.distance2 <= halfRange2)
+                    {
+                        distances[c] = votes[channel.contourI] >= 0 ? channel.pseudoDistance : -channel.pseudoDistance;
+                    }
+                    else
+                    {
+                        distances[c] = isInside ? -number::inf<f32> : number::inf<f32>;
+                    }
                 }
-                else
+
+                // Where the median disagrees with the scanline sign, the channels are flipped to match
+                const f32 median{_median(distances.x, distances.y, distances.z)};
+                if (median != 0.0f && (median < 0.0f) != isInside)
                 {
-                    --row.interceptN;
+                    distances = -distances;
                 }
+
+                dstRow[x] = ucvec3{transnorm<u8>(0.5f - distances.x * invRange), transnorm<u8>(0.5f - distances.y * invRange), transnorm<u8>(0.5f - distances.z * invRange)};
+            }
+        }
+
+        return image;
+    }
+
+    GrayImage generateFromMask(const GrayImage::CView & mask, const f32 range, Executor & executor)
+    {
+        // Bound to references so the passes, which run on other threads, use this thread's buffers rather than their own
+        static thread_local List<f32> inDistanceBuffer{};
+        static thread_local List<f32> outDistanceBuffer{};
+        List<f32> & inDistances{inDistanceBuffer};
+        List<f32> & outDistances{outDistanceBuffer};
+
+        const u32 width{mask.width()};
+        const u32 height{mask.height()};
+
+        FAIL_IF(!width || !height);
+
+        inDistances.resize(u64(width) * height);
+        outDistances.resize(u64(width) * height);
+
+        // Row pass. `inDistances` is distance to nearest inside pixel, `outDistances` to nearest outside pixel
+
+        executor.parallelFor(height, 32u, [&](const u32 beginY, const u32 endY)
+        {
+            static thread_local List<f32> f{};
+            static thread_local List<u32> v{};
+            static thread_local List<f64> z{};
+            f.resize(width);
+            v.resize(width);
+            z.resize(width + 1u);
+
+            for (u32 y{beginY}; y < endY; ++y)
+            {
+                const u8 * const maskRow{mask.row(s32(y))};
+                f32 * const inRow{inDistances.data() + u64(y) * width};
+                f32 * const outRow{outDistances.data() + u64(y) * width};
+
+                for (u32 x{0u}; x < width; ++x) f[x] = maskRow[x] >= 128u ? 0.0f : _edtInf;
+                _edt(f.data(), inRow, width, v.data(), z.data());
+
+                for (u32 x{0u}; x < width; ++x) f[x] = maskRow[x] >= 128u ? _edtInf : 0.0f;
+                _edt(f.data(), outRow, width, v.data(), z.data());
             }
+        });
+
+        // Column pass, done in strips gathered into contiguous columns, and conversion to grayscale
+
+        GrayImage image{width, height};
+        const GrayImage::View imageView{image.view()};
+        const f32 invRange{1.0f / range};
+        const u32 stripN{(width + _edtStripWidth - 1u) / _edtStripWidth};
 
-            for (u32 i{1u}; i < row.interceptN; i += 2u)
+        executor.parallelFor(stripN, 1u, [&](const u32 beginStrip, const u32 endStrip)
+        {
+            static thread_local List<f32> columns{};
+            static thread_local List<f32> d{};
+            static thread_local List<u32> v{};
+            static thread_local List<f64> z{};
+            columns.resize(2u * _edtStripWidth * height);
+            d.resize(height);
+            v.resize(height);
+            z.resize(height + 1u);
+
+            for (u32 strip{beginStrip}; strip < endStrip; ++strip)
             {
-                const fspan1 xSpan{row.intercepts[i - 1u], row.intercepts[i]};
-                ispan1 xSpanPx{ceil<s32>(xSpan.min - 0.5f), floor<s32>(xSpan.max - 0.5f)};
-                clampify(xSpanPx, 0, s32(size) - 1);
-                for (s32 xPx{xSpanPx.min}; xPx <= xSpanPx.max; ++xPx)
+                const u32 x0{strip * _edtStripWidth};
+                const u32 stripWidth{min(_edtStripWidth, width - x0)};
+                f32 * const inColumns{columns.data()};
+                f32 * const outColumns{inColumns + _edtStripWidth * height};
+
+                for (u32 y{0u}; y < height; ++y)
                 {
-                    f32 & distance{row.distances[xPx]};
-                    distance = -distance;
+                    const f32 * const inRow{inDistances.data() + u64(y) * width + x0};
+                    const f32 * const outRow{outDistances.data() + u64(y) * width + x0};
+                    for (u32 i{0u}; i < stripWidth; ++i)
+                    {
+                        inColumns[i * height + y] = inRow[i];
+                        outColumns[i * height + y] = outRow[i];
+                    }
+                }
+
+                for (u32 i{0u}; i < stripWidth; ++i)
+                {
+                    f32 * const inColumn{inColumns + i * height};
+                    f32 * const outColumn{outColumns + i * height};
+
+                    _edt(inColumn, d.data(), height, v.data(), z.data());
+                    std::copy_n(d.data(), height, inColumn);
+
+                    _edt(outColumn, d.data(), height, v.data(), z.data());
+                    std::copy_n(d.data(), height, outColumn);
+                }
+
+                for (u32 y{0u}; y < height; ++y)
+                {
+                    u8 * const dst{imageView.row(s32(y)) + x0};
+                    for (u32 i{0u}; i < stripWidth; ++i)
+                    {
+                        const f32 inDist2{inColumns[i * height + y]};
+                        const f32 distance{inDist2 == 0.0f ? 0.5f - std::sqrt(outColumns[i * height + y]) : std::sqrt(inDist2) - 0.5f};
+                        dst[i] = transnorm<u8>(0.5f - distance * invRange);
+                    }
                 }
             }
+        });
+
+        if (u64(inDistances.size()) * sizeof(f32) > _edtRetainedByteN)
+        {
+            inDistances = {};
+            outDistances = {};
         }
 
-        // Convert to grayscale image
+        return image;
+    }
 
-        GrayImage image{size, size};
+    bool rasterize(const Outline & outline, const GrayImage::View & view)
+    {
+        static thread_local List<f32> accumulation{};
 
-        const f32 * src{distances.data()};
-        const f32 * const srcEnd{src + size * size};
-        u8 * dst{image.pixels()};
-        const f32 invRange{1.0f / range};
+        FAIL_IF(!outline.isValid());
+
+        const u32 width{view.width()};
+        const u32 height{view.height()};
+        const u32 pitch{width + 2u};
+
+        accumulation.resize(pitch * height);
+        std::fill(accumulation.begin(), accumulation.end(), 0.0f);
+
+        for (const Contour & contour : outline.contours)
+        {
+            for (const Segment & segment : contour.segments)
+            {
+                switch (segment.type)
+                {
+                    case SegmentType::line: _rasterize(segment.line, accumulation.data(), pitch, width, height); break;
+                    case SegmentType::curve: _rasterize(segment.curve, accumulation.data(), pitch, width, height); break;
+                    case SegmentType::cubic: _rasterize(segment.cubic, accumulation.data(), pitch, width, height); break;
+                }
+            }
+        }
 
-        for (; src < srcEnd; ++src, ++dst)
+        // Integrate each row into coverage
+
+        for (u32 y{0u}; y < height; ++y)
         {
-            *dst = transnorm<u8>(0.5f - *src * invRange);
+            const f32 * const src{accumulation.data() + y * pitch};
+            u8 * const dst{view.row(s32(y))};
+            f32 sum{0.0f};
+            for (u32 x{0u}; x < width; ++x)
+            {
+                sum += src[x];
+                dst[x] = transnorm<u8>(min(abs(sum), 1.0f));
+            }
         }
 
-        return image;
+        return true;
     }
+
+    // Explicit template specialization
+
+    template Image<u8, 1u> generate<u8>(const Outline &, u32, f32, GenerateStats *);
+    template Image<u16, 1u> generate<u16>(const Outline &, u32, f32, GenerateStats *);
+    template Image<f32, 1u> generate<f32>(const Outline &, u32, f32, GenerateStats *);
+
+    template Image<u8, 1u> generate<u8>(const PackedOutline &, u32, f32, GenerateStats *);
+    template Image<u16, 1u> generate<u16>(const PackedOutline &, u32, f32, GenerateStats *);
+    template Image<f32, 1u> generate<f32>(const PackedOutline &, u32, f32, GenerateStats *);
+
+    template Image<u8, 1u> generate<u8>(const Outline &, const Transform &, u32, f32, GenerateStats *);
+    template Image<u16, 1u> generate<u16>(const Outline &, const Transform &, u32, f32, GenerateStats *);
+    template Image<f32, 1u> generate<f32>(const Outline &, const Transform &, u32, f32, GenerateStats *);
+
+    template bool generate<u8>(const PackedOutline &, const ImageView<u8, 1u, false> &, f32, GenerateStats *);
+    template bool generate<u16>(const PackedOutline &, const ImageView<u16, 1u, false> &, f32, GenerateStats *);
+    template bool generate<f32>(const PackedOutline &, const ImageView<f32, 1u, false> &, f32, GenerateStats *);
+
+    template List<Image<u8, 1u>> generateLevels<u8>(const Outline &, f32, const u32 *, u32, f32);
+    template List<Image<u16, 1u>> generateLevels<u16>(const Outline &, f32, const u32 *, u32, f32);
+    template List<Image<f32, 1u>> generateLevels<f32>(const Outline &, f32, const u32 *, u32, f32);
+
+    template bool generateLevels<u8>(const Outline &, f32, const ImageView<u8, 1u, false> *, u32, f32);
+    template bool generateLevels<u16>(const Outline &, f32, const ImageView<u16, 1u, false> *, u32, f32);
+    template bool generateLevels<f32>(const Outline &, f32, const ImageView<f32, 1u, false> *, u32, f32);
 }
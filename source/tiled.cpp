@@ -0,0 +1,125 @@
+#include <qc-image/tiled.hpp>
+
+#include <qc-image/parallel.hpp>
+
+namespace qci
+{
+    namespace
+    {
+        // Most runs are a whole tile row, which as a fixed size copy compiles down to a few moves
+        template <typename Pixel, u32 tileSize>
+        finline void _copyRun(const Pixel * const src, Pixel * const dst, const u32 length)
+        {
+            if (length == tileSize)
+            {
+                std::copy_n(src, tileSize, dst);
+            }
+            else
+            {
+                std::copy_n(src, length, dst);
+            }
+        }
+    }
+
+    template <Numeric T, u32 n>
+    void TiledImage<T, n>::fill(const Pixel & color)
+    {
+        std::fill_n(_pixels, u64(_tileCounts.x) * _tileCounts.y * tilePixelN, color);
+    }
+
+    template <Numeric T, u32 n>
+    void TiledImage<T, n>::copy(const ImageView<T, n, true> & src, const ivec2 pos, Executor & executor)
+    {
+        const ispan2 span{ispan2{pos, pos + ivec2(src.size())} & ispan2{ivec2{}, ivec2(_size)}};
+        if (span.min.x >= span.max.x || span.min.y >= span.max.y)
+        {
+            return;
+        }
+
+        const u32 beginTileY{u32(span.min.y) / tileSize};
+        const u32 endTileY{(u32(span.max.y) + tileSize - 1u) / tileSize};
+
+        // Each band of tile rows is read as whole image rows and scattered across the band's tiles, so both sides stay sequential
+        executor.parallelFor(endTileY - beginTileY, 4u, [&](const u32 beginBand, const u32 endBand)
+        {
+            for (u32 tileY{beginTileY + beginBand}; tileY < beginTileY + endBand; ++tileY)
+            {
+                const s32 beginY{max(s32(tileY * tileSize), span.min.y)};
+                const s32 endY{min(s32((tileY + 1u) * tileSize), span.max.y)};
+
+                for (s32 y{beginY}; y < endY; ++y)
+                {
+                    const Pixel * const srcRow{src.row(y - pos.y) - pos.x};
+
+                    for (s32 x{span.min.x}; x < span.max.x;)
+                    {
+                        const u32 tileX{u32(x) / tileSize};
+                        const s32 runEnd{min(s32((tileX + 1u) * tileSize), span.max.x)};
+                        Pixel * const dstRun{tileRow(ivec2{s32(tileX), s32(tileY)}, u32(y) % tileSize) + u32(x) % tileSize};
+                        _copyRun<Pixel, tileSize>(srcRow + x, dstRun, u32(runEnd - x));
+                        x = runEnd;
+                    }
+                }
+            }
+        });
+    }
+
+    template <Numeric T, u32 n>
+    void TiledImage<T, n>::copyTo(const ImageView<T, n, false> & dst, const ivec2 pos, Executor & executor) const
+    {
+        const ispan2 span{ispan2{pos, pos + ivec2(dst.size())} & ispan2{ivec2{}, ivec2(_size)}};
+        if (span.min.x >= span.max.x || span.min.y >= span.max.y)
+        {
+            return;
+        }
+
+        const u32 beginTileY{u32(span.min.y) / tileSize};
+        const u32 endTileY{(u32(span.max.y) + tileSize - 1u) / tileSize};
+
+        executor.parallelFor(endTileY - beginTileY, 4u, [&](const u32 beginBand, const u32 endBand)
+        {
+            for (u32 tileY{beginTileY + beginBand}; tileY < beginTileY + endBand; ++tileY)
+            {
+                const s32 beginY{max(s32(tileY * tileSize), span.min.y)};
+                const s32 endY{min(s32((tileY + 1u) * tileSize), span.max.y)};
+
+                for (s32 y{beginY}; y < endY; ++y)
+                {
+                    Pixel * const dstRow{dst.row(y - pos.y) - pos.x};
+
+                    for (s32 x{span.min.x}; x < span.max.x;)
+                    {
+                        const u32 tileX{u32(x) / tileSize};
+                        const s32 runEnd{min(s32((tileX + 1u) * tileSize), span.max.x)};
+                        const Pixel * const srcRun{tileRow(ivec2{s32(tileX), s32(tileY)}, u32(y) % tileSize) + u32(x) % tileSize};
+                        _copyRun<Pixel, tileSize>(srcRun, dstRow + x, u32(runEnd - x));
+                        x = runEnd;
+                    }
+                }
+            }
+        });
+    }
+
+    template <Numeric T, u32 n>
+    Image<T, n> TiledImage<T, n>::toImage(Executor & executor) const
+    {
+        Image<T, n> image{_size};
+        copyTo(image.view(), {}, executor);
+        return image;
+    }
+
+    // Explicit template specialization
+
+    template class TiledImage<u8, 1u>;
+    template class TiledImage<u8, 2u>;
+    template class TiledImage<u8, 3u>;
+    template class TiledImage<u8, 4u>;
+    template class TiledImage<u16, 1u>;
+    template class TiledImage<u16, 2u>;
+    template class TiledImage<u16, 3u>;
+    template class TiledImage<u16, 4u>;
+    template class TiledImage<f32, 1u>;
+    template class TiledImage<f32, 2u>;
+    template class TiledImage<f32, 3u>;
+    template class TiledImage<f32, 4u>;
+}
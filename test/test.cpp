@@ -1,7 +1,2603 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <qc-core/utils.hpp>
+
+#include <qc-image/async.hpp>
+#include <qc-image/bc.hpp>
+#include <qc-image/compare.hpp>
+#include <qc-image/font.hpp>
 #include <qc-image/image.hpp>
+#include <qc-image/mapped.hpp>
+#include <qc-image/parallel.hpp>
+#include <qc-image/png.hpp>
+#include <qc-image/sdf.hpp>
+#include <qc-image/tiled.hpp>
+
+// From stb_image and stb_image_write, which are built into the library, so the built-in PNG decoder can be checked against them
+extern "C"
+{
+    unsigned char * stbi_load_from_memory(const unsigned char * buffer, int len, int * x, int * y, int * channelsInFile, int desiredChannels);
+    unsigned short * stbi_load_16_from_memory(const unsigned char * buffer, int len, int * x, int * y, int * channelsInFile, int desiredChannels);
+    unsigned char * stbi_zlib_compress(unsigned char * data, int dataLen, int * outLen, int quality);
+}
+
+namespace
+{
+    // Not a multiple of four in either dimension, so edge block padding is covered
+    constexpr qc::uivec2 bcSize{67u, 45u};
+
+    // Blocks start from the top row, while image rows are bottom up
+    qc::uivec2 bcBlockPos(const qc::u32 x, const qc::u32 y)
+    {
+        return {x / 4u, (bcSize.y - 1u - y) / 4u};
+    }
+
+    // Squared error of a block must be no worse than the eight step palette spanning the block's range, which every encoding may pick
+    void checkBc4Blocks(const qci::GrayImage & src, const qci::GrayImage & decoded)
+    {
+        ABORT_IF(decoded.size() != bcSize || src.size() != bcSize);
+
+        constexpr qc::u32 blockCountX{(bcSize.x + 3u) / 4u};
+        constexpr qc::u32 blockCountY{(bcSize.y + 3u) / 4u};
+        int lo[blockCountY][blockCountX];
+        int hi[blockCountY][blockCountX];
+        double error2[blockCountY][blockCountX]{};
+        std::fill_n(&lo[0][0], blockCountX * blockCountY, 255);
+        std::fill_n(&hi[0][0], blockCountX * blockCountY, 0);
+
+        for (qc::u32 y{0u}; y < bcSize.y; ++y)
+        {
+            for (qc::u32 x{0u}; x < bcSize.x; ++x)
+            {
+                const qc::uivec2 block{bcBlockPos(x, y)};
+                const int v{src.at(x, y)};
+                const double diff{double(v - int(decoded.at(x, y)))};
+                lo[block.y][block.x] = std::min(lo[block.y][block.x], v);
+                hi[block.y][block.x] = std::max(hi[block.y][block.x], v);
+                error2[block.y][block.x] += diff * diff;
+            }
+        }
+
+        for (qc::u32 blockY{0u}; blockY < blockCountY; ++blockY)
+        {
+            for (qc::u32 blockX{0u}; blockX < blockCountX; ++blockX)
+            {
+                // Each texel is within half a step of the eight step palette, plus rounding
+                const double maxStepError{double(hi[blockY][blockX] - lo[blockY][blockX]) / 14.0 + 1.0};
+                ABORT_IF(error2[blockY][blockX] > 16.0 * maxStepError * maxStepError);
+            }
+        }
+    }
+
+    void testBc()
+    {
+        // BC4, over blocks of noise, gradients, near constant values, and values wrapping from 255 to 0
+        {
+            qci::GrayImage image{bcSize};
+            for (qc::u32 y{0u}; y < bcSize.y; ++y)
+            {
+                for (qc::u32 x{0u}; x < bcSize.x; ++x)
+                {
+                    const qc::uivec2 block{bcBlockPos(x, y)};
+                    const qc::u32 hash{(x * 73856093u) ^ (y * 19349663u)};
+                    switch ((block.x + block.y * 17u) % 4u)
+                    {
+                        case 0u: image.at(x, y) = qc::u8(hash >> 7); break;
+                        case 1u: image.at(x, y) = qc::u8(x * 3u + y * 2u); break;
+                        case 2u: image.at(x, y) = qc::u8(100u + hash % 9u); break;
+                        default: image.at(x, y) = qc::u8(x % 2u ? 0u : 255u); break;
+                    }
+                }
+            }
+
+            const qci::bc::CompressedImage compressed{qci::bc::encodeBc4(image.view())};
+            ABORT_IF(compressed.format != qci::bc::Format::bc4);
+            ABORT_IF(compressed.data.size() != 17u * 12u * 8u);
+            checkBc4Blocks(image, qci::bc::decodeBc4(compressed));
+        }
+
+        // BC1 and BC3, with each block a single color, which must come back within the rounding of the 5:6:5 endpoints
+        {
+            qci::RgbaImage image{bcSize};
+            for (qc::u32 y{0u}; y < bcSize.y; ++y)
+            {
+                for (qc::u32 x{0u}; x < bcSize.x; ++x)
+                {
+                    const qc::uivec2 block{bcBlockPos(x, y)};
+                    const qc::u32 hash{(block.x * 73856093u) ^ (block.y * 19349663u)};
+                    image.at(x, y) = qc::ucvec4{qc::u8(hash), qc::u8(hash >> 8), qc::u8(hash >> 16), qc::u8(hash >> 24)};
+                }
+            }
+
+            const qci::RgbaImage bc1{qci::bc::decodeBc1(qci::bc::encodeBc1(image.view()))};
+            const qci::RgbaImage bc3{qci::bc::decodeBc3(qci::bc::encodeBc3(image.view()))};
+            ABORT_IF(bc1.size() != bcSize || bc3.size() != bcSize);
+
+            for (qc::u32 y{0u}; y < bcSize.y; ++y)
+            {
+                for (qc::u32 x{0u}; x < bcSize.x; ++x)
+                {
+                    const qc::ivec4 src{image.at(x, y)};
+                    for (const qci::RgbaImage * const decoded : {&bc1, &bc3})
+                    {
+                        const qc::ivec4 diff{qc::ivec4{decoded->at(x, y)} - src};
+                        ABORT_IF(std::abs(diff.x) > 4 || std::abs(diff.y) > 2 || std::abs(diff.z) > 4);
+                    }
+                    // BC1 is opaque, and BC3 alpha is exact for a constant block
+                    ABORT_IF(bc1.at(x, y).w != 255u);
+                    ABORT_IF(bc3.at(x, y).w != src.w);
+                }
+            }
+        }
+
+        // BC1 and BC3 over a smooth opaque gradient
+        {
+            qci::RgbaImage image{128u, 96u};
+            for (qc::u32 y{0u}; y < 96u; ++y)
+            {
+                for (qc::u32 x{0u}; x < 128u; ++x)
+                {
+                    image.at(x, y) = qc::ucvec4{qc::u8(x * 2u), qc::u8(y * 2u + x / 2u), qc::u8(255u - x), 255u};
+                }
+            }
+
+            const qc::Result<qci::ImageDiff> bc1Diff{qci::compare(image, qci::bc::decodeBc1(qci::bc::encodeBc1(image.view())))};
+            const qc::Result<qci::ImageDiff> bc3Diff{qci::compare(image, qci::bc::decodeBc3(qci::bc::encodeBc3(image.view())))};
+            ABORT_IF(!bc1Diff || !bc3Diff);
+            ABORT_IF(bc1Diff->psnr < 40.0 || bc3Diff->psnr < 40.0);
+        }
+
+        // DDS header
+        {
+            qci::GrayImage image{bcSize};
+            image.fill(qc::u8(7u));
+            const qci::bc::CompressedImage compressed{qci::bc::encodeBc4(image.view())};
+
+            const std::filesystem::path file{std::filesystem::temp_directory_path() / "qc-image-test.dds"};
+            ABORT_IF(!qci::bc::writeDds(compressed, file));
+            const qc::Result<qc::List<qc::u8>> data{qc::utils::readFile(file)};
+            std::filesystem::remove(file);
+            ABORT_IF(!data);
+            ABORT_IF(data->size() != 128u + compressed.data.size());
+
+            const auto u32At{[&data](const qc::u32 offset) -> qc::u32
+            {
+                const qc::u8 * const p{data->data() + offset};
+                return qc::u32(p[0]) | (qc::u32(p[1]) << 8) | (qc::u32(p[2]) << 16) | (qc::u32(p[3]) << 24);
+            }};
+            ABORT_IF(std::memcmp(data->data(), "DDS ", 4u));
+            ABORT_IF(u32At(4u) != 124u);
+            ABORT_IF(u32At(12u) != bcSize.y || u32At(16u) != bcSize.x);
+            ABORT_IF(u32At(20u) != compressed.data.size());
+            ABORT_IF(u32At(76u) != 32u);
+            ABORT_IF(std::memcmp(data->data() + 84u, "BC4U", 4u));
+            ABORT_IF(!std::equal(compressed.data.begin(), compressed.data.end(), data->begin() + 128));
+        }
+    }
+
+    struct PngParams
+    {
+        qc::u32 colorType;
+        qc::u32 bitDepth;
+        bool transparency;
+        // Stored deflate blocks, rather than stb_image_write's fixed Huffman codes
+        bool stored;
+    };
+
+    qc::u32 pngCrc(const qc::u8 * const data, const qc::u32 size)
+    {
+        qc::u32 crc{0xFFFFFFFFu};
+        for (qc::u32 i{0u}; i < size; ++i)
+        {
+            crc ^= data[i];
+            for (qc::u32 bit{0u}; bit < 8u; ++bit)
+            {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+        }
+        return ~crc;
+    }
+
+    void appendU32BigEndian(qc::List<qc::u8> & dst, const qc::u32 v)
+    {
+        dst.push_back(qc::u8(v >> 24));
+        dst.push_back(qc::u8(v >> 16));
+        dst.push_back(qc::u8(v >> 8));
+        dst.push_back(qc::u8(v));
+    }
+
+    void appendBytes(qc::List<qc::u8> & dst, const qc::u8 * const data, const qc::u32 size)
+    {
+        for (qc::u32 i{0u}; i < size; ++i)
+        {
+            dst.push_back(data[i]);
+        }
+    }
+
+    void appendPngChunk(qc::List<qc::u8> & png, const char * const type, const qc::u8 * const data, const qc::u32 size)
+    {
+        appendU32BigEndian(png, size);
+        const qc::u32 start{png.size()};
+        appendBytes(png, std::bit_cast<const qc::u8 *>(type), 4u);
+        appendBytes(png, data, size);
+        appendU32BigEndian(png, pngCrc(png.data() + start, size + 4u));
+    }
+
+    qc::u32 adler32(const qc::List<qc::u8> & data)
+    {
+        qc::u32 a{1u}, b{0u};
+        for (const qc::u8 v : data)
+        {
+            a = (a + v) % 65521u;
+            b = (b + a) % 65521u;
+        }
+        return (b << 16) | a;
+    }
+
+    qc::List<qc::u8> zlibStored(const qc::List<qc::u8> & data)
+    {
+        qc::List<qc::u8> zlib{};
+        zlib.push_back(0x78u);
+        zlib.push_back(0x01u);
+        // Small blocks, so there are several
+        constexpr qc::u32 blockSize{997u};
+        for (qc::u32 offset{0u}; offset < data.size(); offset += blockSize)
+        {
+            const qc::u32 size{std::min(data.size() - offset, blockSize)};
+            zlib.push_back(offset + size == data.size());
+            zlib.push_back(qc::u8(size));
+            zlib.push_back(qc::u8(size >> 8));
+            zlib.push_back(qc::u8(~size));
+            zlib.push_back(qc::u8(~size >> 8));
+            appendBytes(zlib, data.data() + offset, size);
+        }
+
+        appendU32BigEndian(zlib, adler32(data));
+
+        return zlib;
+    }
+
+    // Deflate bit stream, least significant bit first
+    struct BitWriter
+    {
+        qc::List<qc::u8> bytes{};
+        qc::u32 bitN{};
+
+        void put(const qc::u32 value, const qc::u32 n)
+        {
+            for (qc::u32 i{0u}; i < n; ++i, ++bitN)
+            {
+                if (!(bitN % 8u)) bytes.push_back(0u);
+                bytes.back() = qc::u8(bytes.back() | (((value >> i) & 1u) << (bitN % 8u)));
+            }
+        }
+
+        // Huffman codes go most significant bit first
+        void putCode(const qc::u32 code, const qc::u32 length)
+        {
+            for (qc::u32 i{length}; i-- > 0u;)
+            {
+                put(code >> i, 1u);
+            }
+        }
+    };
+
+    // Canonical Huffman codes for the code lengths, as deflate assigns them
+    void huffmanCodes(const qc::u8 * const lengths, const qc::u32 symbolN, qc::u32 * const codes)
+    {
+        qc::u32 counts[16]{};
+        for (qc::u32 i{0u}; i < symbolN; ++i) ++counts[lengths[i]];
+        counts[0] = 0u;
+
+        qc::u32 nextCodes[16]{};
+        for (qc::u32 length{1u}, code{0u}; length < 16u; ++length)
+        {
+            code = (code + counts[length - 1u]) << 1;
+            nextCodes[length] = code;
+        }
+
+        for (qc::u32 i{0u}; i < symbolN; ++i)
+        {
+            if (lengths[i]) codes[i] = nextCodes[lengths[i]]++;
+        }
+    }
+
+    // Fixed Huffman block of just literals
+    void putFixedBlock(BitWriter & writer, const qc::u8 * const data, const qc::u32 size)
+    {
+        qc::u8 lengths[288];
+        std::fill_n(lengths, 144u, qc::u8(8u));
+        std::fill_n(lengths + 144, 112u, qc::u8(9u));
+        std::fill_n(lengths + 256, 24u, qc::u8(7u));
+        std::fill_n(lengths + 280, 8u, qc::u8(8u));
+        qc::u32 codes[288];
+        huffmanCodes(lengths, 288u, codes);
+
+        writer.put(0u, 1u);
+        writer.put(1u, 2u);
+        for (qc::u32 i{0u}; i < size; ++i) writer.putCode(codes[data[i]], lengths[data[i]]);
+        writer.putCode(codes[256], lengths[256]);
+    }
+
+    // Final dynamic Huffman block of just literals, with all 19 code length codes, so the header takes as many bits as it can
+    // @return the bit position the code length code lengths start at
+    qc::u32 putDynamicBlock(BitWriter & writer, const qc::u8 * const data, const qc::u32 size)
+    {
+        constexpr qc::u32 codeLengthOrder[19]{16u, 17u, 18u, 0u, 8u, 7u, 9u, 6u, 10u, 5u, 11u, 4u, 12u, 3u, 13u, 2u, 14u, 1u, 15u};
+
+        // Complete codes: thirteen of four bits and six of five, then 255 literals of eight bits, the last literal and end of block of nine
+        qc::u8 codeLengthLengths[19];
+        for (qc::u32 i{0u}; i < 19u; ++i) codeLengthLengths[i] = i < 13u ? 4u : 5u;
+        qc::u8 lengths[257 + 2];
+        std::fill_n(lengths, 255u, qc::u8(8u));
+        lengths[255] = 9u;
+        lengths[256] = 9u;
+        // Two distance codes, neither used
+        lengths[257] = 1u;
+        lengths[258] = 1u;
+
+        qc::u32 codeLengthCodes[19];
+        qc::u32 codes[257];
+        huffmanCodes(codeLengthLengths, 19u, codeLengthCodes);
+        huffmanCodes(lengths, 257u, codes);
+
+        writer.put(1u, 1u);
+        writer.put(2u, 2u);
+        writer.put(257u - 257u, 5u);
+        writer.put(2u - 1u, 5u);
+        writer.put(19u - 4u, 4u);
+
+        const qc::u32 codeLengthStart{writer.bitN};
+        for (const qc::u32 symbol : codeLengthOrder) writer.put(codeLengthLengths[symbol], 3u);
+        for (const qc::u8 length : lengths) writer.putCode(codeLengthCodes[length], codeLengthLengths[length]);
+
+        for (qc::u32 i{0u}; i < size; ++i) writer.putCode(codes[data[i]], lengths[data[i]]);
+        writer.putCode(codes[256], lengths[256]);
+
+        return codeLengthStart;
+    }
+
+    // Each row uses the next of the five filter types, with pixels from a hash, a few of them repeating the first pixel so color keys are hit
+    qc::List<qc::u8> filteredPngRows(const PngParams & params, const qc::uivec2 size)
+    {
+        constexpr qc::u32 sampleNs[7]{1u, 0u, 3u, 1u, 2u, 0u, 4u};
+        const qc::u32 pixelBits{sampleNs[params.colorType] * params.bitDepth};
+        const qc::u32 rowSize{(size.x * pixelBits + 7u) / 8u};
+        const qc::u32 pixelSize{std::max(pixelBits / 8u, 1u)};
+
+        qc::List<qc::u8> prevRow{};
+        prevRow.resize(rowSize, qc::u8(0u));
+        qc::List<qc::u8> row{};
+        row.resize(rowSize);
+        qc::List<qc::u8> filtered{};
+
+        for (qc::u32 y{0u}; y < size.y; ++y)
+        {
+            for (qc::u32 i{0u}; i < rowSize; ++i)
+            {
+                const bool repeatsFirst{pixelBits >= 8u && (i / pixelSize) % 5u == 2u};
+                row[i] = repeatsFirst && y ? filtered[1u + i % pixelSize] : qc::u8(((i * 2654435761u) ^ (y * 40503u)) >> 13);
+            }
+
+            const qc::u32 filter{y % 5u};
+            filtered.push_back(qc::u8(filter));
+            for (qc::u32 i{0u}; i < rowSize; ++i)
+            {
+                const int a{i >= pixelSize ? row[i - pixelSize] : 0};
+                const int b{prevRow[i]};
+                const int c{i >= pixelSize ? prevRow[i - pixelSize] : 0};
+                int prediction{0};
+                switch (filter)
+                {
+                    case 1u: prediction = a; break;
+                    case 2u: prediction = b; break;
+                    case 3u: prediction = (a + b) / 2; break;
+                    case 4u:
+                    {
+                        const int p{a + b - c};
+                        const int pa{std::abs(p - a)}, pb{std::abs(p - b)}, pc{std::abs(p - c)};
+                        prediction = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+                        break;
+                    }
+                    default: break;
+                }
+                filtered.push_back(qc::u8(row[i] - prediction));
+            }
+
+            std::swap(row, prevRow);
+        }
+
+        return filtered;
+    }
+
+    // Wraps zlib data in a PNG, splitting it over several IDAT chunks, with an ancillary chunk to skip in between
+    qc::List<qc::u8> makePng(const PngParams & params, const qc::uivec2 size, const qc::List<qc::u8> & zlib, const qc::u8 * const firstPixel)
+    {
+        constexpr qc::u8 signature[8]{0x89u, 'P', 'N', 'G', '\r', '\n', 0x1Au, '\n'};
+        qc::List<qc::u8> png{};
+        appendBytes(png, signature, 8u);
+
+        qc::List<qc::u8> header{};
+        appendU32BigEndian(header, size.x);
+        appendU32BigEndian(header, size.y);
+        header.push_back(qc::u8(params.bitDepth));
+        header.push_back(qc::u8(params.colorType));
+        // Compression, filter, and interlace methods
+        header.resize(13u, qc::u8(0u));
+        appendPngChunk(png, "IHDR", header.data(), header.size());
+
+        if (params.colorType == 3u)
+        {
+            qc::u8 palette[256u * 3u];
+            for (qc::u32 i{0u}; i < 256u * 3u; ++i)
+            {
+                palette[i] = qc::u8(i * 37u + 11u);
+            }
+            appendPngChunk(png, "PLTE", palette, 3u << params.bitDepth);
+        }
+
+        if (params.transparency)
+        {
+            qc::List<qc::u8> transparency{};
+            if (params.colorType == 3u)
+            {
+                // Fewer entries than the palette, so the rest stay opaque
+                for (qc::u32 i{0u}; i < (1u << params.bitDepth) / 2u + 1u; ++i)
+                {
+                    transparency.push_back(qc::u8(i * 91u));
+                }
+            }
+            else
+            {
+                // The first pixel's color, so the key matches
+                const qc::u32 sampleN{params.colorType == 2u ? 3u : 1u};
+                for (qc::u32 c{0u}; c < sampleN; ++c)
+                {
+                    const qc::u32 key{params.bitDepth == 16u ? (qc::u32(firstPixel[c * 2u]) << 8) | firstPixel[c * 2u + 1u] : params.bitDepth == 8u ? firstPixel[c] : qc::u32(firstPixel[0] >> (8u - params.bitDepth))};
+                    transparency.push_back(qc::u8(key >> 8));
+                    transparency.push_back(qc::u8(key));
+                }
+            }
+            appendPngChunk(png, "tRNS", transparency.data(), transparency.size());
+        }
+
+        const char text[]{"Comment\0test"};
+        appendPngChunk(png, "tEXt", std::bit_cast<const qc::u8 *>(&text[0]), sizeof(text) - 1u);
+
+        for (qc::u32 offset{0u}, chunkSize{1u}; offset < zlib.size(); offset += chunkSize, chunkSize *= 7u)
+        {
+            appendPngChunk(png, "IDAT", zlib.data() + offset, std::min(zlib.size() - offset, chunkSize));
+        }
+
+        appendPngChunk(png, "IEND", nullptr, 0u);
+
+        return png;
+    }
+
+    qc::List<qc::u8> makePng(const PngParams & params, const qc::uivec2 size)
+    {
+        const qc::List<qc::u8> filtered{filteredPngRows(params, size)};
+
+        if (params.stored)
+        {
+            // The first row has filter type 0, so its data starts with the first pixel as is
+            return makePng(params, size, zlibStored(filtered), filtered.data() + 1);
+        }
+
+        int zlibSize{};
+        qc::u8 * const zlibData{stbi_zlib_compress(const_cast<qc::u8 *>(filtered.data()), int(filtered.size()), &zlibSize, 8)};
+        ABORT_IF(!zlibData);
+        qc::List<qc::u8> zlib{};
+        appendBytes(zlib, zlibData, qc::u32(zlibSize));
+        ::operator delete(zlibData);
+        return makePng(params, size, zlib, filtered.data() + 1);
+    }
+
+    // The value of the 8 bit gray interlaced test image at column `x` and row `y`, counting rows from the top as a PNG does
+    qc::u8 interlacedPngPixel(const qc::u32 x, const qc::u32 y)
+    {
+        return qc::u8(x * 7u + y * 29u);
+    }
+
+    // An 8 bit gray PNG with Adam7 interlacing, each pass's rows unfiltered
+    qc::List<qc::u8> makeInterlacedPng(const qc::uivec2 size)
+    {
+        // Start and step of each pass, in x and y
+        constexpr qc::u32 passes[7][4]{{0u, 0u, 8u, 8u}, {4u, 0u, 8u, 8u}, {0u, 4u, 4u, 8u}, {2u, 0u, 4u, 4u}, {0u, 2u, 2u, 4u}, {1u, 0u, 2u, 2u}, {0u, 1u, 1u, 2u}};
+
+        qc::List<qc::u8> filtered{};
+        for (const auto [startX, startY, stepX, stepY] : passes)
+        {
+            // Passes with no columns have no rows either
+            if (startX >= size.x)
+            {
+                continue;
+            }
+
+            for (qc::u32 y{startY}; y < size.y; y += stepY)
+            {
+                filtered.push_back(qc::u8(0u));
+                for (qc::u32 x{startX}; x < size.x; x += stepX)
+                {
+                    filtered.push_back(interlacedPngPixel(x, y));
+                }
+            }
+        }
+
+        qc::List<qc::u8> png{makePng(PngParams{0u, 8u, false, true}, size, zlibStored(filtered), nullptr)};
+        // The interlace method is the header's last byte, followed by the CRC of the chunk type and data
+        png[28] = qc::u8(1u);
+        const qc::u32 crc{pngCrc(png.data() + 12, 17u)};
+        for (qc::u32 i{0u}; i < 4u; ++i)
+        {
+            png[29u + i] = qc::u8(crc >> (24u - i * 8u));
+        }
+        return png;
+    }
+
+    // Decodes `png` row by row with `PngReader` and checks it matches stb_image, which is given `n` desired channels
+    template <typename T, qc::u32 n>
+    void checkPngMatchesStb(const qc::List<qc::u8> & png)
+    {
+        int width{}, height{}, channels{};
+        T * const expected{[&]()
+        {
+            if constexpr (sizeof(T) == 1u) return stbi_load_from_memory(png.data(), int(png.size()), &width, &height, &channels, int(n));
+            else return stbi_load_16_from_memory(png.data(), int(png.size()), &width, &height, &channels, int(n));
+        }()};
+        ABORT_IF(!expected);
+
+        const qc::uivec2 size{qc::u32(width), qc::u32(height)};
+        qci::PngReader reader{};
+        ABORT_IF(!reader.open(png.data(), png.size()));
+        ABORT_IF(reader.size() != size);
+        ABORT_IF(reader.componentN() != qc::u32(channels));
+
+        qc::List<qci::Pixel<T, n>> row{};
+        row.resize(size.x);
+        const auto readRow{[&]() { return reader.readRow<T, n>(row.data(), 0u, size.x); }};
+        for (qc::u32 y{0u}; y < size.y; ++y)
+        {
+            ABORT_IF(!readRow());
+            ABORT_IF(std::memcmp(row.data(), expected + y * size.x * n, size.x * sizeof(qci::Pixel<T, n>)));
+        }
+        ABORT_IF(readRow());
+
+        ::operator delete(expected);
+    }
+
+    // Also checks `decodePng`, which takes only 8 bit files, against stb_image with the file's own channel count
+    template <qc::u32 n>
+    void checkDecodePngMatchesStb(const qc::List<qc::u8> & png)
+    {
+        int width{}, height{}, channels{};
+        qc::u8 * const expected{stbi_load_from_memory(png.data(), int(png.size()), &width, &height, &channels, int(n))};
+        ABORT_IF(!expected);
+
+        const qc::uivec2 size{qc::u32(width), qc::u32(height)};
+        const qc::Result<qci::Image<qc::u8, n>> image{qci::decodePng<qc::u8, n>(png.data(), png.size(), false)};
+        ABORT_IF(!image);
+        ABORT_IF(image->size() != size);
+        ABORT_IF(std::memcmp(image->pixels(), expected, size.x * size.y * n));
+
+        ::operator delete(expected);
+    }
+
+    void checkPngMatchesStb(const qc::List<qc::u8> & png, const qc::u32 componentN, const qc::u32 bitDepth)
+    {
+        switch (componentN)
+        {
+            case 1u: checkPngMatchesStb<qc::u8, 1u>(png); break;
+            case 2u: checkPngMatchesStb<qc::u8, 2u>(png); break;
+            case 3u: checkPngMatchesStb<qc::u8, 3u>(png); break;
+            default: checkPngMatchesStb<qc::u8, 4u>(png); break;
+        }
+
+        // Expanded to four components, as stb_image does
+        checkPngMatchesStb<qc::u8, 4u>(png);
+        checkPngMatchesStb<qc::u16, 4u>(png);
+
+        if (bitDepth == 8u)
+        {
+            switch (componentN)
+            {
+                case 1u: checkDecodePngMatchesStb<1u>(png); break;
+                case 2u: checkDecodePngMatchesStb<2u>(png); break;
+                case 3u: checkDecodePngMatchesStb<3u>(png); break;
+                default: checkDecodePngMatchesStb<4u>(png); break;
+            }
+        }
+    }
+
+    // Decodes corrupted data, which only has to fail cleanly, and is most useful run with sanitizers
+    void decodeCorruptPng(const qc::List<qc::u8> & png)
+    {
+        static_cast<void>(qci::decodePng<qc::u8, 4u>(png.data(), png.size(), true));
+
+        qci::PngReader reader{};
+        if (reader.open(png.data(), png.size()))
+        {
+            qc::List<qc::ucvec4> row{};
+            row.resize(reader.size().x);
+            while (reader.readRow<qc::u8, 4u>(row.data(), 0u, qc::u32(row.size())));
+        }
+    }
+
+    // The built-in decoder must match stb_image over every color type, bit depth, filter, and deflate block type
+    void testPng()
+    {
+        // Odd width, so rows of low bit depths end partway through a byte
+        constexpr qc::uivec2 size{37u, 23u};
+        // Color type and bit depth
+        constexpr qc::u32 formats[][2]{
+            {0u, 1u}, {0u, 2u}, {0u, 4u}, {0u, 8u}, {0u, 16u},
+            {2u, 8u}, {2u, 16u},
+            {3u, 1u}, {3u, 2u}, {3u, 4u}, {3u, 8u},
+            {4u, 8u}, {4u, 16u},
+            {6u, 8u}, {6u, 16u}};
+
+        qc::List<qc::List<qc::u8>> pngs{};
+        for (const auto [colorType, bitDepth] : formats)
+        {
+            for (const bool transparency : {false, true})
+            {
+                // Gray alpha and RGBA cannot have a tRNS chunk
+                if (transparency && (colorType == 4u || colorType == 6u))
+                {
+                    continue;
+                }
+
+                for (const bool stored : {false, true})
+                {
+                    const PngParams params{colorType, bitDepth, transparency, stored};
+                    const qc::u32 componentN{(colorType == 2u || colorType == 3u ? 3u : colorType == 6u ? 4u : colorType == 4u ? 2u : 1u) + transparency};
+                    pngs.push_back(makePng(params, size));
+                    checkPngMatchesStb(pngs.back(), componentN, bitDepth);
+                }
+            }
+        }
+
+        // Dynamic Huffman codes, as zlib writes them, for 16x8 8 bit gray rows of every filter type
+        {
+            constexpr qc::u8 zlib[]{
+                0x78u, 0xDAu, 0x05u, 0xC1u, 0x8Du, 0x1Au, 0x81u, 0x30u, 0x14u, 0x00u, 0xD0u, 0xDDu, 0xDDu, 0xBBu, 0xADu, 0xF5u,
+                0x67u, 0xA9u, 0x28u, 0x52u, 0x49u, 0x84u, 0xC8u, 0x17u, 0xF1u, 0x89u, 0xBCu, 0xFFu, 0x6Bu, 0x39u, 0x87u, 0x31u,
+                0x06u, 0x9Cu, 0xA4u, 0x76u, 0x4Du, 0x94u, 0xE6u, 0xF5u, 0xB9u, 0x7Fu, 0x03u, 0x03u, 0x40u, 0x52u, 0xDAu, 0x33u,
+                0x71u, 0x5Au, 0xD4u, 0x6Du, 0x3Fu, 0x72u, 0x00u, 0x8Eu, 0x42u, 0xD9u, 0x5Eu, 0x10u, 0xAFu, 0x8Au, 0x7Du, 0x7Bu,
+                0x1Fu, 0x91u, 0x73u, 0x24u, 0x69u, 0x39u, 0xFEu, 0x7Cu, 0xB1u, 0x2Eu, 0x0Fu, 0x97u, 0xC7u, 0x87u, 0x10u, 0x49u,
+                0x28u, 0xEDu, 0xCEu, 0xC2u, 0x65u, 0xB6u, 0x6Du, 0xAEu, 0xC3u, 0x97u, 0x21u, 0x91u, 0x54u, 0xB6u, 0x6Bu, 0xC2u,
+                0x24u, 0xABu, 0x9Au, 0x6Eu, 0x98u, 0x80u, 0x48u, 0x48u, 0xCBu, 0xF6u, 0x4Cu, 0x94u, 0x6Cu, 0xAAu, 0x63u, 0xF7u,
+                0x9Cu, 0xB8u, 0x10u, 0x52u, 0x69u, 0xC7u, 0x0Fu, 0xE2u, 0x34u, 0xDFu, 0x9Du, 0x6Eu, 0xAFu, 0xDFu, 0x1Fu, 0x9Bu,
+                0x3Cu, 0x0Au, 0xDEu};
+            qc::List<qc::u8> zlibList{};
+            appendBytes(zlibList, zlib, sizeof(zlib));
+            pngs.push_back(makePng(PngParams{0u, 8u, false, false}, qc::uivec2{16u, 8u}, zlibList, nullptr));
+            checkPngMatchesStb(pngs.back(), 1u, 8u);
+        }
+
+        // A dynamic block header at every bit alignment, as its 19 code length codes take 57 bits, more than one refill of the bit buffer
+        // Ahead of it go a fixed block with the first two bytes, of 26 or 27 bits depending on the second, and 10 bit empty fixed blocks
+        {
+            constexpr qc::uivec2 size{16u, 8u};
+            qc::List<qc::u8> filtered{filteredPngRows(PngParams{0u, 8u, false, false}, size)};
+            bool alignments[8]{};
+            for (const qc::u8 secondByte : {qc::u8(100u), qc::u8(200u)})
+            {
+                filtered[1] = secondByte;
+                for (qc::u32 emptyBlockN{0u}; emptyBlockN < 4u; ++emptyBlockN)
+                {
+                    BitWriter writer{};
+                    writer.put(0x0178u, 16u);
+                    putFixedBlock(writer, filtered.data(), 2u);
+                    for (qc::u32 i{0u}; i < emptyBlockN; ++i) putFixedBlock(writer, nullptr, 0u);
+                    alignments[putDynamicBlock(writer, filtered.data() + 2, filtered.size() - 2u) % 8u] = true;
+
+                    qc::List<qc::u8> zlib{writer.bytes};
+                    appendU32BigEndian(zlib, adler32(filtered));
+                    pngs.push_back(makePng(PngParams{0u, 8u, false, false}, size, zlib, nullptr));
+                    checkPngMatchesStb(pngs.back(), 1u, 8u);
+                }
+            }
+            ABORT_IF(std::count(std::begin(alignments), std::end(alignments), true) != 8);
+        }
+
+        // `readRegion` decodes interlaced files whole and crops them, but fails on other files `PngReader` refuses, such as with a second tRNS chunk
+        {
+            const std::filesystem::path file{std::filesystem::temp_directory_path() / "qc-image-test.png"};
+            const qc::ispan2 region{qc::ivec2{3, 2}, qc::ivec2{30, 17}};
+
+            const qc::List<qc::u8> interlaced{makeInterlacedPng(size)};
+            qci::PngReader interlacedReader{};
+            ABORT_IF(interlacedReader.open(interlaced.data(), interlaced.size()));
+            ABORT_IF(!qc::utils::writeFile(file, interlaced.data(), interlaced.size()));
+            const qc::Result<qci::GrayImage> cropped{qci::readRegion<qc::u8, 1u>(file, region, false)};
+            ABORT_IF(!cropped);
+            ABORT_IF(cropped->size() != qc::uivec2(region.size()));
+            for (qc::u32 y{0u}; y < cropped->height(); ++y)
+            {
+                for (qc::u32 x{0u}; x < cropped->width(); ++x)
+                {
+                    const qc::u8 expected{interlacedPngPixel(x + qc::u32(region.min.x), size.y - 1u - (y + qc::u32(region.min.y)))};
+                    ABORT_IF(cropped->at(x, y) != expected);
+                }
+            }
+
+            const qc::List<qc::u8> png{makePng(PngParams{0u, 8u, true, true}, size)};
+            const qc::u32 transparencyOffset{qc::u32(std::search(png.begin(), png.end(), "tRNS", "tRNS" + 4) - png.begin()) - 4u};
+            // The chunk is its length, type, two byte key, and CRC
+            qc::List<qc::u8> twoTransparencies{};
+            appendBytes(twoTransparencies, png.data(), transparencyOffset + 14u);
+            appendBytes(twoTransparencies, png.data() + transparencyOffset, png.size() - transparencyOffset);
+            qci::PngReader transparencyReader{};
+            ABORT_IF(transparencyReader.open(twoTransparencies.data(), twoTransparencies.size()));
+            ABORT_IF(!qc::utils::writeFile(file, twoTransparencies.data(), twoTransparencies.size()));
+            const qc::Result<qci::GrayAlphaImage> twoTransparenciesRegion{qci::readRegion<qc::u8, 2u>(file, region, false)};
+            ABORT_IF(twoTransparenciesRegion);
+
+            std::filesystem::remove(file);
+        }
+
+        // Dimensions past the limit, or whose pixel count overflows, are refused before anything is allocated
+        for (const qc::uivec2 badSize : {qc::uivec2{(1u << 24) + 1u, 1u}, qc::uivec2{1u, (1u << 24) + 1u}, qc::uivec2{1u << 20, 1u << 20}})
+        {
+            const qc::List<qc::u8> png{makePng(PngParams{6u, 8u, false, true}, badSize, zlibStored(qc::List<qc::u8>{}), nullptr)};
+            qci::PngReader reader{};
+            ABORT_IF(reader.open(png.data(), png.size()));
+            const qc::Result<qci::RgbaImage> image{qci::decodePng<qc::u8, 4u>(png.data(), png.size(), false)};
+            ABORT_IF(image);
+        }
+
+        // Mutation fuzzing, with a fixed seed so any failure reproduces
+        qc::u32 seed{0x12345678u};
+        const auto random{[&seed]()
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        }};
+        for (const qc::List<qc::u8> & png : pngs)
+        {
+            for (qc::u32 i{0u}; i < 64u; ++i)
+            {
+                qc::List<qc::u8> mutated{png};
+                // Past the signature, which would just be rejected, and not in the dimensions, which could ask for gigabytes
+                const qc::u32 flipN{1u + random() % 4u};
+                for (qc::u32 flip{0u}; flip < flipN; ++flip)
+                {
+                    const qc::u32 offset{8u + random() % (mutated.size() - 8u)};
+                    if (offset < 16u || offset >= 24u)
+                    {
+                        mutated[offset] ^= qc::u8(1u << (random() % 8u));
+                    }
+                }
+                if (i % 8u == 7u)
+                {
+                    mutated.resize(8u + random() % (mutated.size() - 8u));
+                }
+                decodeCorruptPng(mutated);
+            }
+        }
+    }
+
+    // `generateFromMask` against the distance to the nearest pixel across the edge, found by trying every pixel
+    void checkMaskSdfMatchesBruteForce(const qci::GrayImage & mask, const qc::f32 range)
+    {
+        const qci::GrayImage sdf{qci::sdf::generateFromMask(mask.view(), range)};
+        ABORT_IF(sdf.size() != mask.size());
+
+        for (qc::u32 y{0u}; y < mask.height(); ++y)
+        {
+            for (qc::u32 x{0u}; x < mask.width(); ++x)
+            {
+                const bool inside{mask.at(x, y) >= 128u};
+                qc::u64 minDist2{~qc::u64(0u)};
+                for (qc::u32 y2{0u}; y2 < mask.height(); ++y2)
+                {
+                    for (qc::u32 x2{0u}; x2 < mask.width(); ++x2)
+                    {
+                        if ((mask.at(x2, y2) >= 128u) != inside)
+                        {
+                            const qc::s64 dx{qc::s64(x2) - qc::s64(x)}, dy{qc::s64(y2) - qc::s64(y)};
+                            minDist2 = std::min(minDist2, qc::u64(dx * dx + dy * dy));
+                        }
+                    }
+                }
+
+                const qc::f32 dist{std::sqrt(qc::f32(minDist2))};
+                const qc::f32 distance{inside ? 0.5f - dist : dist - 0.5f};
+                ABORT_IF(sdf.at(x, y) != qc::transnorm<qc::u8>(0.5f - distance * (1.0f / range)));
+            }
+        }
+    }
+
+    // `compare` against differences taken one component at a time
+    template <typename T, qc::u32 n>
+    void checkCompareMatchesNaive(const qci::Image<T, n> & a, const qci::Image<T, n> & b, const double tolerance)
+    {
+        double maxAbsDiff{0.0}, squaredDiffSum{0.0};
+        qc::u64 mismatchN{0u};
+        for (qc::u32 y{0u}; y < a.height(); ++y)
+        {
+            const T * const rowA{reinterpret_cast<const T *>(a.row(qc::s32(y)))};
+            const T * const rowB{reinterpret_cast<const T *>(b.row(qc::s32(y)))};
+            for (qc::u32 x{0u}; x < a.width(); ++x)
+            {
+                bool mismatch{false};
+                for (qc::u32 c{0u}; c < n; ++c)
+                {
+                    const T va{rowA[x * n + c]}, vb{rowB[x * n + c]};
+                    double d{va == vb ? 0.0 : std::abs(double(va) - double(vb))};
+                    if (std::isnan(d)) d = std::numeric_limits<double>::infinity();
+                    maxAbsDiff = std::max(maxAbsDiff, d);
+                    squaredDiffSum += d * d;
+                    mismatch = mismatch || d > tolerance;
+                }
+                mismatchN += mismatch;
+            }
+        }
+
+        const qc::Result<qci::ImageDiff> diff{qci::compare(a, b, tolerance)};
+        ABORT_IF(!diff);
+        ABORT_IF(diff->maxAbsDiff != maxAbsDiff);
+        ABORT_IF(diff->mismatchN != mismatchN);
+        const double mse{squaredDiffSum / (double(a.width()) * a.height() * n)};
+        ABORT_IF(!(std::abs(diff->mse - mse) <= 1.0e-6 * mse || diff->mse == mse));
+    }
+
+    template <typename T, qc::u32 n>
+    qci::Image<T, n> compareTestImage(const qc::uivec2 size, const qc::u32 seed, const qc::u32 noise)
+    {
+        qci::Image<T, n> image{size};
+        T * const comps{reinterpret_cast<T *>(image.pixels())};
+        for (qc::u32 i{0u}; i < size.x * size.y * n; ++i)
+        {
+            // Mostly small differences between seeds, with the odd large one
+            const qc::u32 hash{((i ^ seed) * 2654435761u) >> 16};
+            const qc::u32 v{(i * 7u) % 200u + (hash % 64u == 0u ? hash % 56u : hash % (noise + 1u))};
+            comps[i] = std::is_floating_point_v<T> ? T(v) / T(255) : T(v);
+        }
+        return image;
+    }
+
+    void testCompare()
+    {
+        // Widths that leave a tail after whole sixteen byte blocks, and a row long enough to need the lane sums flushed
+        for (const qc::uivec2 size : {qc::uivec2{37u, 5u}, qc::uivec2{16u, 3u}, qc::uivec2{5u, 40u}, qc::uivec2{100003u, 2u}})
+        {
+            const qci::RgbImage a{compareTestImage<qc::u8, 3u>(size, 0u, 3u)};
+            const qci::RgbImage b{compareTestImage<qc::u8, 3u>(size, 1u, 3u)};
+            checkCompareMatchesNaive(a, b, 0.0);
+            checkCompareMatchesNaive(a, b, 3.0);
+            checkCompareMatchesNaive(a, a, 0.0);
+
+            const qci::GrayImage grayA{compareTestImage<qc::u8, 1u>(size, 2u, 5u)};
+            const qci::GrayImage grayB{compareTestImage<qc::u8, 1u>(size, 3u, 5u)};
+            checkCompareMatchesNaive(grayA, grayB, 2.0);
+        }
+
+        // Every component as different as it can be, whose squared sums overflow lanes that are not flushed
+        {
+            qci::GrayImage a{200000u, 2u}, b{200000u, 2u};
+            a.fill(qc::u8(0u));
+            b.fill(qc::u8(255u));
+            const qc::Result<qci::ImageDiff> diff{qci::compare(a, b)};
+            ABORT_IF(!diff);
+            ABORT_IF(diff->mse != 255.0 * 255.0 || diff->maxAbsDiff != 255.0 || diff->mismatchN != 400000u);
+        }
+
+        checkCompareMatchesNaive(compareTestImage<qc::u16, 2u>({23u, 11u}, 0u, 300u), compareTestImage<qc::u16, 2u>({23u, 11u}, 1u, 300u), 100.0);
+
+        // NaNs differ by infinity and always mismatch, while equal infinities do not differ
+        {
+            qci::Image<qc::f32, 2u> a{compareTestImage<qc::f32, 2u>({19u, 7u}, 0u, 2u)};
+            qci::Image<qc::f32, 2u> b{compareTestImage<qc::f32, 2u>({19u, 7u}, 1u, 2u)};
+            checkCompareMatchesNaive(a, b, 0.01);
+
+            constexpr qc::f32 inf{std::numeric_limits<qc::f32>::infinity()};
+            a.at(3, 2).x = inf;
+            b.at(3, 2).x = inf;
+            b.at(7, 5) = a.at(7, 5);
+            a.at(7, 5).y = -inf;
+            b.at(7, 5).y = -inf;
+            const qc::Result<qci::ImageDiff> infDiff{qci::compare(a, b, 1.0)};
+            ABORT_IF(!infDiff || !std::isfinite(infDiff->maxAbsDiff) || infDiff->mismatchN);
+
+            b.at(11, 0).y = std::numeric_limits<qc::f32>::quiet_NaN();
+            a.at(0, 6).x = std::numeric_limits<qc::f32>::quiet_NaN();
+            a.at(4, 4).x = inf;
+            b.at(4, 4).x = -inf;
+            checkCompareMatchesNaive(a, b, 1.0);
+            const qc::Result<qci::ImageDiff> nanDiff{qci::compare(a, b, 1.0)};
+            ABORT_IF(!nanDiff || nanDiff->maxAbsDiff != inf || nanDiff->mismatchN != 3u);
+        }
+    }
+
+    // Copies `src` into a tiled image at `copyPos`, and then part of that back out at `copyToPos`, checking every pixel on the way, including that nothing outside the clipped spans is touched
+    template <typename T, qc::u32 n>
+    void checkTiledRoundTrip(const qci::Image<T, n> & src, const qc::uivec2 tiledSize, const qc::ivec2 copyPos, const qc::uivec2 dstSize, const qc::ivec2 copyToPos)
+    {
+        const qci::Image<T, n> background{compareTestImage<T, n>(tiledSize, 7u, 40u)};
+        qci::TiledImage<T, n> tiled{background.view()};
+        tiled.copy(src.view(), copyPos);
+
+        const qc::ispan2 copySpan{qc::ispan2{copyPos, copyPos + qc::ivec2(src.size())} & qc::ispan2{qc::ivec2{}, qc::ivec2(tiledSize)}};
+        for (qc::s32 y{0}; y < qc::s32(tiledSize.y); ++y)
+        {
+            for (qc::s32 x{0}; x < qc::s32(tiledSize.x); ++x)
+            {
+                const bool copied{x >= copySpan.min.x && x < copySpan.max.x && y >= copySpan.min.y && y < copySpan.max.y};
+                ABORT_IF(tiled.at(x, y) != (copied ? src.at(x - copyPos.x, y - copyPos.y) : background.at(x, y)));
+            }
+        }
+
+        const qci::Image<T, n> whole{tiled.toImage()};
+        ABORT_IF(whole.size() != tiledSize);
+        for (qc::s32 y{0}; y < qc::s32(tiledSize.y); ++y)
+        {
+            for (qc::s32 x{0}; x < qc::s32(tiledSize.x); ++x)
+            {
+                ABORT_IF(whole.at(x, y) != tiled.at(x, y));
+            }
+        }
+
+        const qci::Image<T, n> dstBackground{compareTestImage<T, n>(dstSize, 8u, 40u)};
+        qci::Image<T, n> dst{dstSize};
+        dst.view().copy(dstBackground.view());
+        tiled.copyTo(dst.view(), copyToPos);
+
+        const qc::ispan2 copyToSpan{qc::ispan2{copyToPos, copyToPos + qc::ivec2(dstSize)} & qc::ispan2{qc::ivec2{}, qc::ivec2(tiledSize)}};
+        for (qc::s32 y{0}; y < qc::s32(dstSize.y); ++y)
+        {
+            for (qc::s32 x{0}; x < qc::s32(dstSize.x); ++x)
+            {
+                const qc::ivec2 p{x + copyToPos.x, y + copyToPos.y};
+                const bool copied{p.x >= copyToSpan.min.x && p.x < copyToSpan.max.x && p.y >= copyToSpan.min.y && p.y < copyToSpan.max.y};
+                ABORT_IF(dst.at(x, y) != (copied ? tiled.at(p) : dstBackground.at(x, y)));
+            }
+        }
+    }
+
+    void testTiled()
+    {
+        // Sizes that end partway through a tile, with spans starting and ending partway through tiles too
+        checkTiledRoundTrip(compareTestImage<qc::u8, 3u>({29u, 21u}, 0u, 40u), {37u, 26u}, {5, 3}, {17u, 11u}, {9, 6});
+        // Spans clipped on each side
+        checkTiledRoundTrip(compareTestImage<qc::u8, 1u>({30u, 19u}, 1u, 40u), {45u, 23u}, {20, -7}, {26u, 30u}, {-3, 2});
+        checkTiledRoundTrip(compareTestImage<qc::u16, 4u>({13u, 40u}, 2u, 400u), {21u, 33u}, {-6, 9}, {12u, 7u}, {15, 29});
+        checkTiledRoundTrip(compareTestImage<qc::f32, 2u>({64u, 16u}, 3u, 40u), {64u, 16u}, {}, {64u, 16u}, {});
+        // Nothing in common, so nothing copied
+        checkTiledRoundTrip(compareTestImage<qc::u8, 4u>({8u, 8u}, 4u, 40u), {11u, 9u}, {11, 0}, {5u, 5u}, {-5, 3});
+    }
+
+    // Checks each row of `view` is visited once with the right span, by both `forEachRow` and `parallelForRows`
+    void checkRowVisits(const qci::RgbaImage::View & view, const qc::u32 grain)
+    {
+        qc::s32 nextY{0};
+        view.forEachRow([&](const std::span<qc::ucvec4> row, const qc::s32 y)
+        {
+            ABORT_IF(y != nextY);
+            ABORT_IF(row.size() != view.width());
+            for (qc::u32 x{0u}; x < view.width(); ++x)
+            {
+                ABORT_IF(&row[x] != &view.at(qc::s32(x), y));
+            }
+            ++nextY;
+        });
+        ABORT_IF(nextY != qc::s32(view.height()));
+
+        std::vector<std::atomic<qc::u32>> visitNs(view.height());
+        view.parallelForRows([&](const std::span<qc::ucvec4> row, const qc::s32 y)
+        {
+            ABORT_IF(y < 0 || y >= qc::s32(view.height()));
+            ABORT_IF(row.size() != view.width());
+            for (qc::u32 x{0u}; x < view.width(); ++x)
+            {
+                ABORT_IF(&row[x] != &view.at(qc::s32(x), y));
+            }
+            visitNs[qc::u32(y)].fetch_add(1u);
+        }, grain);
+        for (const std::atomic<qc::u32> & visitN : visitNs)
+        {
+            ABORT_IF(visitN.load() != 1u);
+        }
+    }
+
+    // Checks `parallelFor` hands out every index exactly once, in blocks of `grain` aligned to it, with the later indices costing far more
+    void checkParallelForCoverage(const qc::u32 count, const qc::u32 grain, qci::Executor & executor = qci::defaultExecutor())
+    {
+        const qc::u32 blockSize{std::max(grain, 1u)};
+        std::vector<std::atomic<qc::u32>> hitNs(count);
+        std::atomic<qc::u64> sink{};
+        qci::parallelFor(count, grain, [&](const qc::u32 begin, const qc::u32 end)
+        {
+            ABORT_IF(begin >= end || end > count);
+            ABORT_IF(begin % blockSize || (end - begin != blockSize && end != count));
+            for (qc::u32 i{begin}; i < end; ++i)
+            {
+                // Uneven so the workers given the last blocks fall behind and the others steal from them
+                qc::u64 work{i};
+                for (qc::u32 j{0u}; j < (i >= count - count / 8u ? 2000u : 10u); ++j)
+                {
+                    work = work * 6364136223846793005u + 1442695040888963407u;
+                }
+                sink.fetch_add(work, std::memory_order::relaxed);
+                hitNs[i].fetch_add(1u);
+            }
+        }, executor);
+        for (const std::atomic<qc::u32> & hitN : hitNs)
+        {
+            ABORT_IF(hitN.load() != 1u);
+        }
+    }
+
+    void testParallel()
+    {
+        qci::RgbaImage image{compareTestImage<qc::u8, 4u>({37u, 29u}, 5u, 40u)};
+        const qci::RgbaImage original{compareTestImage<qc::u8, 4u>({37u, 29u}, 5u, 40u)};
+
+        // Whole image, and a subview whose rows are one image width apart
+        for (const qc::u32 grain : {0u, 1u, 4u, 16u, 100u})
+        {
+            checkRowVisits(image.view(), grain);
+            checkRowVisits(image.view({5, 3}, {23u, 17u}), grain);
+        }
+
+        // Empty views visit nothing
+        bool visited{false};
+        image.view({4, 4}, {0u, 5u}).forEachRow([&](std::span<qc::ucvec4>, qc::s32) { visited = true; });
+        image.view({4, 4}, {5u, 0u}).parallelForRows([&](std::span<qc::ucvec4>, qc::s32) { visited = true; });
+        ABORT_IF(visited);
+
+        // Writing through the rows of a subview leaves the rest of the image alone
+        const qc::ivec2 pos{7, 2};
+        const qc::uivec2 size{19u, 23u};
+        image.view(pos, size).parallelForRows([](const std::span<qc::ucvec4> row, const qc::s32 y)
+        {
+            for (qc::u32 x{0u}; x < row.size(); ++x)
+            {
+                row[x] = qc::ucvec4{qc::u8(x), qc::u8(y), 7u, 255u};
+            }
+        }, 3u);
+        for (qc::s32 y{0}; y < qc::s32(image.height()); ++y)
+        {
+            for (qc::s32 x{0}; x < qc::s32(image.width()); ++x)
+            {
+                const bool inside{x >= pos.x && x < pos.x + qc::s32(size.x) && y >= pos.y && y < pos.y + qc::s32(size.y)};
+                const qc::ucvec4 expected{inside ? qc::ucvec4{qc::u8(x - pos.x), qc::u8(y - pos.y), 7u, 255u} : original.at(x, y)};
+                ABORT_IF(image.at(x, y) != expected);
+            }
+        }
+
+        for (const qc::u32 count : {0u, 1u, 7u, 1000u, 4099u})
+        {
+            for (const qc::u32 grain : {0u, 1u, 3u, 64u, 5000u})
+            {
+                checkParallelForCoverage(count, grain);
+            }
+        }
+    }
+
+    // Forwards to a pool, counting what it is given
+    class CountingExecutor final : public qci::Executor
+    {
+      public:
+
+        qci::ThreadPool pool{2u};
+        std::atomic<qc::u32> submitN{};
+
+        void submit(std::function<void()> task) override
+        {
+            submitN.fetch_add(1u);
+            pool.submit(std::move(task));
+        }
+
+        qc::u32 concurrency() const override
+        {
+            return pool.concurrency();
+        }
+    };
+
+    // Only ever has the calling thread, and hands whole ranges to `parallelFor` itself
+    class SerialExecutor final : public qci::Executor
+    {
+      public:
+
+        qc::u32 parallelForN{};
+
+        void submit(std::function<void()>) override
+        {
+            ABORT_IF(true);
+        }
+
+        qc::u32 concurrency() const override
+        {
+            return 1u;
+        }
+
+        void parallelFor(const qc::u32 count, const qc::u32 grain, const std::function<void(qc::u32, qc::u32)> & func) override
+        {
+            ++parallelForN;
+            Executor::parallelFor(count, grain, func);
+        }
+    };
+
+    void testExecutor()
+    {
+        const std::thread::id callingThread{std::this_thread::get_id()};
+
+        {
+            const qci::ThreadPool defaultPool{};
+            ABORT_IF(!defaultPool.threadN() || defaultPool.concurrency() != defaultPool.threadN() + 1u);
+        }
+
+        // Tasks, and the tasks they submit, run off the calling thread, and any left are run before the pool is destroyed
+        // Each takes a while so plenty are still queued by then
+        std::atomic<qc::u32> taskN{};
+        std::atomic<qc::u32> inlineN{};
+        {
+            qci::ThreadPool pool{3u};
+            ABORT_IF(pool.threadN() != 3u || pool.concurrency() != 4u);
+
+            for (qc::u32 i{0u}; i < 100u; ++i)
+            {
+                pool.submit([&]()
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    inlineN.fetch_add(std::this_thread::get_id() == callingThread);
+                    taskN.fetch_add(1u);
+                    for (qc::u32 j{0u}; j < 2u; ++j)
+                    {
+                        pool.submit([&]()
+                        {
+                            inlineN.fetch_add(std::this_thread::get_id() == callingThread);
+                            taskN.fetch_add(1u);
+                        });
+                    }
+                });
+            }
+        }
+        ABORT_IF(taskN.load() != 300u || inlineN.load());
+
+        qci::ThreadPool pool{3u};
+        for (const qc::u32 count : {1u, 5u, 1000u, 4099u})
+        {
+            for (const qc::u32 grain : {0u, 1u, 3u, 64u})
+            {
+                checkParallelForCoverage(count, grain, pool);
+            }
+        }
+
+        // Nested within parallelFor, and within tasks that fill every thread, without deadlocking
+        {
+            constexpr qc::u32 outerN{6u};
+            constexpr qc::u32 innerN{200u};
+            std::vector<std::atomic<qc::u32>> hitNs(outerN * innerN);
+            pool.parallelFor(outerN, 1u, [&](const qc::u32 outerBegin, const qc::u32 outerEnd)
+            {
+                for (qc::u32 outer{outerBegin}; outer < outerEnd; ++outer)
+                {
+                    pool.parallelFor(innerN, 7u, [&, outer](const qc::u32 begin, const qc::u32 end)
+                    {
+                        for (qc::u32 inner{begin}; inner < end; ++inner)
+                        {
+                            hitNs[outer * innerN + inner].fetch_add(1u);
+                        }
+                    });
+                }
+            });
+            for (const std::atomic<qc::u32> & hitN : hitNs)
+            {
+                ABORT_IF(hitN.load() != 1u);
+            }
+
+            std::atomic<qc::u32> doneN{};
+            for (qc::u32 i{0u}; i < 8u; ++i)
+            {
+                pool.submit([&]()
+                {
+                    checkParallelForCoverage(500u, 5u, pool);
+                    doneN.fetch_add(1u);
+                    doneN.notify_all();
+                });
+            }
+            for (qc::u32 done{doneN.load()}; done < 8u; done = doneN.load())
+            {
+                doneN.wait(done);
+            }
+        }
+
+        // Library calls go to the default executor while it is set, and back to the built in pool after
+        const qci::RgbaImage image{compareTestImage<qc::u8, 4u>({67u, 45u}, 6u, 40u)};
+        const qci::RgbaImage serialRotated{image.reoriented(qci::Orientation::rotate90)};
+        {
+            CountingExecutor counting{};
+            qci::setDefaultExecutor(&counting);
+            ABORT_IF(&qci::defaultExecutor() != &counting);
+
+            const qci::RgbaImage rotated{image.reoriented(qci::Orientation::rotate90, true)};
+            ABORT_IF(rotated.size() != serialRotated.size());
+            for (qc::u32 y{0u}; y < rotated.height(); ++y)
+            {
+                for (qc::u32 x{0u}; x < rotated.width(); ++x)
+                {
+                    ABORT_IF(rotated.at(x, y) != serialRotated.at(x, y));
+                }
+            }
+            checkParallelForCoverage(1000u, 16u);
+            ABORT_IF(!counting.submitN.load());
+
+            qci::setDefaultExecutor(nullptr);
+            ABORT_IF(&qci::defaultExecutor() == &counting);
+            const qc::u32 submitN{counting.submitN.load()};
+            checkParallelForCoverage(1000u, 16u);
+            ABORT_IF(counting.submitN.load() != submitN);
+        }
+
+        // A single thread runs everything inline in one call, and overriding parallelFor catches row loops too
+        {
+            SerialExecutor serial{};
+            qc::u32 callN{0u};
+            serial.parallelFor(1000u, 3u, [&](const qc::u32 begin, const qc::u32 end)
+            {
+                ABORT_IF(std::this_thread::get_id() != callingThread);
+                ABORT_IF(begin != 0u || end != 1000u);
+                ++callN;
+            });
+            ABORT_IF(callN != 1u);
+
+            qc::s32 rowN{0};
+            image.view().parallelForRows([&](std::span<const qc::ucvec4>, const qc::s32 y) { ABORT_IF(y != rowN); ++rowN; }, 4u, serial);
+            ABORT_IF(rowN != qc::s32(image.height()) || serial.parallelForN != 2u);
+
+            checkParallelForCoverage(300u, 8u, serial);
+            ABORT_IF(serial.parallelForN != 3u);
+        }
+    }
+
+    // Where source pixel `p` of an image `size` goes, rotating counterclockwise with y up
+    qc::ivec2 orientedPosition(const qci::Orientation orientation, const qc::ivec2 size, const qc::ivec2 p)
+    {
+        switch (orientation)
+        {
+            case qci::Orientation::flipX: return {size.x - 1 - p.x, p.y};
+            case qci::Orientation::flipY: return {p.x, size.y - 1 - p.y};
+            case qci::Orientation::rotate90: return {size.y - 1 - p.y, p.x};
+            case qci::Orientation::rotate180: return {size.x - 1 - p.x, size.y - 1 - p.y};
+            case qci::Orientation::rotate270: return {p.y, size.x - 1 - p.x};
+            case qci::Orientation::transpose: return {p.y, p.x};
+            case qci::Orientation::transverse: return {size.y - 1 - p.y, size.x - 1 - p.x};
+        }
+        return p;
+    }
+
+    constexpr qci::Orientation allOrientations[7]{
+        qci::Orientation::flipX, qci::Orientation::flipY,
+        qci::Orientation::rotate90, qci::Orientation::rotate180, qci::Orientation::rotate270,
+        qci::Orientation::transpose, qci::Orientation::transverse};
+
+    // Checks `oriented` holds each pixel of `image` where the naive index map puts it
+    template <typename T, qc::u32 n>
+    void checkOriented(const qci::Image<T, n> & image, const qci::Orientation orientation, const qci::Image<T, n> & oriented)
+    {
+        const qc::uivec2 expectedSize{qci::swapsAxes(orientation) ? qc::uivec2{image.height(), image.width()} : image.size()};
+        ABORT_IF(oriented.size() != expectedSize);
+        for (qc::s32 y{0}; y < qc::s32(image.height()); ++y)
+        {
+            for (qc::s32 x{0}; x < qc::s32(image.width()); ++x)
+            {
+                ABORT_IF(oriented.at(orientedPosition(orientation, qc::ivec2(image.size()), qc::ivec2{x, y})) != image.at(x, y));
+            }
+        }
+    }
+
+    template <typename T, qc::u32 n>
+    void checkReorientMatchesNaive(const qc::uivec2 size)
+    {
+        const qci::Image<T, n> image{compareTestImage<T, n>(size, 5u, 200u)};
+
+        for (const qci::Orientation orientation : allOrientations)
+        {
+            for (const bool parallel : {false, true})
+            {
+                checkOriented(image, orientation, image.reoriented(orientation, parallel));
+
+                qci::Image<T, n> inPlace{image.size()};
+                inPlace.view().copy(image.view());
+                inPlace.reorient(orientation, parallel);
+                checkOriented(image, orientation, inPlace);
+            }
+
+            // A square view within a larger image, so rows are further apart than the view is wide, and nothing outside it may change
+            const qc::u32 side{std::min(size.x, size.y) / 2u};
+            const qc::ivec2 pos{qc::s32(size.x - side) / 2, qc::s32(size.y - side) / 3};
+            qci::Image<T, n> outer{image.size()};
+            outer.view().copy(image.view());
+            outer.view(pos, qc::uivec2{side}).reorient(orientation, true);
+            const qc::ivec2 viewSize{qc::s32(side)};
+            for (qc::s32 y{0}; y < qc::s32(size.y); ++y)
+            {
+                for (qc::s32 x{0}; x < qc::s32(size.x); ++x)
+                {
+                    const qc::ivec2 p{x - pos.x, y - pos.y};
+                    const bool inView{p.x >= 0 && p.y >= 0 && p.x < viewSize.x && p.y < viewSize.y};
+                    ABORT_IF(outer.at(inView ? orientedPosition(orientation, viewSize, p) + pos : qc::ivec2{x, y}) != image.at(x, y));
+                }
+            }
+        }
+
+        // Four quarter turns, and two of any mirroring, come back to the start
+        qci::Image<T, n> turned{image.size()};
+        turned.view().copy(image.view());
+        for (qc::u32 i{0u}; i < 4u; ++i) turned.reorient(qci::Orientation::rotate90);
+        checkOriented(image, qci::Orientation::rotate180, turned.reoriented(qci::Orientation::rotate180));
+    }
+
+    void testOrient()
+    {
+        // Sizes past one and several 32 pixel blocks, with partial blocks, SIMD tails, and single rows and columns
+        for (const qc::uivec2 size : {qc::uivec2{37u, 70u}, qc::uivec2{64u, 64u}, qc::uivec2{100u, 33u}, qc::uivec2{1u, 5u}, qc::uivec2{17u, 1u}, qc::uivec2{131u, 131u}})
+        {
+            checkReorientMatchesNaive<qc::u8, 1u>(size);
+            checkReorientMatchesNaive<qc::u8, 4u>(size);
+        }
+        checkReorientMatchesNaive<qc::u16, 3u>({45u, 29u});
+        checkReorientMatchesNaive<qc::f32, 2u>({29u, 45u});
+    }
+
+    template <typename T, qc::u32 n>
+    qci::Image<T, n> blurTestImage(const qc::uivec2 size)
+    {
+        qci::Image<T, n> image{size};
+        T * const comps{reinterpret_cast<T *>(image.pixels())};
+        for (qc::u32 i{0u}; i < size.x * size.y * n; ++i)
+        {
+            const qc::u32 hash{(i * 2654435761u) >> 16};
+            if constexpr (std::is_floating_point_v<T>) comps[i] = T(hash % 1000u) / T(999);
+            else comps[i] = T(hash);
+        }
+        return image;
+    }
+
+    // Blurs the `size` region at `pos` one axis at a time, summing each clamped window directly and rounding to `T` after each axis, as the running sums do
+    template <typename T, qc::u32 n>
+    void naiveBoxBlur(qci::Image<T, n> & image, const qc::uivec2 pos, const qc::uivec2 size, const qc::u32 radius)
+    {
+        const auto comp{[&](const qc::u32 x, const qc::u32 y, const qc::u32 c) -> T & { return reinterpret_cast<T *>(image.row(qc::s32(pos.y + y)) + pos.x + x)[c]; }};
+        const auto toT{[](const double v) { return std::is_floating_point_v<T> ? T(v) : T(v + 0.5); }};
+
+        for (const bool vertical : {false, true})
+        {
+            const qc::u32 length{vertical ? size.y : size.x};
+            const qc::u32 lineN{vertical ? size.x : size.y};
+            std::vector<double> line(length * n);
+            for (qc::u32 j{0u}; j < lineN; ++j)
+            {
+                for (qc::u32 i{0u}; i < length; ++i)
+                {
+                    for (qc::u32 c{0u}; c < n; ++c)
+                    {
+                        double sum{0.0};
+                        for (qc::s64 k{qc::s64(i) - radius}; k <= qc::s64(i) + radius; ++k)
+                        {
+                            const qc::u32 clamped{qc::u32(std::clamp(k, qc::s64(0), qc::s64(length - 1u)))};
+                            sum += double(vertical ? comp(j, clamped, c) : comp(clamped, j, c));
+                        }
+                        line[i * n + c] = sum / double(2u * radius + 1u);
+                    }
+                }
+                for (qc::u32 i{0u}; i < length; ++i)
+                {
+                    for (qc::u32 c{0u}; c < n; ++c)
+                    {
+                        (vertical ? comp(j, i, c) : comp(i, j, c)) = toT(line[i * n + c]);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T, qc::u32 n>
+    void checkBlurImagesMatch(const qci::Image<T, n> & a, const qci::Image<T, n> & b, const double tolerance)
+    {
+        ABORT_IF(a.size() != b.size());
+        const T * const aComps{reinterpret_cast<const T *>(a.pixels())};
+        const T * const bComps{reinterpret_cast<const T *>(b.pixels())};
+        for (qc::u64 i{0u}; i < qc::u64(a.width()) * a.height() * n; ++i)
+        {
+            ABORT_IF(!(std::abs(double(aComps[i]) - double(bComps[i])) <= tolerance));
+        }
+    }
+
+    template <typename T, qc::u32 n>
+    void checkBoxBlurMatchesNaive(const qc::uivec2 size, const qc::uivec2 pos, const qc::uivec2 viewSize, const qc::u32 radius)
+    {
+        qci::Image<T, n> image{blurTestImage<T, n>(size)};
+        qci::Image<T, n> expected{blurTestImage<T, n>(size)};
+        image.view(qc::ivec2(pos), viewSize).boxBlur(radius);
+        naiveBoxBlur(expected, pos, viewSize, radius);
+        // Rounding of sums that land near a half may go either way
+        checkBlurImagesMatch(image, expected, std::is_floating_point_v<T> ? 1.0e-5 : 1.0);
+    }
+
+    void testBlur()
+    {
+        // Box blur against naive windowed sums, over whole images and views within them, with radii past the image too
+        checkBoxBlurMatchesNaive<qc::u8, 3u>({37u, 23u}, {0u, 0u}, {37u, 23u}, 2u);
+        checkBoxBlurMatchesNaive<qc::u8, 3u>({37u, 23u}, {0u, 0u}, {37u, 23u}, 40u);
+        checkBoxBlurMatchesNaive<qc::u8, 1u>({37u, 23u}, {5u, 3u}, {19u, 14u}, 3u);
+        checkBoxBlurMatchesNaive<qc::u16, 4u>({29u, 41u}, {2u, 7u}, {25u, 30u}, 6u);
+        checkBoxBlurMatchesNaive<qc::f32, 2u>({64u, 9u}, {0u, 0u}, {64u, 9u}, 1u);
+        checkBoxBlurMatchesNaive<qc::f32, 1u>({1u, 50u}, {0u, 0u}, {1u, 50u}, 4u);
+
+        // Rows wide enough that their scratch is freed afterward, and columns tall enough to narrow the strips
+        checkBoxBlurMatchesNaive<qc::u8, 4u>({100000u, 3u}, {0u, 0u}, {100000u, 3u}, 3u);
+        checkBoxBlurMatchesNaive<qc::f32, 1u>({3u, 100000u}, {0u, 0u}, {3u, 100000u}, 3u);
+
+        // Gaussian blur of an impulse keeps its total, and spreads it with the asked variance up to the rounding of the box widths
+        for (const qc::f32 sigma : {0.8f, 2.5f, 7.0f})
+        {
+            constexpr qc::u32 size{101u};
+            qci::Image<qc::f32, 1u> image{size, size};
+            image.fill(0.0f);
+            image.at(50, 50) = 1.0f;
+            image.view().gaussianBlur(sigma);
+
+            double total{0.0}, varianceX{0.0}, varianceY{0.0};
+            for (qc::u32 y{0u}; y < size; ++y)
+            {
+                for (qc::u32 x{0u}; x < size; ++x)
+                {
+                    const double v{image.at(x, y)};
+                    ABORT_IF(v < 0.0);
+                    total += v;
+                    varianceX += v * (double(x) - 50.0) * (double(x) - 50.0);
+                    varianceY += v * (double(y) - 50.0) * (double(y) - 50.0);
+                }
+            }
+            const double sigma2{double(sigma) * double(sigma)};
+            ABORT_IF(std::abs(total - 1.0) > 1.0e-4);
+            ABORT_IF(std::abs(varianceX - sigma2) > 0.1 * sigma2 + 0.25);
+            ABORT_IF(std::abs(varianceY - varianceX) > 1.0e-4);
+        }
+
+        // Gaussian blur of integer images only differs from float by the rounding of each pass
+        {
+            const qc::uivec2 size{45u, 31u};
+            qci::Image<qc::u8, 3u> image{blurTestImage<qc::u8, 3u>(size)};
+            qci::Image<qc::f32, 3u> expected{size};
+            for (qc::u32 y{0u}; y < size.y; ++y)
+            {
+                for (qc::u32 x{0u}; x < size.x; ++x) expected.at(x, y) = qc::fvec3(image.at(x, y));
+            }
+            image.view().gaussianBlur(3.0f);
+            expected.view().gaussianBlur(3.0f);
+            for (qc::u32 y{0u}; y < size.y; ++y)
+            {
+                for (qc::u32 x{0u}; x < size.x; ++x)
+                {
+                    const qc::fvec3 diff{qc::fvec3(image.at(x, y)) - expected.at(x, y)};
+                    ABORT_IF(std::abs(diff.x) > 3.0f || std::abs(diff.y) > 3.0f || std::abs(diff.z) > 3.0f);
+                }
+            }
+        }
+    }
+
+    // Writes the image as `.qci`, then maps it and reads it back, and checks both match it, and that the encoded copy is the same bytes as the file
+    template <typename T, qc::u32 n>
+    void checkQciRoundTrip(const qci::Image<T, n> & image, const std::filesystem::path & file)
+    {
+        ABORT_IF(!qci::write(image, file));
+
+        const qc::Result<qci::MappedImage<T, n>> mapped{qci::map<T, n>(file)};
+        const qc::Result<qci::Image<T, n>> read{qci::read<T, n>(file, false)};
+        ABORT_IF(!mapped || !read);
+        for (const qci::Image<T, n> * const copy : {&mapped->image(), &*read})
+        {
+            ABORT_IF(copy->size() != image.size());
+            ABORT_IF(std::memcmp(copy->pixels(), image.pixels(), qc::u64(image.width()) * image.height() * sizeof(qci::Pixel<T, n>)));
+        }
+
+        const qc::Result<qc::List<qc::u8>> fileData{qc::utils::readFile(file)};
+        const qc::Result<qc::List<qc::u8>> encoded{qci::encode(image, ".qci")};
+        ABORT_IF(!fileData || !encoded);
+        ABORT_IF(fileData->size() != encoded->size() || std::memcmp(fileData->data(), encoded->data(), fileData->size()));
+    }
+
+    void testQci()
+    {
+        const std::filesystem::path file{std::filesystem::temp_directory_path() / "qc-image-test.qci"};
+
+        checkQciRoundTrip(blurTestImage<qc::u8, 3u>({37u, 23u}), file);
+        checkQciRoundTrip(blurTestImage<qc::u16, 1u>({5u, 64u}), file);
+        checkQciRoundTrip(blurTestImage<qc::f32, 4u>({19u, 2u}), file);
+
+        // Maps refuse files whose header does not match, and files too short for their header or pixels
+        {
+            ABORT_IF(!qci::write(blurTestImage<qc::u8, 3u>({37u, 23u}), file));
+            const bool mapsAsRgba{qci::map<qc::u8, 4u>(file)};
+            const bool mapsAsGray{qci::map<qc::u8, 1u>(file)};
+            const bool mapsAsU16{qci::map<qc::u16, 3u>(file)};
+            const bool mapsAsF32{qci::map<qc::f32, 3u>(file)};
+            ABORT_IF(mapsAsRgba || mapsAsGray || mapsAsU16 || mapsAsF32);
+
+            const qc::Result<qc::List<qc::u8>> valid{qc::utils::readFile(file)};
+            ABORT_IF(!valid);
+            const auto mapsWith{[&](const auto & edit)
+            {
+                qc::List<qc::u8> data{*valid};
+                edit(data);
+                ABORT_IF(!qc::utils::writeFile(file, data.data(), data.size()));
+                return bool(qci::map<qc::u8, 3u>(file));
+            }};
+            const auto setU32{[](qc::List<qc::u8> & data, const qc::u32 offset, const qc::u32 v) { std::memcpy(data.data() + offset, &v, 4u); }};
+
+            ABORT_IF(mapsWith([](qc::List<qc::u8> & data) { data[0] = 'X'; }));
+            ABORT_IF(mapsWith([&](qc::List<qc::u8> & data) { setU32(data, 4u, 2u); }));
+            ABORT_IF(mapsWith([&](qc::List<qc::u8> & data) { setU32(data, 8u, 0u); }));
+            ABORT_IF(mapsWith([&](qc::List<qc::u8> & data) { setU32(data, 24u, 37u * 3u + 1u); }));
+            ABORT_IF(mapsWith([&](qc::List<qc::u8> & data) { setU32(data, 28u, 16u); }));
+            ABORT_IF(mapsWith([](qc::List<qc::u8> & data) { data.resize(data.size() - 1u); }));
+            ABORT_IF(mapsWith([](qc::List<qc::u8> & data) { data.resize(40u); }));
+            ABORT_IF(!mapsWith([](qc::List<qc::u8> &) {}));
+        }
+
+        // Empty images are not written
+        ABORT_IF(qci::write(qci::GrayImage{}, file));
+
+        std::filesystem::remove(file);
+    }
+
+    // Writes and reads back a `u16` image as PNG, through a file and in memory, which must be exact
+    template <qc::u32 n>
+    void checkPng16RoundTrip(const qc::uivec2 size, const std::filesystem::path & file)
+    {
+        const qci::Image<qc::u16, n> image{blurTestImage<qc::u16, n>(size)};
+        ABORT_IF(!qci::write(image, file));
+        const qc::Result<qci::Image<qc::u16, n>> read{qci::read<qc::u16, n>(file, false)};
+        const qc::Result<qc::List<qc::u8>> encoded{qci::encode(image, ".png")};
+        ABORT_IF(!read || !encoded);
+        const qc::Result<qci::Image<qc::u16, n>> decoded{qci::decode<qc::u16, n>(encoded->data(), encoded->size(), false)};
+        ABORT_IF(!decoded);
+        for (const qci::Image<qc::u16, n> * const copy : {&*read, &*decoded})
+        {
+            ABORT_IF(copy->size() != image.size());
+            ABORT_IF(std::memcmp(copy->pixels(), image.pixels(), qc::u64(image.width()) * image.height() * sizeof(qci::Pixel<qc::u16, n>)));
+        }
+    }
+
+    void testTypedIo()
+    {
+        const std::filesystem::path directory{std::filesystem::temp_directory_path()};
+        const std::filesystem::path pngFile{directory / "qc-image-test-16.png"};
+        const std::filesystem::path hdrFile{directory / "qc-image-test.hdr"};
+        const std::filesystem::path qciFile{directory / "qc-image-test-typed.qci"};
+
+        // 16 bit PNGs of every component count, with rows of odd byte lengths
+        checkPng16RoundTrip<1u>({37u, 23u}, pngFile);
+        checkPng16RoundTrip<2u>({1u, 9u}, pngFile);
+        checkPng16RoundTrip<3u>({64u, 3u}, pngFile);
+        checkPng16RoundTrip<4u>({13u, 17u}, pngFile);
+
+        // 8 bit files read as 16 bits are widened to the full range
+        {
+            const qci::RgbImage image{blurTestImage<qc::u8, 3u>({21u, 11u})};
+            ABORT_IF(!qci::write(image, pngFile));
+            const qc::Result<qci::Image<qc::u16, 3u>> wide{qci::read<qc::u16, 3u>(pngFile, false)};
+            ABORT_IF(!wide || wide->size() != image.size());
+            const qc::u8 * const narrowComps{std::bit_cast<const qc::u8 *>(image.pixels())};
+            const qc::u16 * const wideComps{std::bit_cast<const qc::u16 *>(wide->pixels())};
+            for (qc::u32 i{0u}; i < 21u * 11u * 3u; ++i)
+            {
+                ABORT_IF(wideComps[i] != narrowComps[i] * 257u);
+            }
+        }
+
+        // Radiance HDR keeps an 8 bit mantissa shared by each pixel's components, so is within about 1% of the largest component
+        {
+            qci::Image<qc::f32, 3u> image{blurTestImage<qc::f32, 3u>({29u, 13u})};
+            image.at(0, 0) = qc::fvec3{1000.0f, 250.0f, 0.0f};
+            ABORT_IF(!qci::write(image, hdrFile));
+            const qc::Result<qci::Image<qc::f32, 3u>> read{qci::read<qc::f32, 3u>(hdrFile, false)};
+            ABORT_IF(!read || read->size() != image.size());
+            for (qc::s32 y{0}; y < 13; ++y)
+            {
+                for (qc::s32 x{0}; x < 29; ++x)
+                {
+                    const qc::fvec3 expected{image.at(x, y)};
+                    const qc::fvec3 actual{read->at(x, y)};
+                    const qc::f32 largest{std::max(std::max(expected.x, expected.y), expected.z)};
+                    for (qc::u32 c{0u}; c < 3u; ++c)
+                    {
+                        ABORT_IF(std::abs(actual[c] - expected[c]) > largest * (1.0f / 128.0f));
+                    }
+                }
+            }
+
+            // Gray is written as RGB, so comes back with three equal components
+            const qci::Image<qc::f32, 1u> gray{blurTestImage<qc::f32, 1u>({7u, 5u})};
+            ABORT_IF(!qci::write(gray, hdrFile));
+            const qc::Result<qci::Image<qc::f32, 1u>> grayAsGray{qci::read<qc::f32, 1u>(hdrFile, false)};
+            const qc::Result<qci::Image<qc::f32, 3u>> grayAsRgb{qci::read<qc::f32, 3u>(hdrFile, false)};
+            ABORT_IF(grayAsGray || !grayAsRgb);
+            for (qc::s32 y{0}; y < 5; ++y)
+            {
+                for (qc::s32 x{0}; x < 7; ++x)
+                {
+                    const qc::fvec3 actual{grayAsRgb->at(x, y)};
+                    ABORT_IF(actual.x != actual.y || actual.x != actual.z || std::abs(actual.x - gray.at(x, y)) > gray.at(x, y) * (1.0f / 128.0f));
+                }
+            }
+        }
+
+        // Raw files hold any type exactly
+        checkQciRoundTrip(blurTestImage<qc::u16, 4u>({9u, 31u}), qciFile);
+        checkQciRoundTrip(blurTestImage<qc::f32, 1u>({40u, 3u}), qciFile);
+        checkQciRoundTrip(blurTestImage<qc::f32, 3u>({5u, 5u}), qciFile);
+
+        // Formats that cannot hold the type are refused, rather than converted
+        const bool writesFloatPng{qci::write(blurTestImage<qc::f32, 3u>({4u, 4u}), pngFile)};
+        const bool writesU16Hdr{qci::write(blurTestImage<qc::u16, 3u>({4u, 4u}), hdrFile)};
+        const bool writesU8Hdr{qci::write(blurTestImage<qc::u8, 3u>({4u, 4u}), hdrFile)};
+        ABORT_IF(writesFloatPng || writesU16Hdr || writesU8Hdr);
+
+        std::filesystem::remove(pngFile);
+        std::filesystem::remove(hdrFile);
+        std::filesystem::remove(qciFile);
+    }
+
+    // Each file a different size, so files cannot be mixed up
+    qci::RgbaImage asyncTestImage(const qc::u32 i)
+    {
+        const qc::uivec2 size{13u + i, 7u + i % 5u};
+        qci::RgbaImage image{size};
+        for (qc::u32 y{0u}; y < size.y; ++y)
+        {
+            for (qc::u32 x{0u}; x < size.x; ++x)
+            {
+                const qc::u32 hash{(x * 73856093u) ^ (y * 19349663u) ^ (i * 83492791u)};
+                image.at(x, y) = qc::ucvec4{qc::u8(hash), qc::u8(hash >> 8), qc::u8(hash >> 16), qc::u8(hash >> 24)};
+            }
+        }
+        return image;
+    }
+
+    // Writes then reads back many files at once, through io_uring if it is enabled, and otherwise the executor
+    void testAsync()
+    {
+        const std::filesystem::path directory{std::filesystem::temp_directory_path() / "qc-image-test-async"};
+        std::filesystem::create_directories(directory);
+        const auto fileName{[&directory](const qc::u32 i) { return directory / ("image-" + std::to_string(i) + ".png"); }};
+        constexpr qc::u32 fileN{40u};
+
+        std::vector<std::future<bool>> writes{};
+        for (qc::u32 i{0u}; i < fileN; ++i)
+        {
+            writes.push_back(qci::writeAsync(asyncTestImage(i), fileName(i)));
+        }
+        for (std::future<bool> & write : writes)
+        {
+            ABORT_IF(!write.get());
+        }
+
+        std::vector<std::future<qc::Result<qci::RgbaImage>>> reads{};
+        for (qc::u32 i{0u}; i < fileN; ++i)
+        {
+            reads.push_back(qci::readAsync<qc::u8, 4u>(fileName(i), false));
+        }
+        for (qc::u32 i{0u}; i < fileN; ++i)
+        {
+            const qc::Result<qci::RgbaImage> image{reads[i].get()};
+            ABORT_IF(!image);
+            const qci::RgbaImage expected{asyncTestImage(i)};
+            ABORT_IF(image->size() != expected.size());
+            for (qc::u32 y{0u}; y < expected.height(); ++y)
+            {
+                for (qc::u32 x{0u}; x < expected.width(); ++x)
+                {
+                    ABORT_IF(image->at(x, y) != expected.at(x, y));
+                }
+            }
+        }
+
+        // Missing files fail rather than hang
+        std::future<qc::Result<qci::RgbaImage>> missing{qci::readAsync<qc::u8, 4u>(directory / "missing.png", false)};
+        ABORT_IF(missing.get());
+
+        std::filesystem::remove_all(directory);
+    }
+
+    // Rounded square with a triangular hole and a cubic lobe, in pixels of an image 64 across, so lines, curves, and cubics are all covered
+    qci::sdf::Outline sdfTestOutline()
+    {
+        using qc::fvec2;
+
+        qci::sdf::Contour outer{};
+        outer.segments.push_back(qci::sdf::Segment{fvec2{16.0f, 8.0f}, fvec2{44.0f, 8.0f}});
+        outer.segments.push_back(qci::sdf::Segment{fvec2{44.0f, 8.0f}, fvec2{56.0f, 8.0f}, fvec2{56.0f, 20.0f}});
+        outer.segments.push_back(qci::sdf::Segment{fvec2{56.0f, 20.0f}, fvec2{56.0f, 44.0f}});
+        outer.segments.push_back(qci::sdf::Segment{fvec2{56.0f, 44.0f}, fvec2{50.0f, 62.0f}, fvec2{22.0f, 62.0f}, fvec2{16.0f, 50.0f}});
+        outer.segments.push_back(qci::sdf::Segment{fvec2{16.0f, 50.0f}, fvec2{16.0f, 8.0f}});
+
+        qci::sdf::Contour hole{};
+        hole.segments.push_back(qci::sdf::Segment{fvec2{26.0f, 18.0f}, fvec2{36.0f, 40.0f}});
+        hole.segments.push_back(qci::sdf::Segment{fvec2{36.0f, 40.0f}, fvec2{46.0f, 18.0f}});
+        hole.segments.push_back(qci::sdf::Segment{fvec2{46.0f, 18.0f}, fvec2{26.0f, 18.0f}});
+
+        qci::sdf::Outline outline{};
+        outline.contours.push_back(std::move(outer));
+        outline.contours.push_back(std::move(hole));
+        ABORT_IF(!outline.isValid());
+        return outline;
+    }
+
+    // Five pointed star of lines, as a polygon too, so which side of the edge a point is on can be known exactly
+    qc::List<qc::fvec2> starPolygon(const qc::fvec2 center, const qc::f32 outerRadius, const qc::f32 innerRadius)
+    {
+        qc::List<qc::fvec2> points{};
+        for (qc::u32 i{0u}; i < 10u; ++i)
+        {
+            const qc::f32 angle{qc::f32(i) * 0.62831853f + 0.3f};
+            const qc::f32 radius{i % 2u ? innerRadius : outerRadius};
+            points.push_back(center + qc::fvec2{std::cos(angle), std::sin(angle)} * radius);
+        }
+        return points;
+    }
+
+    qci::sdf::Outline polygonOutline(const qc::List<qc::fvec2> & points)
+    {
+        qci::sdf::Contour contour{};
+        for (qc::u32 i{0u}; i < points.size(); ++i)
+        {
+            contour.segments.push_back(qci::sdf::Segment{points[i], points[(i + 1u) % points.size()]});
+        }
+
+        qci::sdf::Outline outline{};
+        outline.contours.push_back(std::move(contour));
+        return outline;
+    }
+
+    bool isInsidePolygon(const qc::List<qc::fvec2> & points, const qc::fvec2 p)
+    {
+        bool inside{false};
+        for (qc::u32 i{0u}; i < points.size(); ++i)
+        {
+            const qc::fvec2 a{points[i]}, b{points[(i + 1u) % points.size()]};
+            if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) / (b.y - a.y) * (b.x - a.x))
+            {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+    // Applies `transform` to a copy of every point, the reference for generating with a transform
+    qci::sdf::Outline transformedOutline(const qci::sdf::Outline & outline, const qci::sdf::Transform & transform)
+    {
+        qci::sdf::Outline transformed{outline};
+        for (qci::sdf::Contour & contour : transformed.contours)
+        {
+            for (qci::sdf::Segment & segment : contour.segments)
+            {
+                switch (segment.type)
+                {
+                    case qci::sdf::SegmentType::line: segment = qci::sdf::Segment{transform.apply(segment.line.p1), transform.apply(segment.line.p2)}; break;
+                    case qci::sdf::SegmentType::curve: segment = qci::sdf::Segment{transform.apply(segment.curve.p1), transform.apply(segment.curve.p2), transform.apply(segment.curve.p3)}; break;
+                    case qci::sdf::SegmentType::cubic: segment = qci::sdf::Segment{transform.apply(segment.cubic.p1), transform.apply(segment.cubic.p2), transform.apply(segment.cubic.p3), transform.apply(segment.cubic.p4)}; break;
+                }
+            }
+        }
+        return transformed;
+    }
+
+    // Bilinear sample of `value(x, y)` over a square image, with pixel centers at half coordinates, clamped at the edges
+    template <typename F>
+    qc::f32 sampleBilinear(const F & value, const qc::u32 size, const qc::fvec2 p)
+    {
+        const qc::f32 fx{std::clamp(p.x - 0.5f, 0.0f, qc::f32(size - 1u))};
+        const qc::f32 fy{std::clamp(p.y - 0.5f, 0.0f, qc::f32(size - 1u))};
+        const qc::u32 x1{std::min(qc::u32(fx), size - 2u)}, y1{std::min(qc::u32(fy), size - 2u)};
+        const qc::f32 tx{fx - qc::f32(x1)}, ty{fy - qc::f32(y1)};
+        const qc::f32 bottom{value(x1, y1) * (1.0f - tx) + value(x1 + 1u, y1) * tx};
+        const qc::f32 top{value(x1, y1 + 1u) * (1.0f - tx) + value(x1 + 1u, y1 + 1u) * tx};
+        return bottom * (1.0f - ty) + top * ty;
+    }
+
+    // Every pixel within `tolerance` of the other image
+    template <typename T>
+    void checkImagesMatch(const qci::Image<T, 1u> & a, const qci::Image<T, 1u> & b, const double tolerance)
+    {
+        ABORT_IF(a.size() != b.size());
+        for (qc::u32 y{0u}; y < a.height(); ++y)
+        {
+            for (qc::u32 x{0u}; x < a.width(); ++x)
+            {
+                ABORT_IF(!(std::abs(double(a.at(x, y)) - double(b.at(x, y))) <= tolerance));
+            }
+        }
+    }
+
+    // Float pixels beyond half the range may be infinite, so are clamped to a little past it before comparing
+    void clampFarSdf(qci::Image<qc::f32, 1u> & image)
+    {
+        for (qc::u32 y{0u}; y < image.height(); ++y)
+        {
+            for (qc::u32 x{0u}; x < image.width(); ++x)
+            {
+                image.at(x, y) = std::clamp(image.at(x, y), -1.0f, 2.0f);
+            }
+        }
+    }
+
+    // Points along the contour, `stepN` per segment, closing back to the start
+    qc::List<qc::fvec2> sampleContour(const qci::sdf::Contour & contour, const qc::u32 stepN)
+    {
+        qc::List<qc::fvec2> points{};
+        for (const qci::sdf::Segment & segment : contour.segments)
+        {
+            for (qc::u32 i{0u}; i < stepN; ++i)
+            {
+                const qc::f32 t{qc::f32(i) / qc::f32(stepN)}, u{1.0f - t};
+                switch (segment.type)
+                {
+                    case qci::sdf::SegmentType::line: points.push_back(segment.line.p1 * u + segment.line.p2 * t); break;
+                    case qci::sdf::SegmentType::curve: points.push_back(segment.curve.p1 * (u * u) + segment.curve.p2 * (2.0f * u * t) + segment.curve.p3 * (t * t)); break;
+                    case qci::sdf::SegmentType::cubic: points.push_back(segment.cubic.p1 * (u * u * u) + segment.cubic.p2 * (3.0f * u * u * t) + segment.cubic.p3 * (3.0f * u * t * t) + segment.cubic.p4 * (t * t * t)); break;
+                }
+            }
+        }
+        points.push_back(points[0]);
+        return points;
+    }
+
+    // Furthest any of `points` is from the polyline through `path`
+    qc::f32 maxDistanceToPath(const qc::List<qc::fvec2> & points, const qc::List<qc::fvec2> & path)
+    {
+        qc::f32 maxDist{0.0f};
+        for (const qc::fvec2 p : points)
+        {
+            qc::f32 minDist2{std::numeric_limits<qc::f32>::infinity()};
+            for (qc::u32 i{0u}; i + 1u < path.size(); ++i)
+            {
+                const qc::fvec2 a{path[i]}, ab{path[i + 1u] - a};
+                const qc::f32 length2{qc::dot(ab, ab)};
+                const qc::f32 t{length2 > 0.0f ? std::clamp(qc::dot(p - a, ab) / length2, 0.0f, 1.0f) : 0.0f};
+                const qc::fvec2 d{a + ab * t - p};
+                minDist2 = std::min(minDist2, qc::dot(d, d));
+            }
+            maxDist = std::max(maxDist, std::sqrt(minDist2));
+        }
+        return maxDist;
+    }
+
+    // Simplifies a copy of `contour`, checking every point of each is within `tolerance` of the other, and that it got no larger
+    qc::u32 checkSimplifyWithinTolerance(const qci::sdf::Contour & contour, const qc::f32 tolerance)
+    {
+        qci::sdf::Contour simplified{contour};
+        simplified.simplify(tolerance);
+        ABORT_IF(simplified.segments.size() > contour.segments.size());
+
+        // Denser sampling than either side's error, so what is left is the simplification's
+        constexpr qc::u32 stepN{48u};
+        const qc::List<qc::fvec2> original{sampleContour(contour, stepN)};
+        const qc::List<qc::fvec2> reduced{sampleContour(simplified, stepN)};
+        const qc::f32 bound{tolerance * 1.02f + 1.0e-3f};
+        ABORT_IF(maxDistanceToPath(original, reduced) > bound);
+        ABORT_IF(maxDistanceToPath(reduced, original) > bound);
+
+        return simplified.segments.size();
+    }
+
+    void testSdf()
+    {
+        const qci::sdf::Outline outline{sdfTestOutline()};
+
+        // Segment types, and the quadratic curve flag kept from before cubics
+        {
+            const qc::List<qci::sdf::Segment> & segments{outline.contours[0].segments};
+            ABORT_IF(segments[0].type != qci::sdf::SegmentType::line || segments[0].isCurve());
+            ABORT_IF(segments[1].type != qci::sdf::SegmentType::curve || !segments[1].isCurve());
+            ABORT_IF(segments[3].type != qci::sdf::SegmentType::cubic || segments[3].isCurve());
+            const qc::fvec2 cubicStart{56.0f, 44.0f}, cubicEnd{16.0f, 50.0f};
+            ABORT_IF(segments[3].start() != cubicStart || segments[3].end() != cubicEnd);
+        }
+
+        // Simplification stays within its tolerance of the original both ways, for dense polygons, near flat curves, collinear runs, and tiny lines between curves
+        {
+            // A circle of many lines, a little noisy
+            qci::sdf::Contour circle{};
+            constexpr qc::u32 circlePointN{96u};
+            qc::fvec2 circlePoints[circlePointN];
+            for (qc::u32 i{0u}; i < circlePointN; ++i)
+            {
+                const qc::f32 angle{qc::f32(i) * 6.2831853f / qc::f32(circlePointN)};
+                const qc::f32 radius{30.0f + 0.05f * qc::f32((i * 7u) % 5u)};
+                circlePoints[i] = qc::fvec2{32.0f + radius * std::cos(angle), 32.0f + radius * std::sin(angle)};
+            }
+            for (qc::u32 i{0u}; i < circlePointN; ++i)
+            {
+                circle.segments.push_back(qci::sdf::Segment{circlePoints[i], circlePoints[(i + 1u) % circlePointN]});
+            }
+
+            // A box whose bottom is a run of collinear lines, whose right side is a near flat curve, and whose top is two curves with a tiny line between
+            using qc::fvec2;
+            qci::sdf::Contour box{};
+            for (qc::u32 i{0u}; i < 8u; ++i)
+            {
+                box.segments.push_back(qci::sdf::Segment{fvec2{4.0f + qc::f32(i) * 6.0f, 4.0f + (i % 2u ? 0.02f : 0.0f)}, fvec2{10.0f + qc::f32(i) * 6.0f, 4.0f + (i % 2u ? 0.0f : 0.02f)}});
+            }
+            box.segments.back().line.p2 = fvec2{52.0f, 4.0f};
+            box.segments.push_back(qci::sdf::Segment{fvec2{52.0f, 4.0f}, fvec2{52.1f, 24.0f}, fvec2{52.0f, 44.0f}});
+            box.segments.push_back(qci::sdf::Segment{fvec2{52.0f, 44.0f}, fvec2{42.0f, 56.0f}, fvec2{28.0f, 50.0f}});
+            box.segments.push_back(qci::sdf::Segment{fvec2{28.0f, 50.0f}, fvec2{27.98f, 50.01f}});
+            box.segments.push_back(qci::sdf::Segment{fvec2{27.98f, 50.01f}, fvec2{14.0f, 58.0f}, fvec2{4.0f, 44.0f}});
+            box.segments.push_back(qci::sdf::Segment{fvec2{4.0f, 44.0f}, fvec2{4.0f, 4.0f}});
+            ABORT_IF(!box.isValid());
+
+            for (const qc::f32 tolerance : {0.05f, 0.25f, 1.0f})
+            {
+                const qc::u32 circleN{checkSimplifyWithinTolerance(circle, tolerance)};
+                const qc::u32 boxN{checkSimplifyWithinTolerance(box, tolerance)};
+                for (const qci::sdf::Contour & contour : outline.contours)
+                {
+                    checkSimplifyWithinTolerance(contour, tolerance);
+                }
+                // The noise is within every tolerance here, so lines merge, and the bottom run becomes one
+                ABORT_IF(circleN >= circlePointN || boxN > 6u);
+            }
+        }
+
+        // Packing sorts segments into per type arrays, contour by contour, and generating from them is the same as from the outline
+        {
+            const qci::sdf::PackedOutline packed{outline};
+            ABORT_IF(!packed.isValid());
+            ABORT_IF(packed.lines.size() != 6u || packed.curves.size() != 1u || packed.cubics.size() != 1u || packed.contours.size() != 2u);
+            const qci::sdf::PackedOutline::ContourEnd & outerEnd{packed.contours[0]};
+            const qci::sdf::PackedOutline::ContourEnd & holeEnd{packed.contours[1]};
+            ABORT_IF(outerEnd.lineEnd != 3u || outerEnd.curveEnd != 1u || outerEnd.cubicEnd != 1u);
+            ABORT_IF(holeEnd.lineEnd != 6u || holeEnd.curveEnd != 1u || holeEnd.cubicEnd != 1u || holeEnd.vertexEnd != packed.vertices.size());
+            ABORT_IF(packed.fillRule != outline.fillRule || !packed.maxRowInterceptN);
+
+            // Bounds hold the endpoints
+            for (const qci::sdf::PackedOutline::LineEntry & entry : packed.lines)
+            {
+                for (const qc::fvec2 p : {entry.line.p1, entry.line.p2})
+                {
+                    ABORT_IF(p.x < entry.bounds.min.x || p.y < entry.bounds.min.y || p.x > entry.bounds.max.x || p.y > entry.bounds.max.y);
+                }
+            }
+
+            for (const qc::u32 size : {64u, 100u})
+            {
+                for (const qc::f32 range : {2.0f, 9.0f})
+                {
+                    checkImagesMatch(qci::sdf::generate(packed, size, range), qci::sdf::generate(outline, size, range), 0.0);
+                }
+            }
+
+            // Repacking reuses the storage, and leaves nothing of the previous outline
+            const qci::sdf::Outline star{polygonOutline(starPolygon(qc::fvec2{32.0f, 32.0f}, 28.0f, 12.0f))};
+            qci::sdf::PackedOutline repacked{outline};
+            repacked.pack(star);
+            ABORT_IF(repacked.lines.size() != 10u || repacked.curves.size() || repacked.cubics.size() || repacked.contours.size() != 1u);
+            checkImagesMatch(qci::sdf::generate(repacked, 64u, 6.0f), qci::sdf::generate(star, 64u, 6.0f), 0.0);
+
+            // Invalid outlines pack empty, and generate nothing
+            repacked.pack(qci::sdf::Outline{});
+            ABORT_IF(repacked.isValid() || repacked.lines.size() || repacked.vertices.size());
+            ABORT_IF(qci::sdf::generate(repacked, 64u, 6.0f).width());
+        }
+
+        // Typed outputs are the float field, clamped and rounded to the type's range for integers
+        {
+            constexpr qc::u32 size{80u};
+            constexpr qc::f32 range{5.0f};
+            const qci::Image<qc::f32, 1u> floats{qci::sdf::generate<qc::f32>(outline, size, range)};
+            const qci::Image<qc::u16, 1u> shorts{qci::sdf::generate<qc::u16>(outline, size, range)};
+            const qci::Image<qc::u8, 1u> bytes{qci::sdf::generate<qc::u8>(outline, size, range)};
+            const qci::GrayImage untyped{qci::sdf::generate(outline, size, range)};
+            ABORT_IF(floats.width() != size || shorts.width() != size || bytes.width() != size);
+            checkImagesMatch(bytes, untyped, 0.0);
+
+            bool hasBelow{false}, hasAbove{false};
+            for (qc::u32 y{0u}; y < size; ++y)
+            {
+                for (qc::u32 x{0u}; x < size; ++x)
+                {
+                    const qc::f32 f{floats.at(x, y)};
+                    hasBelow |= f < 0.0f;
+                    hasAbove |= f > 1.0f;
+                    const qc::f32 clamped{std::clamp(f, 0.0f, 1.0f)};
+                    ABORT_IF(std::abs(qc::f32(shorts.at(x, y)) - clamped * 65535.0f) > 0.5f + 65535.0f * 1.0e-6f);
+                    ABORT_IF(std::abs(qc::f32(bytes.at(x, y)) - clamped * 255.0f) > 0.5f + 255.0f * 1.0e-6f);
+                }
+            }
+            // Floats are not clamped
+            ABORT_IF(!hasBelow || !hasAbove);
+
+            // Generating into a view is the same, and refuses one that is not square
+            qci::Image<qc::u16, 1u> viewed{size, size};
+            ABORT_IF(!qci::sdf::generate<qc::u16>(qci::sdf::PackedOutline{outline}, viewed.view(), range));
+            checkImagesMatch(viewed, shorts, 0.0);
+            qci::Image<qc::u16, 1u> wide{size, size - 1u};
+            ABORT_IF(qci::sdf::generate<qc::u16>(qci::sdf::PackedOutline{outline}, wide.view(), range));
+        }
+
+        // Stats count the pixels each segment type was evaluated for, which is its bounds grown by half the range and clipped to the image
+        // Without `QCI_SDF_STATS` they are all left zero, over whatever was there before
+        {
+            constexpr qc::u32 size{60u};
+            constexpr qc::f32 range{6.0f};
+            const qci::sdf::PackedOutline packed{outline};
+
+            qci::sdf::GenerateStats stats{};
+            stats.rowN = 12345u;
+            stats.distanceSeconds = 1.0;
+            const qci::GrayImage image{qci::sdf::generate(packed, size, range, &stats)};
+            ABORT_IF(image.width() != size);
+
+            if constexpr (qci::sdf::statsEnabled)
+            {
+                qc::u64 expectedPixelNs[3]{};
+                const auto addBounds{[&](const qc::fspan2 & bounds, const qc::u32 type)
+                {
+                    const qc::s32 minX{std::max(qc::s32(std::floor(bounds.min.x - range * 0.5f)), 0)};
+                    const qc::s32 minY{std::max(qc::s32(std::floor(bounds.min.y - range * 0.5f)), 0)};
+                    const qc::s32 maxX{std::min(qc::s32(std::ceil(bounds.max.x + range * 0.5f)), qc::s32(size))};
+                    const qc::s32 maxY{std::min(qc::s32(std::ceil(bounds.max.y + range * 0.5f)), qc::s32(size))};
+                    expectedPixelNs[type] += qc::u64(std::max(maxX - minX, 0)) * qc::u64(std::max(maxY - minY, 0));
+                }};
+                for (const auto & entry : packed.lines) addBounds(entry.bounds, 0u);
+                for (const auto & entry : packed.curves) addBounds(entry.bounds, 1u);
+                for (const auto & entry : packed.cubics) addBounds(entry.bounds, 2u);
+
+                ABORT_IF(stats.linePixelN != expectedPixelNs[0] || stats.curvePixelN != expectedPixelNs[1] || stats.cubicPixelN != expectedPixelNs[2]);
+                ABORT_IF(stats.rowN != size || !stats.interceptN || stats.oddInterceptRowN);
+                ABORT_IF(!stats.closestPointSearchN || stats.averageClosestPointIterations() < 1.0);
+                ABORT_IF(!(stats.totalSeconds() > 0.0) || stats.distanceSeconds < 0.0 || stats.quantizeSeconds < 0.0);
+            }
+            else
+            {
+                ABORT_IF(stats.rowN || stats.linePixelN || stats.interceptN || stats.totalSeconds() != 0.0);
+            }
+
+            // Failing calls leave them zero too
+            stats.rowN = 12345u;
+            const qci::GrayImage nothing{qci::sdf::generate(qci::sdf::Outline{}, size, range, &stats)};
+            ABORT_IF(nothing.width() || stats.rowN);
+        }
+
+        // Levels against generating each from an outline packed and scaled on its own, exactly for power of two ratios
+        {
+            constexpr qc::u32 sizes[4]{128u, 64u, 16u, 32u};
+            const qc::List<qci::Image<qc::u8, 1u>> levels{qci::sdf::generateLevels<qc::u8>(outline, 64.0f, sizes, 4u, 6.0f)};
+            ABORT_IF(levels.size() != 4u);
+            for (qc::u32 i{0u}; i < 4u; ++i)
+            {
+                qci::sdf::PackedOutline packedOutline{outline};
+                packedOutline.scale(qc::f32(sizes[i]) / 64.0f);
+                checkImagesMatch(levels[i], qci::sdf::generate<qc::u8>(packedOutline, sizes[i], 6.0f), 0.0);
+            }
+
+            // Other ratios only differ by rounding
+            constexpr qc::u32 oddSizes[3]{96u, 40u, 57u};
+            qc::List<qci::Image<qc::f32, 1u>> oddLevels{qci::sdf::generateLevels<qc::f32>(outline, 64.0f, oddSizes, 3u, 6.0f)};
+            ABORT_IF(oddLevels.size() != 3u);
+            for (qc::u32 i{0u}; i < 3u; ++i)
+            {
+                qci::sdf::Outline scaled{outline};
+                const qc::f32 factor{qc::f32(oddSizes[i]) / 64.0f};
+                scaled.transform(qc::fvec2{factor, factor}, qc::fvec2{});
+                qci::Image<qc::f32, 1u> expected{qci::sdf::generate<qc::f32>(scaled, oddSizes[i], 6.0f)};
+                clampFarSdf(oddLevels[i]);
+                clampFarSdf(expected);
+                checkImagesMatch(oddLevels[i], expected, 1.0e-4);
+            }
+
+            // Sizes must be positive
+            constexpr qc::u32 withEmptySizes[2]{32u, 0u};
+            ABORT_IF(qci::sdf::generateLevels<qc::u8>(outline, 64.0f, withEmptySizes, 2u, 6.0f).size());
+            ABORT_IF(qci::sdf::generateLevels<qc::u8>(outline, 0.0f, sizes, 4u, 6.0f).size());
+            ABORT_IF(qci::sdf::generateLevels<qc::u8>(outline, -64.0f, sizes, 4u, 6.0f).size());
+            ABORT_IF(qci::sdf::generateLevels<qc::u8>(outline, std::numeric_limits<qc::f32>::quiet_NaN(), sizes, 4u, 6.0f).size());
+        }
+
+        // Multi-channel SDF of a star at 24 px, where the median of bilinear samples must find the sharp points far better than a plain SDF
+        {
+            constexpr qc::u32 size{24u};
+            constexpr qc::u32 supersampling{8u};
+            const qc::List<qc::fvec2> star{starPolygon(qc::fvec2{12.0f, 12.0f}, 11.0f, 4.5f)};
+            const qci::sdf::Outline starOutline{polygonOutline(star)};
+
+            const qci::RgbImage msdf{qci::sdf::generateMsdf(starOutline, size, 4.0f)};
+            const qci::GrayImage sdf{qci::sdf::generate(starOutline, size, 4.0f)};
+            ABORT_IF(msdf.width() != size || msdf.height() != size || sdf.width() != size || sdf.height() != size);
+
+            qc::u32 msdfErrorN{0u}, sdfErrorN{0u};
+            for (qc::u32 y{0u}; y < size * supersampling; ++y)
+            {
+                for (qc::u32 x{0u}; x < size * supersampling; ++x)
+                {
+                    const qc::fvec2 p{(qc::fvec2{qc::f32(x), qc::f32(y)} + 0.5f) / qc::f32(supersampling)};
+                    const bool inside{isInsidePolygon(star, p)};
+
+                    qc::f32 channels[3];
+                    for (qc::u32 c{0u}; c < 3u; ++c)
+                    {
+                        channels[c] = sampleBilinear([&](const qc::u32 px, const qc::u32 py) { return qc::f32(msdf.at(px, py)[c]); }, size, p);
+                    }
+                    const qc::f32 median{std::max(std::min(channels[0], channels[1]), std::min(std::max(channels[0], channels[1]), channels[2]))};
+                    const qc::f32 plain{sampleBilinear([&](const qc::u32 px, const qc::u32 py) { return qc::f32(sdf.at(px, py)); }, size, p)};
+
+                    msdfErrorN += (median > 127.5f) != inside;
+                    sdfErrorN += (plain > 127.5f) != inside;
+                }
+            }
+            ABORT_IF(msdfErrorN * 10u > sdfErrorN);
+
+            // A transform that stretches is the same as a stretched copy, corners included
+            // The roof's ridge bends too little to be a corner until stretched upward
+            const qc::List<qc::fvec2> roof{qc::fvec2{2.0f, 4.0f}, qc::fvec2{22.0f, 4.0f}, qc::fvec2{22.0f, 10.0f}, qc::fvec2{12.0f, 10.5f}, qc::fvec2{2.0f, 10.0f}};
+            const qci::sdf::Outline roofOutline{polygonOutline(roof)};
+            const qci::sdf::Transform stretch{.xAxis = {1.0f, 0.0f}, .yAxis = {0.0f, 2.0f}, .translate = {0.0f, -6.0f}};
+            const qci::sdf::Transform shear{.xAxis = {0.6f, 0.2f}, .yAxis = {-0.3f, 0.9f}, .translate = {7.0f, 3.0f}};
+            for (const qci::sdf::Transform & transform : {stretch, shear})
+            {
+                for (const qci::sdf::Outline * const original : {&starOutline, &roofOutline})
+                {
+                    const qci::RgbImage transformedMsdf{qci::sdf::generateMsdf(*original, transform, size, 4.0f)};
+                    const qci::RgbImage expected{qci::sdf::generateMsdf(transformedOutline(*original, transform), size, 4.0f)};
+                    ABORT_IF(transformedMsdf.size() != expected.size());
+                    for (qc::u32 y{0u}; y < size; ++y)
+                    {
+                        for (qc::u32 x{0u}; x < size; ++x)
+                        {
+                            ABORT_IF(transformedMsdf.at(x, y) != expected.at(x, y));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Packing with a transform is the same as packing a transformed copy, both for one that rotates and scales and one that mirrors, which reverses the winding
+        {
+            const qci::sdf::Outline star{polygonOutline(starPolygon(qc::fvec2{30.0f, 34.0f}, 26.0f, 11.0f))};
+            const qci::sdf::Transform rotateScale{.xAxis = {0.9f, 0.5f}, .yAxis = {-0.5f, 0.9f}, .translate = {20.0f, -12.0f}};
+            const qci::sdf::Transform mirror{.xAxis = {-1.1f, 0.0f}, .yAxis = {0.0f, 1.1f}, .translate = {76.0f, -3.0f}};
+            constexpr qc::u32 size{72u};
+            for (const qci::sdf::Transform & transform : {rotateScale, mirror})
+            {
+                for (const qci::sdf::Outline * const original : {&outline, &star})
+                {
+                    const qci::sdf::PackedOutline packed{*original, transform};
+                    const qci::sdf::PackedOutline expectedPacked{transformedOutline(*original, transform)};
+                    ABORT_IF(!packed.isValid() || !expectedPacked.isValid());
+
+                    checkImagesMatch(qci::sdf::generate<qc::u8>(packed, size, 6.0f), qci::sdf::generate<qc::u8>(expectedPacked, size, 6.0f), 0.0);
+
+                    qci::Image<qc::f32, 1u> floats{qci::sdf::generate<qc::f32>(packed, size, 6.0f)};
+                    qci::Image<qc::f32, 1u> expectedFloats{qci::sdf::generate<qc::f32>(expectedPacked, size, 6.0f)};
+                    clampFarSdf(floats);
+                    clampFarSdf(expectedFloats);
+                    checkImagesMatch(floats, expectedFloats, 1.0e-4);
+                }
+            }
+        }
+
+        // Sparse generation keeps exactly the dense pixels of each band tile, and every other tile is uniformly what the dense image is there
+        {
+            const qci::sdf::Outline bigStar{polygonOutline(starPolygon(qc::fvec2{150.0f, 140.0f}, 120.0f, 50.0f))};
+            const qci::sdf::Transform rotateScale{.xAxis = {1.2f, 0.9f}, .yAxis = {-0.9f, 1.2f}, .translate = {80.0f, -10.0f}};
+            // Partial edge tiles in each case
+            const struct
+            {
+                const qci::sdf::Outline * outline;
+                const qci::sdf::Transform * transform;
+                qc::u32 size;
+                qc::f32 range;
+            } cases[]{{&outline, nullptr, 100u, 6.0f}, {&outline, &rotateScale, 130u, 10.0f}, {&bigStar, nullptr, 300u, 8.0f}, {&bigStar, nullptr, 333u, 40.0f}};
+
+            qc::u32 kindCounts[3]{};
+            for (const auto & c : cases)
+            {
+                const qci::GrayImage dense{c.transform ? qci::sdf::generate(*c.outline, *c.transform, c.size, c.range) : qci::sdf::generate(*c.outline, c.size, c.range)};
+                const qci::sdf::SparseSdf sparse{c.transform ? qci::sdf::generateSparse(*c.outline, *c.transform, c.size, c.range) : qci::sdf::generateSparse(*c.outline, c.size, c.range)};
+                ABORT_IF(sparse.size() != c.size || dense.width() != c.size);
+
+                constexpr qc::u32 tileSize{qci::sdf::SparseSdf::tileSize};
+                for (qc::u32 tileY{0u}; tileY < sparse.tileCount(); ++tileY)
+                {
+                    for (qc::u32 tileX{0u}; tileX < sparse.tileCount(); ++tileX)
+                    {
+                        const qc::uivec2 tilePos{tileX, tileY};
+                        const qci::sdf::SparseSdf::TileKind kind{sparse.tileKind(tilePos)};
+                        ++kindCounts[qc::u32(kind)];
+                        const qc::u8 * const tilePixels{sparse.tilePixels(tilePos)};
+                        ABORT_IF((kind == qci::sdf::SparseSdf::TileKind::band) != bool(tilePixels));
+
+                        for (qc::u32 y{tileY * tileSize}; y < std::min((tileY + 1u) * tileSize, c.size); ++y)
+                        {
+                            for (qc::u32 x{tileX * tileSize}; x < std::min((tileX + 1u) * tileSize, c.size); ++x)
+                            {
+                                const qc::u8 expected{dense.at(x, y)};
+                                switch (kind)
+                                {
+                                    case qci::sdf::SparseSdf::TileKind::outside: ABORT_IF(expected != 0u); break;
+                                    case qci::sdf::SparseSdf::TileKind::inside: ABORT_IF(expected != 255u); break;
+                                    case qci::sdf::SparseSdf::TileKind::band: ABORT_IF(tilePixels[(y % tileSize) * tileSize + x % tileSize] != expected); break;
+                                }
+                                ABORT_IF(sparse.at(x, y) != expected);
+                            }
+                        }
+                    }
+                }
+
+                const qci::GrayImage expanded{sparse.toImage()};
+                checkImagesMatch(expanded, dense, 0.0);
+            }
+            // The big star leaves tiles wholly inside and outside, as well as in the band
+            ABORT_IF(!kindCounts[0] || !kindCounts[1] || !kindCounts[2]);
+        }
+
+        // Distance transform of masks, against brute force
+        {
+            // Random pixels, some in runs, with range wide enough that most pixels are within it
+            for (const qc::uivec2 size : {qc::uivec2{37u, 23u}, qc::uivec2{3u, 70u}, qc::uivec2{90u, 2u}})
+            {
+                qci::GrayImage mask{size};
+                for (qc::u32 y{0u}; y < size.y; ++y)
+                {
+                    for (qc::u32 x{0u}; x < size.x; ++x)
+                    {
+                        const qc::u32 hash{((x / 3u) * 73856093u) ^ (y * 19349663u) ^ (x * 83492791u)};
+                        mask.at(x, y) = qc::u8(hash % 7u < 2u ? 200u + hash % 56u : hash % 128u);
+                    }
+                }
+                mask.at(0u, 0u) = 255u;
+                mask.at(size.x - 1u, size.y - 1u) = 0u;
+                checkMaskSdfMatchesBruteForce(mask, 24.0f);
+            }
+
+            // A few inside pixels far along a single row or column, where squared positions are past what f32 holds exactly
+            for (const bool isColumn : {false, true})
+            {
+                constexpr qc::u32 length{17000u};
+                const qc::uivec2 size{isColumn ? 1u : length, isColumn ? length : 1u};
+                qci::GrayImage mask{size};
+                mask.fill(qc::u8(0u));
+                for (const qc::u32 i : {16000u, 16003u, 16010u, 16011u, 16500u, 16990u})
+                {
+                    mask.at(isColumn ? 0u : i, isColumn ? i : 0u) = 255u;
+                }
+                checkMaskSdfMatchesBruteForce(mask, 64.0f);
+            }
+        }
+    }
+
+    void appendU16BigEndian(qc::List<qc::u8> & dst, const qc::u32 v)
+    {
+        dst.push_back(qc::u8(v >> 8));
+        dst.push_back(qc::u8(v));
+    }
+
+    // Simple glyph of one contour from word coordinates, each point on curve or not
+    void appendSimpleGlyph(qc::List<qc::u8> & glyf, const qc::ivec2 * const points, const bool * const onCurve, const qc::u32 pointN)
+    {
+        appendU16BigEndian(glyf, 1u);
+        // Bounds, which are not read
+        glyf.resize(glyf.size() + 8u, qc::u8(0u));
+        appendU16BigEndian(glyf, pointN - 1u);
+        // No instructions
+        appendU16BigEndian(glyf, 0u);
+        for (qc::u32 i{0u}; i < pointN; ++i)
+        {
+            glyf.push_back(qc::u8(onCurve[i]));
+        }
+        for (qc::u32 c{0u}; c < 2u; ++c)
+        {
+            qc::s32 prev{0};
+            for (qc::u32 i{0u}; i < pointN; ++i)
+            {
+                appendU16BigEndian(glyf, qc::u32(points[i][c] - prev));
+                prev = points[i][c];
+            }
+        }
+    }
+
+    // Composite glyph header, for components to follow
+    void appendCompositeHeader(qc::List<qc::u8> & glyf)
+    {
+        appendU16BigEndian(glyf, 0xFFFFu);
+        glyf.resize(glyf.size() + 8u, qc::u8(0u));
+    }
+
+    // Component at a word offset, with a 2x2 transform in 2.14 fixed point if `axes` is given
+    void appendComponent(qc::List<qc::u8> & glyf, const qc::u32 glyph, const qc::ivec2 offset, const qc::ivec2 * const axes, const bool more)
+    {
+        // Args are words, args are offsets, more components, two by two
+        appendU16BigEndian(glyf, 0x0003u | (more ? 0x0020u : 0u) | (axes ? 0x0080u : 0u));
+        appendU16BigEndian(glyf, glyph);
+        appendU16BigEndian(glyf, qc::u32(offset.x));
+        appendU16BigEndian(glyf, qc::u32(offset.y));
+        if (axes)
+        {
+            for (const qc::s32 v : {axes[0].x, axes[0].y, axes[1].x, axes[1].y})
+            {
+                appendU16BigEndian(glyf, qc::u32(v * 16384));
+            }
+        }
+    }
+
+    // Glyph 1 is a simple glyph of two lines and a curve. It is mapped from 'A', and glyph 2 from 'B'
+    constexpr qc::ivec2 fontTestPoints[4]{{100, 100}, {500, 100}, {500, 500}, {100, 500}};
+    constexpr bool fontTestOnCurve[4]{true, true, false, true};
+    constexpr qc::u32 fontTestUnitsPerEm{1000u};
+    constexpr qc::u32 fontTestGlyphN{8u};
+
+    // A minimal TrueType font, with just the tables `font::decode` needs
+    //  0: the missing glyph, empty
+    //  1: the simple glyph
+    //  2: the simple glyph mirrored in x, as a composite
+    //  3, 4, 5: composites of 64 of the next, ending in the simple glyph, so 3 reads more glyphs than the outline budget, but 5 does not
+    //  6: a composite of itself
+    //  7: the simple glyph moved, as a composite
+    qc::List<qc::u8> makeTestFont()
+    {
+        qc::List<qc::u8> glyf{};
+        qc::List<qc::u8> loca{};
+        const auto beginGlyph{[&]()
+        {
+            // Glyphs are kept at even offsets, as the short format would need
+            while (glyf.size() % 4u) glyf.push_back(qc::u8(0u));
+            appendU32BigEndian(loca, glyf.size());
+        }};
+
+        beginGlyph();
+
+        beginGlyph();
+        appendSimpleGlyph(glyf, fontTestPoints, fontTestOnCurve, 4u);
+
+        beginGlyph();
+        appendCompositeHeader(glyf);
+        constexpr qc::ivec2 mirrorAxes[2]{{-1, 0}, {0, 1}};
+        appendComponent(glyf, 1u, qc::ivec2{600, 0}, mirrorAxes, false);
+
+        for (qc::u32 glyph{3u}; glyph <= 5u; ++glyph)
+        {
+            beginGlyph();
+            appendCompositeHeader(glyf);
+            for (qc::u32 i{0u}; i < 64u; ++i)
+            {
+                appendComponent(glyf, glyph == 5u ? 1u : glyph + 1u, qc::ivec2{qc::s32(i), 0}, nullptr, i + 1u < 64u);
+            }
+        }
+
+        beginGlyph();
+        appendCompositeHeader(glyf);
+        appendComponent(glyf, 6u, qc::ivec2{}, nullptr, false);
+
+        beginGlyph();
+        appendCompositeHeader(glyf);
+        appendComponent(glyf, 1u, qc::ivec2{50, -20}, nullptr, false);
+
+        beginGlyph();
+
+        qc::List<qc::u8> head(54u, qc::u8(0u));
+        head[18] = qc::u8(fontTestUnitsPerEm >> 8);
+        head[19] = qc::u8(fontTestUnitsPerEm);
+        // Long offsets
+        head[51] = 1u;
+
+        qc::List<qc::u8> maxp(6u, qc::u8(0u));
+        maxp[4] = qc::u8(fontTestGlyphN >> 8);
+        maxp[5] = qc::u8(fontTestGlyphN);
+
+        qc::List<qc::u8> hhea(36u, qc::u8(0u));
+        hhea[5] = 200u;
+        // Every glyph has its own metrics
+        hhea[35] = qc::u8(fontTestGlyphN);
+
+        qc::List<qc::u8> hmtx{};
+        for (qc::u32 glyph{0u}; glyph < fontTestGlyphN; ++glyph)
+        {
+            appendU16BigEndian(hmtx, 600u + glyph);
+            appendU16BigEndian(hmtx, 100u);
+        }
+
+        // Format 4, mapping 'A' and 'B' to glyphs 1 and 2, and the required final segment
+        qc::List<qc::u8> cmap{};
+        appendU16BigEndian(cmap, 0u);
+        appendU16BigEndian(cmap, 1u);
+        appendU16BigEndian(cmap, 3u);
+        appendU16BigEndian(cmap, 1u);
+        appendU32BigEndian(cmap, 12u);
+        appendU16BigEndian(cmap, 4u);
+        appendU16BigEndian(cmap, 32u);
+        appendU16BigEndian(cmap, 0u);
+        appendU16BigEndian(cmap, 4u);
+        // Search hints, which are not read
+        cmap.resize(cmap.size() + 6u, qc::u8(0u));
+        for (const qc::u32 v : {qc::u32('B'), 0xFFFFu, 0u, qc::u32('A'), 0xFFFFu, (1u - 'A') & 0xFFFFu, 1u, 0u, 0u})
+        {
+            appendU16BigEndian(cmap, v);
+        }
+
+        const char * const tags[]{"cmap", "glyf", "head", "hhea", "hmtx", "loca", "maxp"};
+        const qc::List<qc::u8> * const tables[]{&cmap, &glyf, &head, &hhea, &hmtx, &loca, &maxp};
+        constexpr qc::u32 tableN{7u};
+
+        qc::List<qc::u8> font{};
+        appendU32BigEndian(font, 0x00010000u);
+        appendU16BigEndian(font, tableN);
+        font.resize(12u + tableN * 16u, qc::u8(0u));
+        for (qc::u32 i{0u}; i < tableN; ++i)
+        {
+            qc::u8 * const record{font.data() + 12u + i * 16u};
+            std::memcpy(record, tags[i], 4u);
+            const qc::u32 offset{font.size()}, size{tables[i]->size()};
+            for (qc::u32 b{0u}; b < 4u; ++b)
+            {
+                record[8u + b] = qc::u8(offset >> (24u - b * 8u));
+                record[12u + b] = qc::u8(size >> (24u - b * 8u));
+            }
+            appendBytes(font, tables[i]->data(), size);
+            while (font.size() % 4u) font.push_back(qc::u8(0u));
+        }
+        return font;
+    }
+
+    // Twice the signed area of the polygon through each segment's start, positive if counterclockwise
+    qc::f32 contourWinding(const qci::sdf::Contour & contour)
+    {
+        qc::f32 area{0.0f};
+        for (qc::u32 i{0u}; i < contour.segments.size(); ++i)
+        {
+            area += qc::cross(contour.segments[i].start(), contour.segments[(i + 1u) % contour.segments.size()].start());
+        }
+        return area;
+    }
+
+    void testFont()
+    {
+        qc::Result<qci::font::Font> font{qci::font::decode(makeTestFont())};
+        ABORT_IF(!font);
+        ABORT_IF(font->glyphN() != fontTestGlyphN || font->unitsPerEm() != fontTestUnitsPerEm);
+        ABORT_IF(font->glyphIndex('A') != 1u || font->glyphIndex('B') != 2u || font->glyphIndex('C') != 0u);
+        ABORT_IF(font->metrics(2u).advance != 602u || font->metrics(2u).leftBearing != 100);
+
+        // The simple glyph's points, with the off curve point as a curve's control
+        const qc::Result<qci::sdf::Outline> simple{font->outline(1u)};
+        ABORT_IF(!simple || simple->contours.size() != 1u);
+        const qc::List<qci::sdf::Segment> & segments{simple->contours[0].segments};
+        ABORT_IF(segments.size() != 3u);
+        ABORT_IF(segments[0].isCurve() || !segments[1].isCurve() || segments[2].isCurve());
+        for (qc::u32 i{0u}; i < 3u; ++i)
+        {
+            const qc::fvec2 start{fontTestPoints[i == 2u ? 3u : i]};
+            ABORT_IF(segments[i].start() != start);
+        }
+        const qc::fvec2 control{fontTestPoints[2]};
+        ABORT_IF(segments[1].curve.p2 != control);
+
+        // Empty glyphs have nothing to draw
+        const qc::Result<qci::sdf::Outline> empty{font->outline(0u)};
+        ABORT_IF(!empty || empty->contours.size());
+
+        // The mirrored composite is the simple glyph mirrored, but turned around so it winds the same way
+        const qc::Result<qci::sdf::Outline> mirrored{font->outline(2u)};
+        ABORT_IF(!mirrored || mirrored->contours.size() != 1u);
+        ABORT_IF((contourWinding(mirrored->contours[0]) > 0.0f) != (contourWinding(simple->contours[0]) > 0.0f));
+        const qci::sdf::Transform mirror{.xAxis = {-1.0f, 0.0f}, .yAxis = {0.0f, 1.0f}, .translate = {600.0f, 0.0f}};
+        const qci::sdf::Transform toPixels{qci::sdf::Transform::scaleTranslate(qc::fvec2{0.1f}, qc::fvec2{0.0f})};
+        checkImagesMatch(qci::sdf::generate(*mirrored, toPixels, 64u, 4.0f), qci::sdf::generate(transformedOutline(*simple, mirror), toPixels, 64u, 4.0f), 0.0);
+
+        // Too many glyphs read in all fails, but fewer does not, and nor does nesting within the depth limit
+        const qc::Result<qci::sdf::Outline> overBudget{font->outline(3u)};
+        ABORT_IF(overBudget);
+        const qc::Result<qci::sdf::Outline> underBudget{font->outline(5u)};
+        ABORT_IF(!underBudget || underBudget->contours.size() != 64u);
+        const qc::Result<qci::sdf::Outline> cyclic{font->outline(6u)};
+        ABORT_IF(cyclic);
+        const qc::Result<qci::sdf::Outline> outOfRange{font->outline(fontTestGlyphN)};
+        ABORT_IF(outOfRange);
+
+        // Least recently used glyphs are evicted past the budget, which here fits three of the four glyphs
+        {
+            // The moved glyph is the same size as the simple one, and the 64 copies larger
+            constexpr qc::u32 glyphs[4]{1u, 2u, 7u, 5u};
+            qc::u64 glyphByteNs[4]{};
+            {
+                qci::font::GlyphCache probe{*font, 32.0f, 4.0f, ~qc::u64(0u)};
+                qc::u64 total{0u};
+                for (qc::u32 i{0u}; i < 4u; ++i)
+                {
+                    ABORT_IF(!probe.get(glyphs[i]));
+                    glyphByteNs[i] = probe.byteN() - total;
+                    total = probe.byteN();
+                }
+                ABORT_IF(probe.glyphN() != 4u);
+                ABORT_IF(glyphByteNs[1] > glyphByteNs[3]);
+                probe.clear();
+                ABORT_IF(probe.glyphN() || probe.byteN());
+            }
+
+            qci::font::GlyphCache cache{*font, 32.0f, 4.0f, glyphByteNs[0] + glyphByteNs[2] + glyphByteNs[3]};
+            const std::shared_ptr<const qci::font::GlyphSdf> a{cache.get(1u)};
+            const std::shared_ptr<const qci::font::GlyphSdf> b{cache.getCodepoint('B')};
+            const std::shared_ptr<const qci::font::GlyphSdf> c{cache.get(7u)};
+            ABORT_IF(!a || !b || !c || cache.glyphN() != 3u);
+            ABORT_IF(a->image.width() != qc::u32(std::ceil(400.0f * 0.032f + 4.0f)) || a->advance != 601.0f * 0.032f);
+
+            // Touching the first makes the second the least recent, so only it goes when the larger glyph comes in
+            ABORT_IF(cache.get(1u) != a);
+            const std::shared_ptr<const qci::font::GlyphSdf> d{cache.get(5u)};
+            ABORT_IF(!d || cache.glyphN() != 3u);
+            ABORT_IF(cache.get(1u) != a || cache.get(7u) != c || cache.get(5u) != d);
+
+            // Evicted, so generated again, but the old one stays valid while held
+            const std::shared_ptr<const qci::font::GlyphSdf> b2{cache.get(2u)};
+            ABORT_IF(!b2 || b2 == b || b->image.size() != b2->image.size());
+
+            // Glyphs that fail to read give nothing
+            ABORT_IF(cache.get(3u));
+            ABORT_IF(cache.get(fontTestGlyphN));
+        }
+    }
+}
 
 int main()
 {
+    // Block compression round trips, which need no input files
+    testBc();
+
+    // Built-in PNG decoder against stb_image, over generated files
+    testPng();
+
+    // Blurs against naive references
+    testBlur();
+
+    // Image comparison against naive references
+    testCompare();
+
+    // Tiled layout conversions
+    testTiled();
+
+    // Row iteration and parallel loops covering everything exactly once
+    testParallel();
+
+    // Thread pool, nested parallel loops, and custom executors
+    testExecutor();
+
+    // Rotations and mirrorings against a naive index map
+    testOrient();
+
+    // Raw image files
+    testQci();
+
+    // 16 bit and float images through each file format
+    testTypedIo();
+
+    // Signed distance fields
+    testSdf();
+
+    // Glyph outlines and SDF caching over a generated font
+    testFont();
+
+    // Asynchronous file IO round trips
+    testAsync();
+
     // RGB
     {
         const qc::Result<qci::RgbImage> rgbImage{qci::readRgb("rgb-in.png", false)};